@@ -1,11 +1,31 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include "ctrade/asset_slice.hpp"
 #include "ctrade/backtest.hpp"
+#include "ctrade/bar_store.hpp"
 #include "ctrade/config.hpp"
+#include "ctrade/cpcv.hpp"
+#include "ctrade/event.hpp"
+#include "ctrade/event_study.hpp"
 #include "ctrade/strategy.hpp"
 #include "ctrade/backtest_result.hpp"
 #include "ctrade/market_state.hpp"
 #include "ctrade/execution_context.hpp"
+#include "ctrade/feature_store.hpp"
+#include "ctrade/fill.hpp"
+#include "ctrade/intrabar_path.hpp"
+#include "ctrade/labels.hpp"
+#include "ctrade/optimize.hpp"
+#include "ctrade/risk.hpp"
+#include "ctrade/rng.hpp"
+#include "ctrade/rules.hpp"
+#include "ctrade/snapshot.hpp"
+#include "ctrade/sweep.hpp"
+#include "ctrade/sweep_cluster.hpp"
+#include "ctrade/sweep_journal.hpp"
+#include "ctrade/tree_model.hpp"
 
 namespace py = pybind11;
 
@@ -18,9 +38,37 @@ public:
     PYBIND11_OVERRIDE_PURE(void, ctrade::Strategy, init);
   }
 
+  ctrade::WakePolicy wake_policy() const override {
+    PYBIND11_OVERRIDE(ctrade::WakePolicy, ctrade::Strategy, wake_policy);
+  }
+
   void on_bar(const ctrade::MarketState& market, ctrade::ExecutionContext& ctx) override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::Strategy, on_bar, market, ctx);
   }
+
+  void on_slice(const ctrade::AssetSlice& slice, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_slice, slice, ctx);
+  }
+
+  void on_fill(const ctrade::Fill& fill, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_fill, fill, ctx);
+  }
+
+  void on_tick(const ctrade::Tick& tick, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_tick, tick, ctx);
+  }
+
+  void on_timer(const ctrade::TimerEvent& timer, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_timer, timer, ctx);
+  }
+
+  void on_funding(const ctrade::FundingEvent& event, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_funding, event, ctx);
+  }
+
+  void on_liquidation(const ctrade::LiquidationEvent& event, ctrade::ExecutionContext& ctx) override {
+    PYBIND11_OVERRIDE(void, ctrade::Strategy, on_liquidation, event, ctx);
+  }
 };
 
 // Python execution context trampoline (for type exposure)
@@ -28,29 +76,29 @@ class PyExecutionContext : public ctrade::ExecutionContext {
 public:
   using ctrade::ExecutionContext::ExecutionContext;
 
-  void market_buy(double size) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, market_buy, size);
+  int64_t market_buy(double size) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, market_buy, size);
   }
-  void market_sell(double size) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, market_sell, size);
+  int64_t market_sell(double size) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, market_sell, size);
   }
-  void limit_buy(double size, double price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, limit_buy, size, price);
+  int64_t limit_buy(double size, double price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, limit_buy, size, price);
   }
-  void limit_sell(double size, double price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, limit_sell, size, price);
+  int64_t limit_sell(double size, double price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, limit_sell, size, price);
   }
-  void stop_buy(double size, double stop_price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, stop_buy, size, stop_price);
+  int64_t stop_buy(double size, double stop_price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, stop_buy, size, stop_price);
   }
-  void stop_sell(double size, double stop_price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, stop_sell, size, stop_price);
+  int64_t stop_sell(double size, double stop_price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, stop_sell, size, stop_price);
   }
-  void stop_limit_buy(double size, double stop_price, double limit_price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, stop_limit_buy, size, stop_price, limit_price);
+  int64_t stop_limit_buy(double size, double stop_price, double limit_price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, stop_limit_buy, size, stop_price, limit_price);
   }
-  void stop_limit_sell(double size, double stop_price, double limit_price) override {
-    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, stop_limit_sell, size, stop_price, limit_price);
+  int64_t stop_limit_sell(double size, double stop_price, double limit_price) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, stop_limit_sell, size, stop_price, limit_price);
   }
   void close_position() override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, close_position);
@@ -64,12 +112,36 @@ public:
   void close_amount(double size) override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, close_amount, size);
   }
-  void cancel_order(int order_id) override {
+  void set_target_weights(std::span<const double> weights) override {
+    std::vector<double> w(weights.begin(), weights.end());
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, set_target_weights, w);
+  }
+  void set_target_positions(std::span<const double> positions) override {
+    std::vector<double> p(positions.begin(), positions.end());
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, set_target_positions, p);
+  }
+  void cancel_order(int64_t order_id) override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, cancel_order, order_id);
   }
   void cancel_all() override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, cancel_all);
   }
+  void amend_order(int64_t order_id, double new_size, double new_price) override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, amend_order, order_id,
+                           new_size, new_price);
+  }
+  int64_t submit_order(const ctrade::Order &order) override {
+    PYBIND11_OVERRIDE(int64_t, ctrade::ExecutionContext, submit_order, order);
+  }
+  int64_t submit_parent_order(const ctrade::ParentOrder &parent) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, submit_parent_order, parent);
+  }
+  void cancel_parent_order(int64_t parent_id) override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, cancel_parent_order, parent_id);
+  }
+  int64_t schedule_timer(int64_t timestamp) override {
+    PYBIND11_OVERRIDE_PURE(int64_t, ctrade::ExecutionContext, schedule_timer, timestamp);
+  }
   void set_leverage(int lev) override {
     PYBIND11_OVERRIDE_PURE(void, ctrade::ExecutionContext, set_leverage, lev);
   }
@@ -81,6 +153,50 @@ public:
   }
 };
 
+// Python resumable backtest trampoline
+class PyResumableBacktest : public ctrade::ResumableBacktest {
+public:
+  void run(int64_t begin_ts, int64_t end_ts, ctrade::BacktestResult& result) override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ResumableBacktest, run, begin_ts, end_ts, result);
+  }
+  void reset() override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ResumableBacktest, reset);
+  }
+  void save(ctrade::SnapshotWriter& out) const override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ResumableBacktest, save, out);
+  }
+  void load(ctrade::SnapshotReader& in) override {
+    PYBIND11_OVERRIDE_PURE(void, ctrade::ResumableBacktest, load, in);
+  }
+};
+
+// Read-only numpy view over a column; `owner` keeps the memory alive.
+template <typename T>
+static py::array_t<T> column_view(std::span<const T> column, py::handle owner) {
+  py::array_t<T> arr(column.size(), column.data(), owner);
+  arr.attr("setflags")(py::arg("write") = false);
+  return arr;
+}
+
+// Read-only row-major (rows, cols) view over `values`.
+static py::array_t<double> panel_view(const std::vector<double>& values, size_t rows,
+                                      size_t cols, py::handle owner) {
+  py::array_t<double> arr({rows, cols}, values.data(), owner);
+  arr.attr("setflags")(py::arg("write") = false);
+  return arr;
+}
+
+// Adapts a Python `run(params, rng)` for the C++ runners, which call it
+// from worker threads with the GIL released.
+static ctrade::RunFn wrap_run(py::function run) {
+  return [run](const ctrade::ParamSet& p, ctrade::CounterRng& rng) {
+    py::gil_scoped_acquire gil;
+    // By reference, so draws advance the worker's stream
+    auto py_rng = py::cast(&rng, py::return_value_policy::reference);
+    return run(p, py_rng).cast<ctrade::BacktestResult>();
+  };
+}
+
 PYBIND11_MODULE(_ctrade, m) {
   m.doc() = "C++ backtesting engine for ctrade";
 
@@ -104,6 +220,7 @@ PYBIND11_MODULE(_ctrade, m) {
   py::class_<ctrade::MarketState>(m, "MarketState")
     .def(py::init<>())
     .def_readwrite("asset_id", &ctrade::MarketState::asset_id)
+    .def_readwrite("venue_id", &ctrade::MarketState::venue_id)
     .def_readwrite("timestamp", &ctrade::MarketState::timestamp)
     .def_readwrite("open", &ctrade::MarketState::open)
     .def_readwrite("high", &ctrade::MarketState::high)
@@ -117,6 +234,153 @@ PYBIND11_MODULE(_ctrade, m) {
     .def_readwrite("index_price", &ctrade::MarketState::index_price)
     .def_readwrite("funding_rate", &ctrade::MarketState::funding_rate);
 
+  // Fill
+  py::class_<ctrade::Fill>(m, "Fill")
+    .def(py::init<>())
+    .def_readwrite("order_id", &ctrade::Fill::order_id)
+    .def_readwrite("asset_id", &ctrade::Fill::asset_id)
+    .def_readwrite("venue_id", &ctrade::Fill::venue_id)
+    .def_readwrite("price", &ctrade::Fill::price)
+    .def_readwrite("size", &ctrade::Fill::size)
+    .def_readwrite("fee", &ctrade::Fill::fee)
+    .def_readwrite("timestamp", &ctrade::Fill::timestamp)
+    .def_readwrite("maker", &ctrade::Fill::maker);
+
+  // Tick
+  py::class_<ctrade::Tick>(m, "Tick")
+    .def(py::init<>())
+    .def_readwrite("asset_id", &ctrade::Tick::asset_id)
+    .def_readwrite("venue_id", &ctrade::Tick::venue_id)
+    .def_readwrite("timestamp", &ctrade::Tick::timestamp)
+    .def_readwrite("price", &ctrade::Tick::price)
+    .def_readwrite("size", &ctrade::Tick::size)
+    .def_readwrite("is_buyer_maker", &ctrade::Tick::is_buyer_maker);
+
+  // FundingEvent
+  py::class_<ctrade::FundingEvent>(m, "FundingEvent")
+    .def(py::init<>())
+    .def_readwrite("asset_id", &ctrade::FundingEvent::asset_id)
+    .def_readwrite("venue_id", &ctrade::FundingEvent::venue_id)
+    .def_readwrite("timestamp", &ctrade::FundingEvent::timestamp)
+    .def_readwrite("rate", &ctrade::FundingEvent::rate)
+    .def_readwrite("mark_price", &ctrade::FundingEvent::mark_price);
+
+  // LiquidationEvent
+  py::class_<ctrade::LiquidationEvent>(m, "LiquidationEvent")
+    .def(py::init<>())
+    .def_readwrite("asset_id", &ctrade::LiquidationEvent::asset_id)
+    .def_readwrite("venue_id", &ctrade::LiquidationEvent::venue_id)
+    .def_readwrite("timestamp", &ctrade::LiquidationEvent::timestamp)
+    .def_readwrite("price", &ctrade::LiquidationEvent::price)
+    .def_readwrite("size", &ctrade::LiquidationEvent::size);
+
+  // TimerEvent
+  py::class_<ctrade::TimerEvent>(m, "TimerEvent")
+    .def(py::init<>())
+    .def_readwrite("timer_id", &ctrade::TimerEvent::timer_id)
+    .def_readwrite("timestamp", &ctrade::TimerEvent::timestamp);
+
+  // Side / OrderType / Order / ParentAlgo / ParentOrder
+  py::enum_<ctrade::Side>(m, "Side")
+    .value("Buy", ctrade::Side::Buy)
+    .value("Sell", ctrade::Side::Sell);
+
+  py::enum_<ctrade::OrderType>(m, "OrderType")
+    .value("Market", ctrade::OrderType::Market)
+    .value("Limit", ctrade::OrderType::Limit)
+    .value("Stop", ctrade::OrderType::Stop)
+    .value("StopLimit", ctrade::OrderType::StopLimit);
+
+  py::class_<ctrade::Order>(m, "Order")
+    .def(py::init<>())
+    .def_readwrite("id", &ctrade::Order::id)
+    .def_readwrite("asset_id", &ctrade::Order::asset_id)
+    .def_readwrite("venue_id", &ctrade::Order::venue_id)
+    .def_readwrite("side", &ctrade::Order::side)
+    .def_readwrite("type", &ctrade::Order::type)
+    .def_readwrite("price", &ctrade::Order::price)
+    .def_readwrite("stop_price", &ctrade::Order::stop_price)
+    .def_readwrite("size", &ctrade::Order::size)
+    .def_readwrite("timestamp", &ctrade::Order::timestamp);
+
+  py::enum_<ctrade::ParentAlgo>(m, "ParentAlgo")
+    .value("TWAP", ctrade::ParentAlgo::TWAP)
+    .value("VWAP", ctrade::ParentAlgo::VWAP)
+    .value("POV", ctrade::ParentAlgo::POV)
+    .value("Iceberg", ctrade::ParentAlgo::Iceberg);
+
+  py::class_<ctrade::ParentOrder>(m, "ParentOrder")
+    .def(py::init<>())
+    .def_readwrite("algo", &ctrade::ParentOrder::algo)
+    .def_readwrite("asset_id", &ctrade::ParentOrder::asset_id)
+    .def_readwrite("venue_id", &ctrade::ParentOrder::venue_id)
+    .def_readwrite("side", &ctrade::ParentOrder::side)
+    .def_readwrite("size", &ctrade::ParentOrder::size)
+    .def_readwrite("limit_price", &ctrade::ParentOrder::limit_price)
+    .def_readwrite("start_ts", &ctrade::ParentOrder::start_ts)
+    .def_readwrite("end_ts", &ctrade::ParentOrder::end_ts)
+    .def_readwrite("slices", &ctrade::ParentOrder::slices)
+    .def_readwrite("volume_profile", &ctrade::ParentOrder::volume_profile)
+    .def_readwrite("participation", &ctrade::ParentOrder::participation)
+    .def_readwrite("display_size", &ctrade::ParentOrder::display_size);
+
+  // AssetSlice (columns are numpy copies indexed by asset_id). The slice's
+  // memory is reused for the next timestamp, so arrays must not view it.
+  py::class_<ctrade::AssetSlice>(m, "AssetSlice")
+    .def_readonly("timestamp", &ctrade::AssetSlice::timestamp)
+    .def_property_readonly("open", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.open.size(), s.open.data());
+    })
+    .def_property_readonly("high", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.high.size(), s.high.data());
+    })
+    .def_property_readonly("low", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.low.size(), s.low.data());
+    })
+    .def_property_readonly("close", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.close.size(), s.close.data());
+    })
+    .def_property_readonly("volume", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.volume.size(), s.volume.data());
+    })
+    .def_property_readonly("funding_rate", [](const ctrade::AssetSlice& s) {
+      return py::array_t<double>(s.funding_rate.size(), s.funding_rate.data());
+    })
+    .def("__len__", &ctrade::AssetSlice::size);
+
+  // BarStore (columns are zero-copy numpy views)
+  py::class_<ctrade::BarStore>(m, "BarStore")
+    .def(py::init<int, size_t, int>(), py::arg("asset_id"), py::arg("block_size") = 1024,
+         py::arg("venue_id") = 0)
+    .def("append", &ctrade::BarStore::append, py::arg("bar"))
+    .def("at", &ctrade::BarStore::at, py::arg("index"))
+    .def("lower_bound", &ctrade::BarStore::lower_bound, py::arg("timestamp"))
+    .def("__len__", &ctrade::BarStore::size)
+    .def_property_readonly("asset_id", &ctrade::BarStore::asset_id)
+    .def_property_readonly("venue_id", &ctrade::BarStore::venue_id)
+    .def_property_readonly("n_blocks", &ctrade::BarStore::n_blocks)
+    .def_property_readonly("timestamps", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().timestamps(), self);
+    })
+    .def_property_readonly("open", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().open(), self);
+    })
+    .def_property_readonly("high", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().high(), self);
+    })
+    .def_property_readonly("low", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().low(), self);
+    })
+    .def_property_readonly("close", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().close(), self);
+    })
+    .def_property_readonly("volume", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().volume(), self);
+    })
+    .def_property_readonly("funding_rate", [](py::object self) {
+      return column_view(self.cast<const ctrade::BarStore&>().funding_rate(), self);
+    });
+
   // BacktestResult
   py::class_<ctrade::BacktestResult>(m, "BacktestResult")
     .def(py::init<>())
@@ -140,17 +404,527 @@ PYBIND11_MODULE(_ctrade, m) {
     .def("close_long", &ctrade::ExecutionContext::close_long)
     .def("close_short", &ctrade::ExecutionContext::close_short)
     .def("close_amount", &ctrade::ExecutionContext::close_amount)
+    .def("set_target_weights", [](ctrade::ExecutionContext& self, const std::vector<double>& weights) {
+      self.set_target_weights(weights);
+    }, py::arg("weights"))
+    .def("set_target_positions", [](ctrade::ExecutionContext& self, const std::vector<double>& positions) {
+      self.set_target_positions(positions);
+    }, py::arg("positions"))
     .def("cancel_order", &ctrade::ExecutionContext::cancel_order)
     .def("cancel_all", &ctrade::ExecutionContext::cancel_all)
+    .def("amend_order", &ctrade::ExecutionContext::amend_order)
+    .def("submit_order", &ctrade::ExecutionContext::submit_order, py::arg("order"))
+    .def("submit_parent_order", &ctrade::ExecutionContext::submit_parent_order)
+    .def("cancel_parent_order", &ctrade::ExecutionContext::cancel_parent_order)
+    .def("schedule_timer", &ctrade::ExecutionContext::schedule_timer)
     .def("set_leverage", &ctrade::ExecutionContext::set_leverage)
     .def("set_cross_mode", &ctrade::ExecutionContext::set_cross_mode)
     .def("set_isolated_mode", &ctrade::ExecutionContext::set_isolated_mode);
 
+  // WakeMode / WakePolicy
+  py::enum_<ctrade::WakeMode>(m, "WakeMode")
+    .value("EveryBar", ctrade::WakeMode::EveryBar)
+    .value("TriggersOnly", ctrade::WakeMode::TriggersOnly);
+
+  py::class_<ctrade::WakePolicy>(m, "WakePolicy")
+    .def(py::init<>())
+    .def_readwrite("mode", &ctrade::WakePolicy::mode)
+    .def_readwrite("timer_period", &ctrade::WakePolicy::timer_period)
+    .def_readwrite("bar_callbacks", &ctrade::WakePolicy::bar_callbacks);
+
   // Strategy (abstract base for Python strategies)
   py::class_<ctrade::Strategy, PyStrategy>(m, "Strategy")
     .def(py::init<>())
     .def("init", &ctrade::Strategy::init)
-    .def("on_bar", &ctrade::Strategy::on_bar);
+    .def("wake_policy", &ctrade::Strategy::wake_policy)
+    .def("on_bar", &ctrade::Strategy::on_bar)
+    .def("on_slice", &ctrade::Strategy::on_slice)
+    .def("on_fill", &ctrade::Strategy::on_fill)
+    .def("on_tick", &ctrade::Strategy::on_tick)
+    .def("on_timer", &ctrade::Strategy::on_timer)
+    .def("on_funding", &ctrade::Strategy::on_funding)
+    .def("on_liquidation", &ctrade::Strategy::on_liquidation);
+
+  // CounterRng (per-run reproducible random stream)
+  py::class_<ctrade::CounterRng>(m, "CounterRng")
+    .def(py::init<uint64_t, uint64_t>(), py::arg("seed"), py::arg("stream"))
+    .def("next_u64", &ctrade::CounterRng::next_u64)
+    .def("uniform", &ctrade::CounterRng::uniform)
+    .def("normal", &ctrade::CounterRng::normal);
+
+  // EwmaCovariance (streaming covariance, VaR and risk parity)
+  py::class_<ctrade::EwmaCovariance>(m, "EwmaCovariance")
+    .def(py::init<size_t, double>(), py::arg("n_assets"), py::arg("lambda_"))
+    .def("update", [](ctrade::EwmaCovariance& c, const std::vector<double>& returns) {
+      c.update(returns);
+    }, py::arg("returns"))
+    .def("update_slice", py::overload_cast<const ctrade::AssetSlice&>(
+      &ctrade::EwmaCovariance::update), py::arg("slice"))
+    .def("covariance", &ctrade::EwmaCovariance::covariance, py::arg("i"), py::arg("j"))
+    .def("matrix", [](const ctrade::EwmaCovariance& c) {
+      py::array_t<double> out({c.size(), c.size()});
+      auto m = c.matrix();
+      std::copy(m.begin(), m.end(), out.mutable_data());
+      return out;
+    })
+    .def("volatility", [](const ctrade::EwmaCovariance& c, const std::vector<double>& w) {
+      return c.volatility(w);
+    }, py::arg("weights"))
+    .def("value_at_risk", [](const ctrade::EwmaCovariance& c, const std::vector<double>& w,
+                             double confidence) {
+      return c.value_at_risk(w, confidence);
+    }, py::arg("weights"), py::arg("confidence") = 0.99)
+    .def("risk_parity_weights", [](ctrade::EwmaCovariance& c, size_t max_sweeps) {
+      auto w = c.risk_parity_weights(max_sweeps);
+      return std::vector<double>(w.begin(), w.end());
+    }, py::arg("max_sweeps") = 100)
+    .def_property_readonly("observations", &ctrade::EwmaCovariance::observations)
+    .def("__len__", &ctrade::EwmaCovariance::size);
+
+  // PathModel (intrabar price path assumed when only OHLC is known)
+  py::enum_<ctrade::PathModel>(m, "PathModel")
+    .value("OHLC", ctrade::PathModel::OHLC)
+    .value("OLHC", ctrade::PathModel::OLHC)
+    .value("NearestFirst", ctrade::PathModel::NearestFirst)
+    .value("BrownianBridge", ctrade::PathModel::BrownianBridge);
+
+  m.def("intrabar_path", &ctrade::intrabar_path,
+        py::arg("bar"), py::arg("model"), py::arg("rng") = nullptr);
+
+  // SweepConfig
+  py::class_<ctrade::SweepConfig>(m, "SweepConfig")
+    .def(py::init<>())
+    .def_readwrite("threads", &ctrade::SweepConfig::threads)
+    .def_readwrite("seed", &ctrade::SweepConfig::seed)
+    .def_readwrite("deterministic", &ctrade::SweepConfig::deterministic);
+
+  // RunSummary
+  py::class_<ctrade::RunSummary>(m, "RunSummary")
+    .def(py::init<>())
+    .def_readwrite("final_equity", &ctrade::RunSummary::final_equity)
+    .def_readwrite("total_return", &ctrade::RunSummary::total_return)
+    .def_readwrite("max_drawdown", &ctrade::RunSummary::max_drawdown)
+    .def_readwrite("sharpe", &ctrade::RunSummary::sharpe)
+    .def_readwrite("n_bars", &ctrade::RunSummary::n_bars);
+
+  // SweepStats
+  py::class_<ctrade::SweepStats>(m, "SweepStats")
+    .def(py::init<>())
+    .def_readonly("n_runs", &ctrade::SweepStats::n_runs)
+    .def_readonly("mean_return", &ctrade::SweepStats::mean_return)
+    .def_readonly("mean_sharpe", &ctrade::SweepStats::mean_sharpe)
+    .def_readonly("best_sharpe", &ctrade::SweepStats::best_sharpe)
+    .def_readonly("best_index", &ctrade::SweepStats::best_index)
+    .def_readonly("worst_drawdown", &ctrade::SweepStats::worst_drawdown);
+
+  // SweepResult
+  py::class_<ctrade::SweepResult>(m, "SweepResult")
+    .def(py::init<>())
+    .def_readonly("runs", &ctrade::SweepResult::runs)
+    .def_readonly("stats", &ctrade::SweepResult::stats);
+
+  m.def("summarize", &ctrade::summarize, py::arg("result"));
+  m.def("hash_result", &ctrade::hash_result, py::arg("result"));
+  m.def("hash_summaries", &ctrade::hash_summaries, py::arg("runs"));
+
+  // Parallel sweep; `run(params, rng)` is called from worker threads and
+  // must return a BacktestResult.
+  m.def("run_sweep", [](const std::vector<ctrade::ParamSet>& params, py::function run,
+                        const ctrade::SweepConfig& config) {
+      const ctrade::RunFn fn = wrap_run(run);
+      py::gil_scoped_release release;
+      return ctrade::run_sweep(params, fn, config);
+    },
+    "Run a backtest per parameter set on a thread pool",
+    py::arg("params"), py::arg("run"), py::arg("config"));
+
+  // Resumable sweeps
+  py::class_<ctrade::SweepJournal>(m, "SweepJournal")
+    .def(py::init<const std::string&, const std::string&, bool>(),
+         py::arg("path"), py::arg("sweep_id"), py::arg("durable") = false)
+    .def("__len__", &ctrade::SweepJournal::size);
+
+  m.def("run_sweep_resumable", [](const std::vector<ctrade::ParamSet>& params, py::function run,
+                                  const ctrade::SweepConfig& config,
+                                  ctrade::SweepJournal& journal) {
+      const ctrade::RunFn fn = wrap_run(run);
+      py::gil_scoped_release release;
+      return ctrade::run_sweep(params, fn, config, journal);
+    },
+    "run_sweep that skips runs recorded in the journal and records new ones",
+    py::arg("params"), py::arg("run"), py::arg("config"), py::arg("journal"));
+
+  // Multi-process sweeps over a socket
+  py::class_<ctrade::ClusterConfig>(m, "ClusterConfig")
+    .def(py::init<>())
+    .def_readwrite("max_retries", &ctrade::ClusterConfig::max_retries)
+    .def_readwrite("idle_timeout_ms", &ctrade::ClusterConfig::idle_timeout_ms);
+
+  py::class_<ctrade::SweepCoordinator>(m, "SweepCoordinator")
+    .def(py::init<const std::string&, ctrade::ClusterConfig>(),
+         py::arg("endpoint"), py::arg("config") = ctrade::ClusterConfig())
+    .def_property_readonly("endpoint", &ctrade::SweepCoordinator::endpoint)
+    .def("run", &ctrade::SweepCoordinator::run,
+         py::call_guard<py::gil_scoped_release>(),
+         py::arg("params"), py::arg("seed") = 0, py::arg("journal") = nullptr);
+
+  m.def("run_sweep_worker", [](const std::string& endpoint, py::function run,
+                               unsigned threads, int connect_timeout_ms) {
+      const ctrade::RunFn fn = wrap_run(run);
+      py::gil_scoped_release release;
+      ctrade::run_sweep_worker(endpoint, fn, threads, connect_timeout_ms);
+    },
+    "Run sweep jobs handed out by a SweepCoordinator until it finishes",
+    py::arg("endpoint"), py::arg("run"), py::arg("threads") = 1,
+    py::arg("connect_timeout_ms") = 10000);
+
+  // Black-box optimization over the sweep runner
+  py::enum_<ctrade::ObjectiveKind>(m, "ObjectiveKind")
+    .value("Sharpe", ctrade::ObjectiveKind::Sharpe)
+    .value("TotalReturn", ctrade::ObjectiveKind::TotalReturn)
+    .value("Calmar", ctrade::ObjectiveKind::Calmar);
+
+  py::enum_<ctrade::OptimizerKind>(m, "OptimizerKind")
+    .value("Random", ctrade::OptimizerKind::Random)
+    .value("Sobol", ctrade::OptimizerKind::Sobol)
+    .value("CmaEs", ctrade::OptimizerKind::CmaEs)
+    .value("Tpe", ctrade::OptimizerKind::Tpe);
+
+  py::class_<ctrade::ParamBound>(m, "ParamBound")
+    .def(py::init<double, double, bool>(),
+         py::arg("low"), py::arg("high"), py::arg("integer") = false)
+    .def_readwrite("low", &ctrade::ParamBound::low)
+    .def_readwrite("high", &ctrade::ParamBound::high)
+    .def_readwrite("integer", &ctrade::ParamBound::integer);
+
+  py::class_<ctrade::OptimizeConfig>(m, "OptimizeConfig")
+    .def(py::init<>())
+    .def_readwrite("kind", &ctrade::OptimizeConfig::kind)
+    .def_readwrite("budget", &ctrade::OptimizeConfig::budget)
+    .def_readwrite("batch_size", &ctrade::OptimizeConfig::batch_size)
+    .def_readwrite("sweep", &ctrade::OptimizeConfig::sweep);
+
+  py::class_<ctrade::Trial>(m, "Trial")
+    .def_readonly("params", &ctrade::Trial::params)
+    .def_readonly("summary", &ctrade::Trial::summary)
+    .def_readonly("score", &ctrade::Trial::score);
+
+  py::class_<ctrade::OptimizeResult>(m, "OptimizeResult")
+    .def_readonly("trials", &ctrade::OptimizeResult::trials)
+    .def_readonly("best_index", &ctrade::OptimizeResult::best_index)
+    .def_property_readonly("best", [](const ctrade::OptimizeResult& r) {
+      return r.trials.at(r.best_index);
+    });
+
+  // The optimizer and objective stay in C++; only `run(params, rng)` is
+  // called back, exactly as in run_sweep.
+  m.def("optimize", [](const std::vector<ctrade::ParamBound>& bounds, py::function run,
+                       ctrade::ObjectiveKind objective,
+                       const ctrade::OptimizeConfig& config) {
+      const ctrade::RunFn fn = wrap_run(run);
+      auto score = ctrade::make_objective(objective);
+      py::gil_scoped_release release;
+      return ctrade::optimize(bounds, fn, score, config);
+    },
+    "Search parameter bounds with batched suggestions run on a thread pool",
+    py::arg("bounds"), py::arg("run"),
+    py::arg("objective") = ctrade::ObjectiveKind::Sharpe,
+    py::arg("config") = ctrade::OptimizeConfig());
+
+  // Combinatorial purged cross-validation
+  py::class_<ctrade::CpcvConfig>(m, "CpcvConfig")
+    .def(py::init<>())
+    .def_readwrite("n_groups", &ctrade::CpcvConfig::n_groups)
+    .def_readwrite("n_test_groups", &ctrade::CpcvConfig::n_test_groups)
+    .def_readwrite("purge", &ctrade::CpcvConfig::purge)
+    .def_readwrite("embargo", &ctrade::CpcvConfig::embargo);
+
+  py::class_<ctrade::CpcvSplit>(m, "CpcvSplit")
+    .def_readonly("test_groups", &ctrade::CpcvSplit::test_groups)
+    .def_readonly("selected", &ctrade::CpcvSplit::selected)
+    .def_readonly("train_sharpe", &ctrade::CpcvSplit::train_sharpe)
+    .def_readonly("test_sharpe", &ctrade::CpcvSplit::test_sharpe)
+    .def_readonly("test_rank", &ctrade::CpcvSplit::test_rank);
+
+  py::class_<ctrade::CpcvResult>(m, "CpcvResult")
+    .def_readonly("groups", &ctrade::CpcvResult::groups)
+    .def_readonly("splits", &ctrade::CpcvResult::splits)
+    .def_readonly("path_sharpe", &ctrade::CpcvResult::path_sharpe)
+    .def_readonly("pbo", &ctrade::CpcvResult::pbo)
+    .def_readonly("mean_train_sharpe", &ctrade::CpcvResult::mean_train_sharpe)
+    .def_readonly("mean_test_sharpe", &ctrade::CpcvResult::mean_test_sharpe)
+    .def_readonly("n_runs", &ctrade::CpcvResult::n_runs);
+
+  m.def("run_cpcv", [](const std::vector<ctrade::ParamSet>& params, py::function run,
+                       const ctrade::CpcvConfig& cpcv, const ctrade::SweepConfig& config) {
+      const ctrade::RunFn fn = wrap_run(run);
+      py::gil_scoped_release release;
+      return ctrade::run_cpcv(params, fn, cpcv, config);
+    },
+    "Score every purged train/test split from one run per parameter set",
+    py::arg("params"), py::arg("run"), py::arg("cpcv"), py::arg("config"));
+
+  // Precomputed per-bar features
+  py::class_<ctrade::FeatureKey>(m, "FeatureKey")
+    .def(py::init<std::string, ctrade::ParamSet, uint32_t>(),
+         py::arg("name"), py::arg("params") = ctrade::ParamSet(), py::arg("version") = 1)
+    .def_readwrite("name", &ctrade::FeatureKey::name)
+    .def_readwrite("params", &ctrade::FeatureKey::params)
+    .def_readwrite("version", &ctrade::FeatureKey::version);
+
+  py::class_<ctrade::FeatureColumn, std::shared_ptr<ctrade::FeatureColumn>>(m, "FeatureColumn")
+    .def_property_readonly("values", [](py::object self) {
+      return column_view(self.cast<const ctrade::FeatureColumn&>().values(), self);
+    })
+    .def("__len__", &ctrade::FeatureColumn::size);
+
+  py::class_<ctrade::FeatureStore>(m, "FeatureStore")
+    .def(py::init<std::string>(), py::arg("directory"))
+    // `compute(bars)` returns one value per bar.
+    .def("get", [](ctrade::FeatureStore& store, const ctrade::FeatureKey& key,
+                   const ctrade::BarStore& bars, py::function compute) {
+      ctrade::FeatureFn fn = [compute](const ctrade::BarStore& b, std::span<double> out) {
+        py::gil_scoped_acquire gil;
+        auto values = compute(py::cast(&b, py::return_value_policy::reference))
+                          .cast<py::array_t<double, py::array::c_style | py::array::forcecast>>();
+        if (static_cast<size_t>(values.size()) != out.size()) {
+          throw std::invalid_argument("FeatureStore.get: compute must return one value per bar");
+        }
+        std::copy(values.data(), values.data() + values.size(), out.begin());
+      };
+      // Without the GIL, so another thread's compute for the same column can
+      // finish while this one waits on it.
+      py::gil_scoped_release release;
+      return std::const_pointer_cast<ctrade::FeatureColumn>(store.get(key, bars, fn));
+    },
+    "Map the stored column, computing and persisting it on first use",
+    py::arg("key"), py::arg("bars"), py::arg("compute"))
+    .def("find", [](ctrade::FeatureStore& store, const ctrade::FeatureKey& key,
+                    const ctrade::BarStore& bars) {
+      py::gil_scoped_release release;
+      return std::const_pointer_cast<ctrade::FeatureColumn>(store.find(key, bars));
+    }, py::arg("key"), py::arg("bars"))
+    .def("computed", &ctrade::FeatureStore::computed);
+
+  // Native tree ensemble inference
+  py::enum_<ctrade::TreeOutput>(m, "TreeOutput")
+    .value("Raw", ctrade::TreeOutput::Raw)
+    .value("Sigmoid", ctrade::TreeOutput::Sigmoid);
+
+  py::class_<ctrade::TreeEnsemble>(m, "TreeEnsemble")
+    .def_static("from_lightgbm", &ctrade::parse_lightgbm_model, py::arg("text"))
+    .def_static("from_xgboost_dump", &ctrade::parse_xgboost_dump, py::arg("text"),
+                py::arg("base_score") = 0.0, py::arg("output") = ctrade::TreeOutput::Raw)
+    .def_property_readonly("n_trees", &ctrade::TreeEnsemble::n_trees)
+    .def_property_readonly("n_features", &ctrade::TreeEnsemble::n_features)
+    // One row gives a float; an (n, n_features) array gives n predictions.
+    .def("predict", [](const ctrade::TreeEnsemble& model,
+                       py::array_t<double, py::array::c_style | py::array::forcecast> x) -> py::object {
+      if (x.ndim() == 1) {
+        return py::float_(model.predict(std::span<const double>(x.data(), x.size())));
+      }
+      if (x.ndim() != 2) {
+        throw std::invalid_argument("TreeEnsemble.predict: expected a 1-D or 2-D array");
+      }
+      py::array_t<double> out(x.shape(0));
+      model.predict(std::span<const double>(x.data(), x.size()),
+                    std::span<double>(out.mutable_data(), out.size()));
+      return out;
+    }, py::arg("x"));
+
+  // Research labels
+  py::class_<ctrade::TripleBarrierConfig>(m, "TripleBarrierConfig")
+    .def(py::init<>())
+    .def_readwrite("take_profit", &ctrade::TripleBarrierConfig::take_profit)
+    .def_readwrite("stop_loss", &ctrade::TripleBarrierConfig::stop_loss)
+    .def_readwrite("max_holding", &ctrade::TripleBarrierConfig::max_holding);
+
+  py::class_<ctrade::BarrierLabels>(m, "BarrierLabels")
+    .def_property_readonly("label", [](const ctrade::BarrierLabels& l) {
+      return py::array_t<int8_t>(l.label.size(), l.label.data());
+    })
+    .def_property_readonly("ret", [](const ctrade::BarrierLabels& l) {
+      return py::array_t<double>(l.ret.size(), l.ret.data());
+    })
+    .def_property_readonly("exit", [](const ctrade::BarrierLabels& l) {
+      return py::array_t<size_t>(l.exit.size(), l.exit.data());
+    });
+
+  // Returns an (n_horizons, n_bars) array.
+  m.def("forward_returns", [](const ctrade::BarStore& bars,
+                              const std::vector<size_t>& horizons, unsigned threads) {
+      std::vector<std::vector<double>> columns;
+      {
+        py::gil_scoped_release release;
+        columns = ctrade::forward_returns(bars, horizons, threads);
+      }
+      py::array_t<double> out({horizons.size(), bars.size()});
+      for (size_t h = 0; h < columns.size(); ++h) {
+        std::copy(columns[h].begin(), columns[h].end(), out.mutable_data(h, 0));
+      }
+      return out;
+    },
+    py::arg("bars"), py::arg("horizons"), py::arg("threads") = 0);
+
+  m.def("triple_barrier_labels", [](const ctrade::BarStore& bars,
+                                    const ctrade::TripleBarrierConfig& config,
+                                    std::optional<py::array_t<double, py::array::c_style |
+                                                                      py::array::forcecast>> scale,
+                                    unsigned threads) {
+      std::span<const double> s;
+      if (scale) {
+        s = std::span<const double>(scale->data(), scale->size());
+      }
+      py::gil_scoped_release release;
+      return ctrade::triple_barrier_labels(bars, config, s, threads);
+    },
+    "Label every bar by the first of its take-profit, stop-loss and holding barriers",
+    py::arg("bars"), py::arg("config"), py::arg("scale") = py::none(), py::arg("threads") = 0);
+
+  // Event studies
+  py::class_<ctrade::EventStudyConfig>(m, "EventStudyConfig")
+    .def(py::init<>())
+    .def_readwrite("before", &ctrade::EventStudyConfig::before)
+    .def_readwrite("after", &ctrade::EventStudyConfig::after)
+    .def_readwrite("cooldown", &ctrade::EventStudyConfig::cooldown)
+    .def_readwrite("threads", &ctrade::EventStudyConfig::threads);
+
+  // Panels are zero-copy (n_events, width) views; column `before` is the event bar.
+  py::class_<ctrade::EventPanel>(m, "EventPanel")
+    .def_readonly("before", &ctrade::EventPanel::before)
+    .def_readonly("after", &ctrade::EventPanel::after)
+    .def_property_readonly("store", [](py::object self) {
+      return column_view(std::span<const uint32_t>(self.cast<const ctrade::EventPanel&>().store),
+                         self);
+    })
+    .def_property_readonly("bar", [](py::object self) {
+      return column_view(std::span<const uint32_t>(self.cast<const ctrade::EventPanel&>().bar),
+                         self);
+    })
+    .def_property_readonly("timestamp", [](py::object self) {
+      return column_view(
+          std::span<const int64_t>(self.cast<const ctrade::EventPanel&>().timestamp), self);
+    })
+    .def_property_readonly("returns", [](py::object self) {
+      const auto& p = self.cast<const ctrade::EventPanel&>();
+      return panel_view(p.returns, p.n_events(), p.width(), self);
+    })
+    .def_property_readonly("volume", [](py::object self) {
+      const auto& p = self.cast<const ctrade::EventPanel&>();
+      return panel_view(p.volume, p.n_events(), p.width(), self);
+    })
+    .def_property_readonly("funding_rate", [](py::object self) {
+      const auto& p = self.cast<const ctrade::EventPanel&>();
+      return panel_view(p.funding_rate, p.n_events(), p.width(), self);
+    })
+    .def("__len__", &ctrade::EventPanel::n_events);
+
+  // `predicate(bars)` returns one truth value per bar, e.g. an expression
+  // over the column views. It runs once per store under the GIL; the scan
+  // and gather run in parallel without it.
+  m.def("event_study", [](const std::vector<const ctrade::BarStore*>& stores,
+                          py::function predicate, const ctrade::EventStudyConfig& config) {
+      std::vector<py::array_t<uint8_t, py::array::c_style | py::array::forcecast>> arrays;
+      std::vector<std::span<const uint8_t>> masks;
+      for (const auto* bars : stores) {
+        arrays.push_back(predicate(py::cast(bars, py::return_value_policy::reference))
+                             .cast<py::array_t<uint8_t, py::array::c_style |
+                                                        py::array::forcecast>>());
+        if (static_cast<size_t>(arrays.back().size()) != bars->size()) {
+          throw std::invalid_argument("event_study: predicate must return one value per bar");
+        }
+        masks.emplace_back(arrays.back().data(), arrays.back().size());
+      }
+      py::gil_scoped_release release;
+      return ctrade::event_study(stores, masks, config);
+    },
+    "Find the bars matching a predicate across stores and gather aligned windows",
+    py::arg("stores"), py::arg("predicate"), py::arg("config") = ctrade::EventStudyConfig());
+
+  // Expression rules
+  py::class_<ctrade::RuleProgram>(m, "RuleProgram")
+    .def(py::init(&ctrade::compile_rules), py::arg("source"))
+    .def_property_readonly("n_nodes", [](const ctrade::RuleProgram& p) {
+      return p.nodes().size();
+    })
+    .def_property_readonly("n_rules", [](const ctrade::RuleProgram& p) {
+      return p.rules().size();
+    })
+    .def("evaluate", [](const ctrade::RuleProgram& p, const ctrade::BarStore& bars) {
+      std::vector<double> targets;
+      {
+        py::gil_scoped_release release;
+        targets = ctrade::evaluate_rules(p, bars);
+      }
+      return py::array_t<double>(targets.size(), targets.data());
+    },
+    "Target weight for every bar", py::arg("bars"))
+    .def("evaluate_many", [](const ctrade::RuleProgram& p,
+                             const std::vector<const ctrade::BarStore*>& stores,
+                             unsigned threads) {
+      std::vector<std::vector<double>> targets;
+      {
+        py::gil_scoped_release release;
+        targets = ctrade::evaluate_rules(p, stores, threads);
+      }
+      py::list out;
+      for (const auto& t : targets) {
+        out.append(py::array_t<double>(t.size(), t.data()));
+      }
+      return out;
+    },
+    "Target weights for every bar of every store, stores in parallel",
+    py::arg("stores"), py::arg("threads") = 0);
+
+  py::class_<ctrade::RuleStrategy, ctrade::Strategy>(m, "RuleStrategy")
+    .def(py::init<ctrade::RuleProgram, size_t>(), py::arg("program"),
+         py::arg("n_assets"))
+    .def_property_readonly("weights", [](const ctrade::RuleStrategy& s) {
+      auto w = s.weights();
+      return std::vector<double>(w.begin(), w.end());
+    });
+
+  // Incremental backtests from saved state
+  py::class_<ctrade::SnapshotWriter>(m, "SnapshotWriter")
+    .def("i64", &ctrade::SnapshotWriter::i64, py::arg("value"))
+    .def("f64", &ctrade::SnapshotWriter::f64, py::arg("value"))
+    .def("str", &ctrade::SnapshotWriter::str, py::arg("value"))
+    .def("f64s", [](ctrade::SnapshotWriter& w, const std::vector<double>& values) {
+      w.f64s(values);
+    }, py::arg("values"))
+    .def("save_covariance", [](ctrade::SnapshotWriter& w, const ctrade::EwmaCovariance& c) {
+      c.save(w);
+    }, py::arg("covariance"));
+
+  py::class_<ctrade::SnapshotReader>(m, "SnapshotReader")
+    .def("i64", &ctrade::SnapshotReader::i64)
+    .def("f64", &ctrade::SnapshotReader::f64)
+    .def("str", &ctrade::SnapshotReader::str)
+    .def("f64s", &ctrade::SnapshotReader::f64s)
+    .def("load_covariance", [](ctrade::SnapshotReader& r, ctrade::EwmaCovariance& c) {
+      c.load(r);
+    }, py::arg("covariance"));
+
+  // Subclass and implement run(begin_ts, end_ts, result), reset(),
+  // save(writer) and load(reader); run appends to result's series by
+  // reassigning them.
+  py::class_<ctrade::ResumableBacktest, PyResumableBacktest>(m, "ResumableBacktest")
+    .def(py::init<>());
+
+  py::class_<ctrade::SnapshotKey>(m, "SnapshotKey")
+    .def(py::init<std::string, ctrade::ParamSet, std::string>(),
+         py::arg("strategy"), py::arg("params"), py::arg("data_version"))
+    .def_readwrite("strategy", &ctrade::SnapshotKey::strategy)
+    .def_readwrite("params", &ctrade::SnapshotKey::params)
+    .def_readwrite("data_version", &ctrade::SnapshotKey::data_version);
+
+  py::class_<ctrade::SnapshotStore>(m, "SnapshotStore")
+    .def(py::init<std::string>(), py::arg("directory"))
+    .def("extend", &ctrade::SnapshotStore::extend,
+         "Result over [start_ts, end_ts), simulating only bars past the snapshot",
+         py::arg("key"), py::arg("backtest"), py::arg("start_ts"), py::arg("end_ts"))
+    .def("end_ts", &ctrade::SnapshotStore::end_ts, py::arg("key"))
+    .def("erase", &ctrade::SnapshotStore::erase, py::arg("key"));
 
   // Main backtest function
   m.def("backtest", &ctrade::backtest,
@@ -2,20 +2,138 @@
 
 from ._ctrade import (
     Strategy,
+    WakeMode,
+    WakePolicy,
+    AssetSlice,
+    BarStore,
     BacktestConfig,
     BacktestResult,
     MarketState,
+    Fill,
+    Tick,
+    FundingEvent,
+    LiquidationEvent,
+    TimerEvent,
+    Side,
+    ParentAlgo,
+    ParentOrder,
     DatabaseConfig,
     ExecutionContext,
+    CounterRng,
+    EwmaCovariance,
+    PathModel,
+    SweepConfig,
+    RunSummary,
+    SweepStats,
+    SweepResult,
+    SweepJournal,
+    ClusterConfig,
+    SweepCoordinator,
+    ObjectiveKind,
+    OptimizerKind,
+    ParamBound,
+    OptimizeConfig,
+    Trial,
+    OptimizeResult,
+    CpcvConfig,
+    CpcvSplit,
+    CpcvResult,
+    TreeOutput,
+    TreeEnsemble,
+    TripleBarrierConfig,
+    BarrierLabels,
+    EventStudyConfig,
+    EventPanel,
+    RuleProgram,
+    RuleStrategy,
+    FeatureKey,
+    FeatureColumn,
+    FeatureStore,
+    SnapshotWriter,
+    SnapshotReader,
+    ResumableBacktest,
+    SnapshotKey,
+    SnapshotStore,
     backtest,
+    run_sweep,
+    run_sweep_resumable,
+    run_sweep_worker,
+    optimize,
+    run_cpcv,
+    summarize,
+    hash_result,
+    hash_summaries,
+    intrabar_path,
+    forward_returns,
+    triple_barrier_labels,
+    event_study,
 )
 
 __all__ = [
     "Strategy",
+    "WakeMode",
+    "WakePolicy",
+    "AssetSlice",
+    "BarStore",
     "BacktestConfig",
     "BacktestResult",
     "MarketState",
+    "Fill",
+    "Tick",
+    "FundingEvent",
+    "LiquidationEvent",
+    "TimerEvent",
+    "Side",
+    "ParentAlgo",
+    "ParentOrder",
     "DatabaseConfig",
     "ExecutionContext",
+    "CounterRng",
+    "EwmaCovariance",
+    "PathModel",
+    "SweepConfig",
+    "RunSummary",
+    "SweepStats",
+    "SweepResult",
+    "SweepJournal",
+    "ClusterConfig",
+    "SweepCoordinator",
+    "ObjectiveKind",
+    "OptimizerKind",
+    "ParamBound",
+    "OptimizeConfig",
+    "Trial",
+    "OptimizeResult",
+    "CpcvConfig",
+    "CpcvSplit",
+    "CpcvResult",
+    "TreeOutput",
+    "TreeEnsemble",
+    "TripleBarrierConfig",
+    "BarrierLabels",
+    "EventStudyConfig",
+    "EventPanel",
+    "RuleProgram",
+    "RuleStrategy",
+    "FeatureKey",
+    "FeatureColumn",
+    "FeatureStore",
+    "SnapshotWriter",
+    "SnapshotReader",
+    "ResumableBacktest",
+    "SnapshotKey",
+    "SnapshotStore",
     "backtest",
+    "run_sweep",
+    "run_sweep_resumable",
+    "run_sweep_worker",
+    "optimize",
+    "run_cpcv",
+    "summarize",
+    "hash_result",
+    "hash_summaries",
+    "intrabar_path",
+    "forward_returns",
+    "triple_barrier_labels",
+    "event_study",
 ]
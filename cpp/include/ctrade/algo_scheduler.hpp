@@ -0,0 +1,83 @@
+#pragma once
+#include "execution_context.hpp"
+#include "fill.hpp"
+#include "market_state.hpp"
+#include "parent_order.hpp"
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ctrade {
+
+struct ParentStatus {
+  double sent = 0.0;   // total size of children sent
+  double filled = 0.0; // total size of children filled
+  bool done = false;   // filled or cancelled
+};
+
+// Expands parent orders into child orders sent to the parent's asset and
+// venue through ExecutionContext::submit_order, so a strategy does not have
+// to wake every bar to manage them. Scheduled algos top up to their
+// cumulative target at each slice boundary; unfilled limit children keep
+// working and count toward the target.
+class AlgoScheduler {
+public:
+  explicit AlgoScheduler(ExecutionContext &ctx);
+
+  // Returns the parent id; ids are separate from order ids.
+  int64_t submit(const ParentOrder &parent);
+
+  // Cancels the parent's working children.
+  void cancel(int64_t parent_id);
+
+  // Sends the children due at this bar. Call once per bar, before the
+  // strategy sees it.
+  void on_bar(const MarketState &bar);
+
+  // Attributes a fill to its parent and replenishes icebergs. Returns false
+  // if the fill is not from a child order.
+  bool on_fill(const Fill &fill);
+
+  const ParentStatus &status(int64_t parent_id) const;
+
+  // --- Driver hooks ---
+  // True if a parent on `asset_id` sizes children from every bar (POV).
+  bool needs_every_bar(int asset_id) const;
+
+  // Earliest pending slice start on `asset_id`, or INT64_MAX.
+  int64_t next_wake(int asset_id) const;
+
+  // Appends the limit prices of working children on `asset_id`.
+  void trigger_levels(int asset_id, TriggerLevels &levels) const;
+
+private:
+  struct Parent {
+    ParentOrder order;
+    ParentStatus status;
+    std::vector<double> cumulative; // scheduled: target fraction per slice
+    int next_slice = 0;
+    int working = 0; // children not yet fully filled
+  };
+
+  struct Child {
+    int64_t parent_id;
+    double remaining;
+  };
+
+  bool active(const Parent &parent, int asset_id) const;
+  int64_t slice_start(const Parent &parent, int slice) const;
+  void send(int64_t parent_id, double size);
+
+  ExecutionContext &ctx_;
+  std::vector<Parent> parents_; // indexed by parent id
+  std::unordered_map<int64_t, Child> children_;
+};
+
+// Share of volume in each of `slices` equal buckets of a repeating period
+// (e.g. a trading day), averaged over `bars`. Sums to 1; pass as the
+// volume_profile of a VWAP parent spanning one period.
+std::vector<double> intraday_volume_profile(std::span<const MarketState> bars,
+                                            int64_t period, int slices);
+
+} // namespace ctrade
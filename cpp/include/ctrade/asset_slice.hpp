@@ -0,0 +1,49 @@
+#pragma once
+#include "market_state.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// Cross-section of every asset at one timestamp. Columns are contiguous and
+// indexed by asset_id, or by venue_id * n_assets + asset_id across venues.
+struct AssetSlice {
+  int64_t timestamp;
+
+  std::span<const double> open;
+  std::span<const double> high;
+  std::span<const double> low;
+  std::span<const double> close;
+  std::span<const double> volume;
+  std::span<const double> funding_rate;
+
+  size_t size() const { return close.size(); }
+};
+
+// Owns the SoA columns behind an AssetSlice. Assets without a bar at the
+// current timestamp keep their previous values.
+class AssetSliceBuffer {
+public:
+  explicit AssetSliceBuffer(size_t n_assets, size_t n_venues = 1);
+
+  void begin(int64_t timestamp);
+  void set(const MarketState &market);
+
+  AssetSlice view() const;
+  size_t size() const { return close_.size(); }
+
+private:
+  size_t n_assets_;
+  int64_t timestamp_ = 0;
+
+  std::vector<double> open_;
+  std::vector<double> high_;
+  std::vector<double> low_;
+  std::vector<double> close_;
+  std::vector<double> volume_;
+  std::vector<double> funding_rate_;
+};
+
+} // namespace ctrade
@@ -11,4 +11,8 @@ struct BacktestResult {
   std::vector<double> drawdown;
 };
 
+// FNV-1a over the bit patterns of every series, for regression tests that
+// require bit-identical results.
+uint64_t hash_result(const BacktestResult &result);
+
 } // namespace ctrade
@@ -0,0 +1,94 @@
+#pragma once
+#include "market_data.hpp"
+#include "market_state.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// In-memory bar cache for one asset on one venue, stored as columns. Bars
+// are grouped into fixed-size blocks with a zone map so scans for price
+// levels can skip whole blocks. A bar's reach is its [low, high] widened to
+// the previous close, so a gap that jumps over a level still reaches it;
+// the zone map holds the min and max reach per block.
+class BarStore {
+public:
+  explicit BarStore(int asset_id, size_t block_size = 1024, int venue_id = 0);
+
+  // Timestamps must be strictly increasing.
+  void append(const MarketState &bar);
+
+  int asset_id() const { return asset_id_; }
+  int venue_id() const { return venue_id_; }
+  size_t size() const { return timestamp_.size(); }
+  size_t block_size() const { return block_size_; }
+  size_t n_blocks() const { return block_low_.size(); }
+
+  // Running hash of every bar appended so far, updated in O(1) by append(),
+  // so fingerprinting the contents never rescans the columns.
+  uint64_t content_hash() const { return content_hash_; }
+
+  // Bid/ask/mid and mark/index prices are set to the close.
+  MarketState at(size_t i) const;
+
+  std::span<const int64_t> timestamps() const { return timestamp_; }
+  std::span<const double> open() const { return open_; }
+  std::span<const double> high() const { return high_; }
+  std::span<const double> low() const { return low_; }
+  std::span<const double> close() const { return close_; }
+  std::span<const double> volume() const { return volume_; }
+  std::span<const double> funding_rate() const { return funding_rate_; }
+
+  double block_low(size_t block) const { return block_low_[block]; }
+  double block_high(size_t block) const { return block_high_[block]; }
+
+  // First index whose timestamp is >= `timestamp`.
+  size_t lower_bound(int64_t timestamp) const;
+
+  // First index in [from, to) whose reach contains one of `sorted_levels`
+  // (ascending); `to` if there is none.
+  size_t next_touch(size_t from, size_t to,
+                    std::span<const double> sorted_levels) const;
+
+private:
+  int asset_id_;
+  int venue_id_;
+  size_t block_size_;
+  uint64_t content_hash_;
+
+  std::vector<int64_t> timestamp_;
+  std::vector<double> open_;
+  std::vector<double> high_;
+  std::vector<double> low_;
+  std::vector<double> close_;
+  std::vector<double> volume_;
+  std::vector<double> funding_rate_;
+
+  std::vector<double> block_low_;
+  std::vector<double> block_high_;
+};
+
+// Streams a range of a BarStore, cursor-style.
+class BarStoreMarketData : public MarketData {
+public:
+  explicit BarStoreMarketData(
+      const BarStore &store, size_t begin = 0,
+      size_t end = std::numeric_limits<size_t>::max());
+
+  bool next() override;
+  const MarketState &current() const override { return current_; }
+
+  void skip_quiet(std::span<const double> sorted_levels,
+                  int64_t until_ts) override;
+
+private:
+  const BarStore &store_;
+  size_t next_;
+  size_t end_;
+  MarketState current_{};
+};
+
+} // namespace ctrade
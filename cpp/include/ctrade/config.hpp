@@ -12,6 +12,12 @@ struct DatabaseConfig {
   std::string password;
 };
 
+// Fees as a fraction of notional.
+struct FeeSchedule {
+  double maker;
+  double taker;
+};
+
 struct BacktestConfig {
   DatabaseConfig db_config;
   int64_t start_ts;
@@ -19,4 +25,13 @@ struct BacktestConfig {
   // For now: single asset (BTCUSDT), will expand to multi-asset later
 };
 
+struct SweepConfig {
+  unsigned threads = 0; // 0 = one per hardware core
+  uint64_t seed = 0;
+
+  // Results independent of thread count and scheduling: one RNG stream per
+  // run and statistics reduced in input order.
+  bool deterministic = true;
+};
+
 } // namespace ctrade
@@ -0,0 +1,166 @@
+#pragma once
+#include "fill.hpp"
+#include "market_state.hpp"
+#include "strategy.hpp"
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ctrade {
+
+// Return type of coroutine strategy bodies. Owns the coroutine frame.
+class StrategyTask {
+public:
+  struct promise_type {
+    std::exception_ptr error;
+
+    StrategyTask get_return_object() {
+      return StrategyTask{
+          std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+  StrategyTask(StrategyTask &&other) noexcept
+      : handle_(std::exchange(other.handle_, {})) {}
+  StrategyTask &operator=(StrategyTask &&other) noexcept;
+  StrategyTask(const StrategyTask &) = delete;
+  StrategyTask &operator=(const StrategyTask &) = delete;
+  ~StrategyTask();
+
+  bool done() const { return !handle_ || handle_.done(); }
+
+  // Rethrows an exception that escaped the coroutine body, if any.
+  void rethrow_if_failed() const;
+
+private:
+  friend class CoroutineStrategy;
+
+  explicit StrategyTask(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Strategy written as a coroutine instead of a state machine in on_bar:
+//
+//   StrategyTask run(ExecutionContext &ctx) override {
+//     for (;;) {
+//       MarketState bar = co_await next_bar();
+//       int64_t id = ctx.limit_buy(1.0, bar.close * 0.99);
+//       if (!co_await fill_of(id, 3600)) ctx.cancel_order(id);
+//     }
+//   }
+//
+// Suspended coroutines are resumed only when what they await happens, so
+// bars with no bar waiters and no expired timeouts cost O(1). Timeouts are
+// also registered with ExecutionContext::schedule_timer so they fire on time
+// even between bars.
+// Timestamps and durations use MarketState::timestamp units.
+class CoroutineStrategy : public Strategy {
+public:
+  void on_bar(const MarketState &market, ExecutionContext &ctx) override;
+  void on_fill(const Fill &fill, ExecutionContext &ctx) override;
+  void on_timer(const TimerEvent &timer, ExecutionContext &ctx) override;
+
+private:
+  struct Waiter {
+    std::coroutine_handle<> handle;
+    int64_t order_id = -1;
+    std::optional<Fill> fill;
+  };
+
+  struct BarAwaiter {
+    CoroutineStrategy *self;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      self->bar_waiters_.push_back(h);
+    }
+    MarketState await_resume() const { return *self->market_; }
+  };
+
+  struct FillAwaiter {
+    CoroutineStrategy *self;
+    int64_t order_id;
+    int64_t max_wait; // < 0 = wait forever
+    Waiter waiter{};
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    std::optional<Fill> await_resume() const { return waiter.fill; }
+  };
+
+  struct TimeoutAwaiter {
+    CoroutineStrategy *self;
+    int64_t duration;
+    Waiter waiter{};
+
+    bool await_ready() const noexcept { return duration <= 0; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+  };
+
+protected:
+  // Main body, started on the first bar. `ctx` stays valid for the run.
+  virtual StrategyTask run(ExecutionContext &ctx) = 0;
+
+  // Runs another task alongside run(), e.g. one per asset.
+  void spawn(StrategyTask task);
+
+  int64_t now() const { return now_; }
+
+  // --- Awaitables ---
+  BarAwaiter next_bar() { return BarAwaiter{this}; }
+
+  // Resumes on the first fill of `order_id`, or with nullopt once
+  // `max_wait` has passed. Several tasks may await the same order; each
+  // gets that fill. Fills nobody awaits are not buffered.
+  FillAwaiter fill_of(int64_t order_id, int64_t max_wait = -1) {
+    return FillAwaiter{this, order_id, max_wait};
+  }
+
+  TimeoutAwaiter timeout(int64_t duration) {
+    return TimeoutAwaiter{this, duration};
+  }
+
+private:
+  struct Timer {
+    int64_t deadline;
+    uint64_t ticket;
+    bool operator>(const Timer &other) const {
+      return deadline != other.deadline ? deadline > other.deadline
+                                        : ticket > other.ticket;
+    }
+  };
+
+  uint64_t add_waiter(Waiter &waiter);
+  void add_timer(int64_t deadline, uint64_t ticket);
+  void fire_timers();
+  void resume(std::coroutine_handle<> handle);
+  void resume_all(const std::vector<std::coroutine_handle<>> &handles);
+
+  bool started_ = false;
+  ExecutionContext *ctx_ = nullptr;
+  int64_t now_ = 0;
+  const MarketState *market_ = nullptr;
+
+  std::vector<StrategyTask> tasks_;
+  std::vector<std::coroutine_handle<>> bar_waiters_;
+
+  uint64_t next_ticket_ = 0;
+  std::unordered_map<uint64_t, Waiter *> waiters_;
+  std::unordered_multimap<int64_t, uint64_t> fill_tickets_;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+};
+
+} // namespace ctrade
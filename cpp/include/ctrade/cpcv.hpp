@@ -0,0 +1,67 @@
+#pragma once
+#include "config.hpp"
+#include "sweep.hpp"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ctrade {
+
+// Combinatorial purged cross-validation (Lopez de Prado). The bar range is
+// cut into n_groups contiguous groups; every choice of n_test_groups groups
+// is one split, trained on the remaining groups less the purged and
+// embargoed bars around each test group.
+struct CpcvConfig {
+  size_t n_groups = 6;
+  size_t n_test_groups = 2;
+  size_t purge = 0;   // training bars dropped before each test group
+  size_t embargo = 0; // training bars dropped after each test group
+};
+
+using BarRange = std::pair<size_t, size_t>; // [begin, end)
+
+// All k-subsets of [0, n) in lexicographic order.
+std::vector<std::vector<size_t>> combinations(size_t n, size_t k);
+
+// n_groups near-equal ranges covering [0, n_bars).
+std::vector<BarRange> cpcv_groups(size_t n_bars, size_t n_groups);
+
+// Training ranges for one split, in bar order.
+std::vector<BarRange> cpcv_train_ranges(const std::vector<BarRange> &groups,
+                                        const std::vector<size_t> &test_groups,
+                                        size_t purge, size_t embargo);
+
+struct CpcvSplit {
+  std::vector<size_t> test_groups;
+  size_t selected;     // parameter set with the best training Sharpe
+  double train_sharpe;
+  double test_sharpe;
+  double test_rank; // selected's out-of-sample rank / (n_params + 1)
+};
+
+struct CpcvResult {
+  std::vector<BarRange> groups;
+  std::vector<CpcvSplit> splits; // in combinations() order
+
+  // One Sharpe per backtest path: k/N * C(N, k) paths, each stitched from
+  // the test groups of different splits.
+  std::vector<double> path_sharpe;
+
+  // Probability of backtest overfitting: the share of splits whose
+  // selection ranks at or below the out-of-sample median.
+  double pbo = 0.0;
+  double mean_train_sharpe = 0.0;
+  double mean_test_sharpe = 0.0;
+
+  size_t n_runs = 0; // backtests executed
+};
+
+// Runs each parameter set once over the full range, then scores every
+// split from per-bar return prefix sums. Parameter choices carry no fitted
+// state, so a bar's return is the same in every split that contains it and
+// all C(N, k) splits share the one run instead of repeating it. Every run
+// must return an equity curve of the same length.
+CpcvResult run_cpcv(const std::vector<ParamSet> &params, const RunFn &run,
+                    const CpcvConfig &cpcv, const SweepConfig &config);
+
+} // namespace ctrade
@@ -0,0 +1,47 @@
+#pragma once
+#include "fill.hpp"
+#include "tick.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+
+namespace ctrade {
+
+// Events at the same timestamp are dispatched in this order, so fills from
+// the previous step are seen before new market data.
+enum class EventType : uint8_t { Fill, Liquidation, Funding, Timer, Tick, Bar };
+
+struct FundingEvent {
+  int asset_id;
+  int venue_id;
+  int64_t timestamp;
+  double rate;
+  double mark_price;
+};
+
+struct LiquidationEvent {
+  int asset_id;
+  int venue_id;
+  int64_t timestamp;
+  double price;
+  double size;
+};
+
+struct TimerEvent {
+  int64_t timer_id;
+  int64_t timestamp;
+};
+
+struct Event {
+  EventType type;
+  int64_t timestamp;
+
+  // Bar events only name their market data source; the bar itself stays in
+  // the source until it is dispatched.
+  size_t source = 0;
+  std::variant<std::monostate, Fill, LiquidationEvent, FundingEvent,
+               TimerEvent, Tick>
+      data;
+};
+
+} // namespace ctrade
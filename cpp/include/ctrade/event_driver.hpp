@@ -0,0 +1,102 @@
+#pragma once
+#include "algo_scheduler.hpp"
+#include "asset_slice.hpp"
+#include "event_queue.hpp"
+#include "execution_context.hpp"
+#include "market_data.hpp"
+#include "risk.hpp"
+#include "strategy.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace ctrade {
+
+// Fills `levels` with the resting order and stop prices of `asset_id`.
+// Returns false if the next bar must be seen regardless of price, e.g.
+// because a market order is pending.
+using TriggerLevelsFn =
+    std::function<bool(int asset_id, TriggerLevels &levels)>;
+
+// Merges bars, ticks, timers, funding, fills and liquidations into one
+// time-ordered stream and dispatches each to the matching Strategy callback.
+// Strategies only pay for the events that actually occur instead of polling
+// in on_bar.
+class EventDriver {
+public:
+  EventDriver(Strategy &strategy, ExecutionContext &ctx);
+
+  // Required for WakeMode::TriggersOnly; without it every bar is delivered.
+  void set_trigger_levels(TriggerLevelsFn levels);
+
+  // Feeds bars and fills to `algos` ahead of the strategy. Quiet-bar
+  // skipping stops at its slice times and children's limit prices, so the
+  // strategy can sleep while parent orders are worked.
+  void set_algo_scheduler(AlgoScheduler &algos) { algos_ = &algos; }
+
+  // Streams bars from `source`, read cursor-style (next() before current()).
+  // Each source keeps one pending bar in the queue.
+  void add_market_data(MarketData &source);
+
+  // Also deliver on_slice once every event at a timestamp is dispatched,
+  // i.e. when the next event is later, so bars from every source and venue
+  // at that timestamp are in.
+  void enable_slices(size_t n_assets, size_t n_venues = 1);
+
+  // Also update an EWMA covariance of close-to-close returns from each
+  // slice, before on_slice runs. Requires enable_slices().
+  void enable_risk(double lambda);
+  EwmaCovariance *risk() { return risk_ ? &*risk_ : nullptr; }
+
+  // Events timestamped before now() are dispatched at now().
+  int64_t schedule_timer(int64_t timestamp);
+  void push_tick(const Tick &tick);
+  void push_fill(const Fill &fill);
+  void push_funding(const FundingEvent &event);
+  void push_liquidation(const LiquidationEvent &event);
+
+  // Dispatches events until the queue is empty or the next one is after
+  // end_ts.
+  void run(int64_t end_ts = std::numeric_limits<int64_t>::max());
+
+  int64_t now() const { return now_; }
+
+private:
+  void push(Event event);
+  void advance(size_t source);
+  void skip_quiet_bars(size_t source);
+  void dispatch(const Event &event);
+  void dispatch_bar(const Event &event);
+  void flush_slice();
+
+  Strategy &strategy_;
+  ExecutionContext &ctx_;
+
+  EventQueue queue_;
+  std::vector<MarketData *> sources_;
+  size_t active_sources_ = 0;
+
+  WakePolicy wake_;
+  TriggerLevelsFn trigger_levels_;
+  AlgoScheduler *algos_ = nullptr;
+  TriggerLevels levels_;
+  std::vector<double> sorted_levels_; // both directions, ascending
+  int64_t periodic_timer_id_ = -1;
+
+  // Timestamps of queued non-bar events; bars are never skipped past them.
+  std::priority_queue<int64_t, std::vector<int64_t>, std::greater<int64_t>>
+      wake_times_;
+
+  std::optional<AssetSliceBuffer> slices_;
+  int64_t slice_ts_ = std::numeric_limits<int64_t>::min();
+  bool slice_pending_ = false; // bars at slice_ts_ not yet delivered
+  std::optional<EwmaCovariance> risk_;
+
+  int64_t now_ = std::numeric_limits<int64_t>::min();
+  int64_t next_timer_id_ = 0;
+};
+
+} // namespace ctrade
@@ -0,0 +1,40 @@
+#pragma once
+#include "event.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace ctrade {
+
+// Time-ordered event queue: a 4-ary min-heap of small keys ordered by
+// (timestamp, type, insertion order). Events live in a slot pool so sifting
+// never moves payloads.
+class EventQueue {
+public:
+  void push(Event event);
+  Event pop();
+
+  const Event &top() const { return slots_[heap_.front().slot]; }
+  bool empty() const { return heap_.empty(); }
+  size_t size() const { return heap_.size(); }
+
+private:
+  struct Key {
+    int64_t timestamp;
+    uint64_t seq;
+    uint32_t slot;
+    EventType type;
+  };
+
+  static constexpr size_t kArity = 4;
+
+  static bool before(const Key &a, const Key &b);
+  void sift_up(size_t i);
+  void sift_down(size_t i);
+
+  std::vector<Key> heap_;
+  std::vector<Event> slots_;
+  std::vector<uint32_t> free_slots_;
+  uint64_t next_seq_ = 0;
+};
+
+} // namespace ctrade
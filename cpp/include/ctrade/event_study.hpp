@@ -0,0 +1,65 @@
+#pragma once
+#include "bar_store.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// --- Event selection ---
+
+// Sets mask[k] (0/1) for bars begin + k of `bars`. Called concurrently on
+// disjoint ranges, so it must not touch shared mutable state.
+using EventMaskFn = std::function<void(const BarStore &bars, size_t begin,
+                                       std::span<uint8_t> mask)>;
+
+// True when bar i of `bars` is an event.
+using EventPredicate = std::function<bool(const BarStore &bars, size_t i)>;
+
+struct EventStudyConfig {
+  size_t before = 10; // bars kept before each event
+  size_t after = 10;  // bars kept after each event
+  size_t cooldown = 0; // matches within this many bars of an event are dropped
+  unsigned threads = 0;
+};
+
+// --- Aligned panels ---
+
+// One row per event, ordered by store and then bar; one column per offset
+// -before .. +after. Panels are row-major n_events() x width() and hold NaN
+// where the window runs past the data.
+struct EventPanel {
+  size_t before = 0;
+  size_t after = 0;
+
+  std::vector<uint32_t> store; // index into the stores passed in
+  std::vector<uint32_t> bar;   // event bar within its store
+  std::vector<int64_t> timestamp;
+
+  std::vector<double> returns; // close[i + k] / close[i] - 1
+  std::vector<double> volume;
+  std::vector<double> funding_rate;
+
+  size_t n_events() const { return bar.size(); }
+  size_t width() const { return before + after + 1; }
+};
+
+// Scans every store in parallel time chunks, thins the matches by the
+// cooldown and gathers the windows around them. The result does not depend
+// on the thread count.
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       const EventMaskFn &mask,
+                       const EventStudyConfig &config = {});
+
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       const EventPredicate &predicate,
+                       const EventStudyConfig &config = {});
+
+// Events from precomputed masks, one byte per bar of each store.
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       std::span<const std::span<const uint8_t>> masks,
+                       const EventStudyConfig &config = {});
+
+} // namespace ctrade
@@ -1,26 +1,58 @@
 #pragma once
+#include "order.hpp"
+#include "parent_order.hpp"
+#include <cstdint>
+#include <span>
+#include <stdexcept>
 
 namespace ctrade {
 
+// Order entry methods return the id of the submitted order.
 struct ExecutionContext {
   // --- Market orders ---
-  virtual void market_buy(double size) = 0;
-  virtual void market_sell(double size) = 0;
+  virtual int64_t market_buy(double size) = 0;
+  virtual int64_t market_sell(double size) = 0;
 
   // --- Limit orders ---
-  virtual void limit_buy(double size, double price) = 0;
-  virtual void limit_sell(double size, double price) = 0;
+  virtual int64_t limit_buy(double size, double price) = 0;
+  virtual int64_t limit_sell(double size, double price) = 0;
 
   // --- Stops ---
-  virtual void stop_buy(double size, double stop_price) = 0;
-  virtual void stop_sell(double size, double stop_price) = 0;
+  virtual int64_t stop_buy(double size, double stop_price) = 0;
+  virtual int64_t stop_sell(double size, double stop_price) = 0;
 
   // --- Stop-limits ---
-  virtual void stop_limit_buy(double size, double stop_price,
-                              double limit_price) = 0;
+  virtual int64_t stop_limit_buy(double size, double stop_price,
+                                 double limit_price) = 0;
 
-  virtual void stop_limit_sell(double size, double stop_price,
-                               double limit_price) = 0;
+  virtual int64_t stop_limit_sell(double size, double stop_price,
+                                  double limit_price) = 0;
+
+  // --- Routed orders ---
+  // Sends `order` to its asset and venue; id and timestamp are ignored.
+  // The default serves contexts trading one asset on one venue and throws
+  // std::invalid_argument for any other.
+  virtual int64_t submit_order(const Order &order) {
+    if (order.asset_id != 0 || order.venue_id != 0) {
+      throw std::invalid_argument(
+          "ExecutionContext: context cannot route by asset or venue");
+    }
+    const bool buy = order.side == Side::Buy;
+    switch (order.type) {
+    case OrderType::Market:
+      return buy ? market_buy(order.size) : market_sell(order.size);
+    case OrderType::Limit:
+      return buy ? limit_buy(order.size, order.price)
+                 : limit_sell(order.size, order.price);
+    case OrderType::Stop:
+      return buy ? stop_buy(order.size, order.stop_price)
+                 : stop_sell(order.size, order.stop_price);
+    case OrderType::StopLimit:
+      return buy ? stop_limit_buy(order.size, order.stop_price, order.price)
+                 : stop_limit_sell(order.size, order.stop_price, order.price);
+    }
+    throw std::invalid_argument("ExecutionContext: unknown order type");
+  }
 
   // --- Position management ---
   virtual void close_position() = 0;
@@ -28,10 +60,35 @@ struct ExecutionContext {
   virtual void close_short() = 0;
   virtual void close_amount(double size) = 0;
 
+  // --- Batched rebalancing ---
+  // One weight per asset_id, as a fraction of equity (negative = short).
+  virtual void set_target_weights(std::span<const double> weights) = 0;
+
+  // One signed position per asset_id; only the rounded differences to the
+  // current positions are sent as orders (see rebalance_orders).
+  virtual void set_target_positions(std::span<const double> positions) = 0;
+
   // --- Order management ---
-  virtual void cancel_order(int order_id) = 0;
+  virtual void cancel_order(int64_t order_id) = 0;
   virtual void cancel_all() = 0;
 
+  // Changes a resting order in place, keeping its id. Reducing size keeps
+  // queue priority; a larger size or a new price goes to the back of the
+  // queue (see OrderBook::amend). For plain stops `new_price` is the
+  // trigger.
+  virtual void amend_order(int64_t order_id, double new_size,
+                           double new_price) = 0;
+
+  // --- Algorithmic parent orders ---
+  // Worked by the engine through child orders (see AlgoScheduler); returns
+  // the parent id.
+  virtual int64_t submit_parent_order(const ParentOrder &parent) = 0;
+  virtual void cancel_parent_order(int64_t parent_id) = 0;
+
+  // --- Timers ---
+  // Requests an on_timer callback at `timestamp`; returns the timer id.
+  virtual int64_t schedule_timer(int64_t timestamp) = 0;
+
   // --- Futures controls ---
   virtual void set_leverage(int lev) = 0;
   virtual void set_cross_mode() = 0;
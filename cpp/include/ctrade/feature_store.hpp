@@ -0,0 +1,90 @@
+#pragma once
+#include "bar_store.hpp"
+#include "sweep.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace ctrade {
+
+// Identity of a feature definition. Bump `version` when the computation
+// changes; old columns are then simply no longer found.
+struct FeatureKey {
+  std::string name;
+  ParamSet params;
+  uint32_t version = 1;
+};
+
+uint64_t feature_id(const FeatureKey &key);
+
+// Hash of a bar cache's identity and contents, O(1) from the store's running
+// content_hash(). A column is only reused for bars with the same
+// fingerprint, so revised or extended data recomputes.
+uint64_t bars_fingerprint(const BarStore &bars);
+
+// Read-only memory-mapped column, one value per bar of the BarStore it was
+// computed over (row i belongs to bar i).
+class FeatureColumn {
+public:
+  ~FeatureColumn();
+
+  FeatureColumn(const FeatureColumn &) = delete;
+  FeatureColumn &operator=(const FeatureColumn &) = delete;
+
+  std::span<const double> values() const { return {values_, size_}; }
+  size_t size() const { return size_; }
+  double operator[](size_t i) const { return values_[i]; }
+
+private:
+  friend class FeatureStore;
+  FeatureColumn(void *map, size_t map_bytes, size_t size);
+
+  void *map_;
+  size_t map_bytes_;
+  const double *values_;
+  size_t size_;
+};
+
+// Shared by every strategy and sweep run reading the feature.
+using FeatureHandle = std::shared_ptr<const FeatureColumn>;
+
+// Fills `out` (one slot per bar, preset to NaN) from `bars`.
+using FeatureFn =
+    std::function<void(const BarStore &bars, std::span<double> out)>;
+
+// Directory of feature columns, one file per (feature, bars) pair named by
+// both hashes. Files hold a fixed header and the values in native byte
+// order, are written to a temporary name and renamed into place, and are
+// mapped rather than read, so processes sharing a directory share pages.
+class FeatureStore {
+public:
+  explicit FeatureStore(std::string directory);
+
+  // Maps the stored column, computing and persisting it first if missing or
+  // unreadable. Thread-safe; concurrent callers for the same column wait
+  // for one computation.
+  FeatureHandle get(const FeatureKey &key, const BarStore &bars,
+                    const FeatureFn &compute);
+
+  // The stored column, or nullptr without computing.
+  FeatureHandle find(const FeatureKey &key, const BarStore &bars);
+
+  // Columns computed by this store since construction.
+  size_t computed() const;
+
+private:
+  std::string path(uint64_t id, uint64_t fingerprint) const;
+
+  std::string directory_;
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_future<FeatureHandle>> open_;
+  size_t computed_ = 0;
+};
+
+} // namespace ctrade
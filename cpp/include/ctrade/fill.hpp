@@ -5,10 +5,13 @@ namespace ctrade {
 
 struct Fill {
   int64_t order_id;
+  int asset_id;
+  int venue_id;
   double price;
   double size;
   double fee;
   int64_t timestamp;
+  bool maker = false; // rested on the book rather than crossing the spread
 };
 
 } // namespace ctrade
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Internal: 64-bit FNV-1a for fingerprints, cache keys and checksums. Words
+// are mixed low byte first, so hashes do not depend on host byte order.
+
+namespace ctrade {
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+inline void fnv_bytes(uint64_t &h, const uint8_t *data, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    h = (h ^ data[i]) * kFnvPrime;
+  }
+}
+
+inline void fnv_word(uint64_t &h, uint64_t word) {
+  for (int byte = 0; byte < 8; ++byte) {
+    h = (h ^ ((word >> (8 * byte)) & 0xff)) * kFnvPrime;
+  }
+}
+
+} // namespace ctrade
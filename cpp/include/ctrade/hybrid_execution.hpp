@@ -0,0 +1,59 @@
+#pragma once
+#include "config.hpp"
+#include "execution_engine.hpp"
+#include "intrabar_path.hpp"
+#include "rng.hpp"
+#include "tick_source.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace ctrade {
+
+// Bar-level execution that drops to trade granularity only where it
+// matters: when a bar's [low, high] reaches a limit or stop price, that
+// bar's trades are loaded from the tick cache and the order is resolved
+// against them. Bars that touch no order never load ticks.
+//
+// Limit orders fill only when trades print through the limit (a print at
+// exactly the limit may have filled orders queued ahead of ours). Stops
+// fill at the first trade at or beyond the trigger. If a bar has no ticks,
+// its orders are resolved along the configured intrabar path model.
+class HybridExecutionEngine : public ExecutionEngine {
+public:
+  HybridExecutionEngine(TickCache &ticks, FeeSchedule fees,
+                        int64_t bar_duration,
+                        PathModel path_model = PathModel::NearestFirst,
+                        uint64_t seed = 0);
+
+  // Appends every OHLC-resolved bar whose outcome depends on the path model,
+  // for later use with sample_ambiguous_paths().
+  void record_ambiguous(std::vector<AmbiguousBar> *sink) { ambiguous_ = sink; }
+
+  // Fills are returned in time order.
+  std::vector<Fill> execute(const std::vector<Order> &orders,
+                            const MarketState &market) override;
+
+private:
+  Fill make_fill(const Order &order, double price, int64_t timestamp,
+                 bool maker) const;
+
+  std::optional<Fill> execute_market(const Order &order,
+                                     const MarketState &market) const;
+  std::optional<Fill> resolve_on_ticks(const Order &order,
+                                       const MarketState &market,
+                                       std::span<const Tick> ticks) const;
+  TickCache &ticks_;
+  FeeSchedule fees_;
+  int64_t bar_duration_;
+
+  PathModel path_model_;
+  CounterRng rng_;
+  std::vector<AmbiguousBar> *ambiguous_ = nullptr;
+  std::vector<Order> path_orders_;
+};
+
+// True if the bar's range reaches the order's limit or trigger price.
+bool bar_touches(const Order &order, const MarketState &market);
+
+} // namespace ctrade
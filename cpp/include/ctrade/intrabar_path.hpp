@@ -0,0 +1,69 @@
+#pragma once
+#include "config.hpp"
+#include "fill.hpp"
+#include "market_state.hpp"
+#include "order.hpp"
+#include "rng.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// How price is assumed to move inside a bar when only OHLC is known.
+enum class PathModel {
+  OHLC,           // open -> high -> low -> close
+  OLHC,           // open -> low -> high -> close
+  NearestFirst,   // visits whichever extreme is closer to the open first
+  BrownianBridge, // extreme order drawn from a bridge between open and close
+};
+
+// Waypoints open, first extreme, second extreme, close. BrownianBridge
+// requires `rng`.
+std::vector<double> intrabar_path(const MarketState &bar, PathModel model,
+                                  CounterRng *rng = nullptr);
+
+// True if `order` was submitted at or after the bar's open, so it meets the
+// market for the first time in this bar. Only such a limit can arrive
+// marketable and take liquidity; a resting limit the market gaps through
+// fills at its limit as maker, as it would on a continuous venue.
+bool submitted_in(const Order &order, const MarketState &bar);
+
+// Resolves orders against a piecewise-linear path across the bar and
+// returns their fills in path order. Fill timestamps are interpolated over
+// [bar.timestamp, bar.timestamp + bar_duration).
+std::vector<Fill> resolve_on_path(std::span<const Order> orders,
+                                  std::span<const double> path,
+                                  const MarketState &bar,
+                                  int64_t bar_duration, FeeSchedule fees);
+
+// True if the bar reaches orders both above and below its open, so their
+// fill order depends on the path model.
+bool is_ambiguous(std::span<const Order> touched, const MarketState &bar);
+
+// A bar whose outcome depends on the intrabar path, with the orders it
+// touched.
+struct AmbiguousBar {
+  MarketState bar;
+  std::vector<Order> orders;
+};
+
+// Fills of each ambiguous bar under one sampled set of paths, in time order.
+using PathOutcomeFn =
+    std::function<double(std::span<const std::vector<Fill>> fills)>;
+
+// Monte Carlo over intrabar paths. Each sample draws a Brownian-bridge path
+// for every ambiguous bar, re-resolves only those bars and reduces their
+// fills to one number with `evaluate`. Orders outside ambiguous bars, and
+// the strategy's later reactions, are held fixed. Sample i uses RNG stream
+// i, so the distribution does not depend on the thread count.
+std::vector<double> sample_ambiguous_paths(std::span<const AmbiguousBar> bars,
+                                           size_t n_samples,
+                                           const PathOutcomeFn &evaluate,
+                                           int64_t bar_duration,
+                                           FeeSchedule fees,
+                                           const SweepConfig &config);
+
+} // namespace ctrade
@@ -0,0 +1,62 @@
+#pragma once
+#include "bar_store.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// Research labels over a BarStore, one value per bar. Work is split into
+// time chunks (and across stores) on the thread pool; every bar's label
+// depends only on the data, so results do not depend on the thread count.
+
+// --- Forward returns ---
+
+// close[i + h] / close[i] - 1 per horizon h, NaN where i + h is past the
+// end. One column per horizon.
+std::vector<std::vector<double>>
+forward_returns(const BarStore &bars, std::span<const size_t> horizons,
+                unsigned threads = 0);
+
+// --- Triple barrier ---
+
+// Entry at bar i's close. The upper barrier sits at close * (1 + take_profit
+// * scale[i]) and the lower at close * (1 - stop_loss * scale[i]); without
+// a scale column the distances are plain fractions. A distance <= 0
+// disables that barrier. The vertical barrier is max_holding bars later.
+struct TripleBarrierConfig {
+  double take_profit = 0.01;
+  double stop_loss = 0.01;
+  size_t max_holding = 60;
+};
+
+// label: +1 upper touched first, -1 lower, 0 vertical. A bar whose range
+// touches both counts as the stop. ret is the barrier's return for a touch
+// and close-to-close for the vertical barrier; exit is the bar of the
+// touch or the vertical barrier. Bars whose window runs past the data
+// without a touch get label 0, ret NaN and exit = bars.size().
+struct BarrierLabels {
+  std::vector<int8_t> label;
+  std::vector<double> ret;
+  std::vector<size_t> exit;
+};
+
+// One store with its (optional) scale column, e.g. rolling volatility.
+struct LabelJob {
+  const BarStore *bars;
+  std::span<const double> scale;
+};
+
+// First touches are found by scanning forward with per-chunk high/low
+// extrema, so quiet stretches inside the window are skipped whole.
+BarrierLabels triple_barrier_labels(const BarStore &bars,
+                                    const TripleBarrierConfig &config,
+                                    std::span<const double> scale = {},
+                                    unsigned threads = 0);
+
+std::vector<BarrierLabels>
+triple_barrier_labels(std::span<const LabelJob> jobs,
+                      const TripleBarrierConfig &config, unsigned threads = 0);
+
+} // namespace ctrade
@@ -1,11 +1,23 @@
 #pragma once
 #include "market_state.hpp"
+#include <cstdint>
+#include <span>
 
 namespace ctrade {
 
 struct MarketData {
   virtual bool next() = 0;
   virtual const MarketState &current() const = 0;
+
+  // Advances past bars that cannot reach any of `sorted_levels`: neither
+  // their [low, high] nor the gap from the previous close contains one.
+  // Stops before the first bar at or after `until_ts`. Sources without an
+  // index may ignore this.
+  virtual void skip_quiet(std::span<const double> sorted_levels,
+                          int64_t until_ts) {
+    (void)sorted_levels;
+    (void)until_ts;
+  }
   virtual ~MarketData() = default;
 };
 
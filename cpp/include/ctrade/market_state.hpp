@@ -5,6 +5,7 @@ namespace ctrade {
 
 struct MarketState {
   int asset_id;  // Runtime asset identifier (0 = BTCUSDT for now)
+  int venue_id;  // Index into the run's venues (0 = default venue)
   int64_t timestamp;
 
   double open;
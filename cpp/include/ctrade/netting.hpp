@@ -0,0 +1,102 @@
+#pragma once
+#include "fill.hpp"
+#include "order.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ctrade {
+
+// Several strategies trading out of one book. Each bar, their market orders
+// are netted per (venue, asset) before reaching the execution engine:
+// opposing sizes cross internally at the bar's reference price without
+// fees, and only the remainder is sent out as a single order. Engine fills
+// are split back across the strategies that contributed to it.
+
+struct StrategyFill {
+  size_t strategy;
+  Side side;
+  Fill fill;
+};
+
+struct NettingStats {
+  size_t orders_in = 0;      // submitted by strategies
+  size_t orders_out = 0;     // sent to the execution engine
+  double crossed_size = 0.0; // matched internally, per side
+};
+
+class OrderNetter {
+public:
+  explicit OrderNetter(size_t n_strategies);
+
+  // Queues an order from `strategy` for the current bar and returns its id.
+  // Ids are unique across strategies and netted orders.
+  int64_t submit(size_t strategy, Order order);
+
+  // Nets the queued market orders and clears the queue. `prices` holds the
+  // cross price per asset_id. Internal crosses are appended to `crossed`;
+  // the returned orders go to the execution engine, netted market orders
+  // first in (venue, asset) order, then other orders unchanged.
+  std::vector<Order> net(std::span<const double> prices, int64_t timestamp,
+                         std::vector<StrategyFill> &crossed);
+
+  // Splits fills of orders returned by net() across their strategies, pro
+  // rata to each one's share of the netted size; fees are split the same
+  // way. Fills of pass-through orders go to their owner unchanged.
+  std::vector<StrategyFill> attribute(std::span<const Fill> fills);
+
+  // Forgets a cancelled order. Fully filled orders are forgotten on their
+  // own.
+  void cancel(int64_t order_id) { routed_.erase(order_id); }
+
+  const NettingStats &stats() const { return stats_; }
+
+private:
+  struct Share {
+    size_t strategy;
+    int64_t order_id; // as submitted by the strategy
+    double fraction;
+  };
+  struct Routed {
+    Side side;
+    double remaining;
+    std::vector<Share> shares;
+  };
+
+  size_t n_strategies_;
+  int64_t next_id_ = 1;
+  std::vector<std::pair<size_t, Order>> pending_;
+  std::map<int64_t, Routed> routed_; // by order id sent to the engine
+  NettingStats stats_;
+};
+
+// Per-strategy sleeves of one capital pool: each strategy's cash and signed
+// positions per asset_id (summed across venues), built from attributed
+// fills. The pool's equity is the sum of the sleeves.
+class StrategyBook {
+public:
+  StrategyBook(std::span<const double> initial_cash, size_t n_assets);
+
+  void apply(const StrategyFill &fill);
+
+  size_t n_strategies() const { return cash_.size(); }
+  double cash(size_t strategy) const { return cash_.at(strategy); }
+  double position(size_t strategy, int asset_id) const;
+  double fees(size_t strategy) const { return fees_.at(strategy); }
+
+  double equity(size_t strategy, std::span<const double> prices) const;
+  double total_equity(std::span<const double> prices) const;
+
+private:
+  size_t slot(size_t strategy, int asset_id) const;
+
+  size_t n_assets_;
+  std::vector<double> cash_;
+  std::vector<double> fees_;
+  std::vector<double> position_; // strategy * n_assets + asset_id
+};
+
+} // namespace ctrade
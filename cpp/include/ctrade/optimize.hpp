@@ -0,0 +1,100 @@
+#pragma once
+#include "config.hpp"
+#include "sweep.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+struct ParamBound {
+  double low;
+  double high;
+  bool integer = false; // rounded to the nearest integer in [low, high]
+};
+
+// Score of one run; higher is better. Non-finite scores rank last.
+using Objective = std::function<double(const RunSummary &)>;
+
+enum class ObjectiveKind {
+  Sharpe,
+  TotalReturn,
+  Calmar, // total return / max drawdown
+};
+
+Objective make_objective(ObjectiveKind kind);
+
+// Suggests points in the unit cube [0, 1]^dims and learns from their
+// scores. Implementations are deterministic given their seed and the
+// sequence of ask/tell calls.
+class Optimizer {
+public:
+  virtual ~Optimizer() = default;
+
+  virtual std::vector<std::vector<double>> ask(size_t n) = 0;
+  virtual void tell(std::span<const std::vector<double>> points,
+                    std::span<const double> scores) = 0;
+};
+
+enum class OptimizerKind {
+  Random,
+  Sobol,
+  CmaEs, // (mu/mu_w, lambda)-CMA-ES with lambda = batch size
+  Tpe,   // tree-structured Parzen estimator
+};
+
+std::unique_ptr<Optimizer> make_optimizer(OptimizerKind kind, size_t dims,
+                                          size_t batch_size, uint64_t seed);
+
+// Sobol low-discrepancy sequence (Joe-Kuo direction numbers), starting
+// after the all-zero point.
+class SobolSequence {
+public:
+  static constexpr size_t kMaxDims = 21;
+
+  explicit SobolSequence(size_t dims);
+
+  std::vector<double> next();
+
+private:
+  size_t dims_;
+  uint32_t index_ = 0;
+  std::vector<uint32_t> state_;
+  std::vector<std::array<uint32_t, 32>> directions_;
+};
+
+struct OptimizeConfig {
+  OptimizerKind kind = OptimizerKind::CmaEs;
+  size_t budget = 100; // total backtests
+
+  // Suggestions per round. Fixed rather than tied to the thread count so
+  // results do not depend on how many cores the machine has.
+  size_t batch_size = 8;
+
+  SweepConfig sweep; // threads and seed
+};
+
+struct Trial {
+  ParamSet params;
+  RunSummary summary;
+  double score;
+};
+
+struct OptimizeResult {
+  std::vector<Trial> trials; // In evaluation order
+  size_t best_index = 0;     // Lowest index wins ties
+};
+
+// Runs batches of suggested parameter sets on the thread pool and feeds the
+// scores back. Evaluation i uses RNG stream i, as in run_sweep, so results
+// are identical for any thread count on one platform; the optimizers use
+// libm, so other platforms can differ in the last bits.
+OptimizeResult optimize(const std::vector<ParamBound> &bounds, const RunFn &run,
+                        const Objective &objective,
+                        const OptimizeConfig &config);
+
+} // namespace ctrade
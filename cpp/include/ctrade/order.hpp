@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <vector>
 
 namespace ctrade {
 
@@ -8,11 +9,26 @@ enum class OrderType { Market, Limit, Stop, StopLimit };
 
 struct Order {
   int64_t id;
+  int asset_id;
+  int venue_id;
   Side side;
   OrderType type;
-  double price;
+  double price;      // Limit price (Limit, StopLimit)
+  double stop_price; // Trigger price (Stop, StopLimit)
   double size;
   int64_t timestamp;
 };
 
+// Prices at which resting orders act, by the direction the market has to
+// move to reach them.
+struct TriggerLevels {
+  std::vector<double> falling; // buy limits, sell stops: act at or below
+  std::vector<double> rising;  // sell limits, buy stops: act at or above
+
+  void clear() {
+    falling.clear();
+    rising.clear();
+  }
+};
+
 } // namespace ctrade
@@ -0,0 +1,90 @@
+#pragma once
+#include "fill.hpp"
+#include "order.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ctrade {
+
+// Our resting orders, grouped into price levels per side with FIFO time
+// priority inside each level. Orders live in a slot pool and are linked
+// into their level by index, so an amend relinks the order without copying
+// it or touching the pool.
+//
+// Limits rest at their limit price. Stops and stop-limits wait on their
+// trigger price in separate per-side trigger maps, outside the visible
+// book, so they never show up as bids or asks or queue ahead of a limit.
+// Amends follow the usual exchange rules: reducing size keeps queue
+// priority (O(1)); increasing size sends the order to the back of its
+// level (O(1)); changing price moves it to the back of the new level
+// (O(log levels)).
+class OrderBook {
+public:
+  explicit OrderBook(size_t capacity = 0);
+
+  void add(const Order &order);
+  bool cancel(int64_t order_id);
+  void clear();
+
+  // Changes size and working price in place. A size of zero or less
+  // cancels. Returns false if the order is not resting.
+  bool amend(int64_t order_id, double new_size, double new_price);
+
+  // Reduces each filled order by its fill size and removes it once filled.
+  void apply_fills(std::span<const Fill> fills);
+
+  const Order *find(int64_t order_id) const;
+  size_t size() const { return index_.size(); }
+  bool empty() const { return index_.empty(); }
+
+  // Size resting ahead of the order at its level; 0 for untriggered stops,
+  // which are not queued.
+  double queue_ahead(int64_t order_id) const;
+
+  // Resting limits in priority order: bids from the highest price, then
+  // asks from the lowest, FIFO within each level.
+  std::vector<Order> resting() const;
+
+  // Untriggered stops and stop-limits, nearest trigger first: buy stops
+  // from the lowest trigger, then sell stops from the highest.
+  std::vector<Order> stops() const;
+
+private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Slot {
+    Order order;
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+  };
+
+  struct Level {
+    uint32_t head = kNone;
+    uint32_t tail = kNone;
+  };
+
+  using Levels = std::map<double, Level>;
+
+  static bool is_trigger(const Order &order);
+  static double working_price(const Order &order);
+  Levels &levels_for(const Order &order);
+
+  void append(const Level &level, std::vector<Order> &out) const;
+  void link_back(uint32_t slot);
+  void unlink(uint32_t slot);
+  void release(uint32_t slot);
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  std::unordered_map<int64_t, uint32_t> index_;
+  Levels bids_;
+  Levels asks_;
+  Levels buy_stops_; // by trigger price
+  Levels sell_stops_;
+};
+
+} // namespace ctrade
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace ctrade {
+
+// 0 means one thread per hardware core.
+unsigned resolve_threads(unsigned threads);
+
+// Calls fn(index, worker) for every index in [0, n) on up to `threads`
+// workers. Indices are handed out dynamically, so callers that need
+// reproducible output must key results by index, not by worker. The first
+// exception thrown by fn is rethrown after all workers have joined.
+void parallel_for(size_t n, unsigned threads,
+                  const std::function<void(size_t, unsigned)> &fn);
+
+} // namespace ctrade
@@ -0,0 +1,36 @@
+#pragma once
+#include "order.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace ctrade {
+
+enum class ParentAlgo {
+  TWAP,    // equal slices over [start_ts, end_ts)
+  VWAP,    // slices weighted by a historical volume profile
+  POV,     // a fixed fraction of each bar's traded volume
+  Iceberg, // one visible child of display_size at a time
+};
+
+// An order the engine works on its own schedule by sending child orders.
+// Children are market orders, or limit orders at limit_price if it is set,
+// routed to the parent's asset and venue.
+struct ParentOrder {
+  ParentAlgo algo = ParentAlgo::TWAP;
+  int asset_id = 0;
+  int venue_id = 0;
+  Side side = Side::Buy;
+  double size = 0.0;
+  double limit_price = 0.0; // 0 = market children; required for Iceberg
+
+  // Schedule window; end_ts = 0 leaves POV and Iceberg open-ended.
+  int64_t start_ts = 0;
+  int64_t end_ts = 0;
+
+  int slices = 1;                     // TWAP, VWAP
+  std::vector<double> volume_profile; // VWAP: relative volume per slice
+  double participation = 0.0;         // POV: fraction of bar volume
+  double display_size = 0.0;          // Iceberg
+};
+
+} // namespace ctrade
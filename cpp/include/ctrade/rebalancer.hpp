@@ -0,0 +1,27 @@
+#pragma once
+#include "order.hpp"
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// Exchange trading rules for one asset.
+struct InstrumentSpec {
+  double lot_size;     // Order sizes are multiples of this (0 = continuous)
+  double min_notional; // Smallest size * price the exchange accepts
+};
+
+// Converts weights (fraction of equity per asset_id) into target positions.
+std::vector<double> weights_to_positions(std::span<const double> weights,
+                                         std::span<const double> prices,
+                                         double equity);
+
+// Diffs target vs current position per asset_id and emits at most one market
+// order per asset. Sizes are rounded toward zero to the lot size; changes
+// below min_notional are dropped unless they flatten the position.
+std::vector<Order> rebalance_orders(std::span<const double> current,
+                                    std::span<const double> target,
+                                    std::span<const double> prices,
+                                    std::span<const InstrumentSpec> specs);
+
+} // namespace ctrade
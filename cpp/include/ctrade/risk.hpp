@@ -0,0 +1,70 @@
+#pragma once
+#include "asset_slice.hpp"
+#include "snapshot.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace ctrade {
+
+// Exponentially weighted covariance of asset returns, updated in place each
+// bar: C <- lambda * C + (1 - lambda) * r r^T. Returns are assumed zero-mean
+// (RiskMetrics). Each update is one O(n^2) rank-1 pass over a contiguous
+// row-major matrix, written so the compiler can vectorize the inner loop.
+class EwmaCovariance {
+public:
+  EwmaCovariance(size_t n_assets, double lambda);
+
+  // One bar of returns, one per asset.
+  void update(std::span<const double> returns);
+
+  // Log returns from the slice's closes against the previous slice. Assets
+  // without a price on either side contribute a zero return; a slice with
+  // no returns at all is not counted.
+  void update(const AssetSlice &slice);
+
+  size_t size() const { return n_; }
+  size_t observations() const { return observations_; }
+
+  // Bias-corrected for the short history of the first few updates.
+  double covariance(size_t i, size_t j) const;
+  std::vector<double> matrix() const;
+
+  // Per-bar variance and volatility of a portfolio with weights `w`.
+  double variance(std::span<const double> w) const;
+  double volatility(std::span<const double> w) const;
+
+  // One-bar parametric (normal) value at risk as a positive fraction of
+  // portfolio value, e.g. confidence = 0.99.
+  double value_at_risk(std::span<const double> w, double confidence) const;
+
+  // Long-only weights summing to 1 with equal risk contributions, by
+  // cyclical coordinate descent at O(n^2) per sweep. Warm-starts from the
+  // previous solution, so consecutive bars usually converge in a few
+  // sweeps. Falls back to equal weights until every variance is positive.
+  std::span<const double> risk_parity_weights(size_t max_sweeps = 100,
+                                              double tolerance = 1e-10);
+
+  // Full state, for continuing a backtest from a snapshot. load() requires
+  // the same number of assets and lambda.
+  void save(SnapshotWriter &out) const;
+  void load(SnapshotReader &in);
+
+private:
+  size_t n_;
+  double lambda_;
+  double weight_ = 0.0; // sum of applied weights, for bias correction
+  size_t observations_ = 0;
+
+  std::vector<double> cov_; // row-major n x n, not bias-corrected
+  std::vector<double> last_close_;
+  std::vector<double> returns_;
+
+  std::vector<double> parity_;
+  std::vector<double> cov_parity_; // cov_ * parity_
+};
+
+// Inverse of the standard normal CDF.
+double normal_quantile(double p);
+
+} // namespace ctrade
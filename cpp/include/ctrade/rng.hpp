@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace ctrade {
+
+// Counter-based Philox4x32-10 generator. Output depends only on
+// (seed, stream, position), so each run owns an independent, reproducible
+// stream no matter which thread executes it.
+//
+// Satisfies UniformRandomBitGenerator; prefer uniform()/normal() over
+// <random> distributions, whose output differs between standard libraries.
+//
+// The integer outputs and uniform() are bit-exact on every platform.
+// normal() goes through std::log and std::cos, whose last bits may differ
+// between libm implementations, so normal draws (and results built on
+// them) reproduce exactly only on the same platform and C library.
+class CounterRng {
+public:
+  using result_type = uint32_t;
+
+  CounterRng(uint64_t seed, uint64_t stream);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() { return next_u32(); }
+
+  uint32_t next_u32();
+  uint64_t next_u64();
+
+  // Uniform in [0, 1) with 53 random bits.
+  double uniform();
+
+  // Standard normal (Box-Muller); bit-exact per platform, see above.
+  double normal();
+
+private:
+  void refill();
+
+  std::array<uint32_t, 2> key_;
+  std::array<uint32_t, 4> counter_;
+  std::array<uint32_t, 4> block_{};
+  unsigned index_ = 4;
+};
+
+} // namespace ctrade
@@ -0,0 +1,171 @@
+#pragma once
+#include "bar_store.hpp"
+#include "market_state.hpp"
+#include "strategy.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctrade {
+
+// Rule-based strategies written as expressions, one rule per line or ';':
+//
+//   cross(ema(close, 12), ema(close, 26)) & (funding < 0.0001) -> target(1)
+//   cross_under(ema(close, 12), ema(close, 26)) -> target(0)
+//
+// On every bar the first rule whose condition holds sets the target weight;
+// if none holds (or its target is NaN) the previous target is kept,
+// starting from 0.
+//
+// Series are open, high, low, close, volume and funding (or funding_rate)
+// and numbers, combined with + - * /, < <= > >= == != and & | !, where a
+// value is true if it is neither 0 nor NaN. Functions: abs(x), min(x, y),
+// max(x, y), cross(x, y), cross_under(x, y), and over a window of n bars
+// (an integer literal) lag(x, n), sma(x, n), ema(x, n), highest(x, n) and
+// lowest(x, n). Windows are NaN until they have seen n bars; ema starts at
+// its first non-NaN input. '#' starts a comment.
+
+// --- Compiled program ---
+
+enum class RuleOp : uint8_t {
+  Column, // value is the column: open, high, low, close, volume, funding
+  Const,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Lt,
+  Le,
+  Gt,
+  Ge,
+  Eq,
+  Ne,
+  And,
+  Or,
+  Not,
+  Neg,
+  Abs,
+  Min,
+  Max,
+  Cross,
+  CrossUnder,
+  Lag, // value is the window for Lag .. Lowest
+  Sma,
+  Ema,
+  Highest,
+  Lowest,
+};
+
+struct RuleNode {
+  RuleOp op;
+  int32_t a = -1; // operands, always earlier nodes
+  int32_t b = -1;
+  double value = 0.0;
+};
+
+struct Rule {
+  int32_t condition;
+  int32_t target;
+};
+
+// Expression DAG in evaluation order. Identical subexpressions are shared,
+// so an ema used by several rules is computed once.
+class RuleProgram {
+public:
+  const std::vector<RuleNode> &nodes() const { return nodes_; }
+  const std::vector<Rule> &rules() const { return rules_; }
+
+private:
+  friend RuleProgram compile_rules(const std::string &source);
+
+  std::vector<RuleNode> nodes_;
+  std::vector<Rule> rules_;
+};
+
+// Throws std::invalid_argument naming the line and column of the first
+// error.
+RuleProgram compile_rules(const std::string &source);
+
+// --- Evaluation ---
+
+// Running state of one program over one bar series. Bars are pushed in
+// blocks and each node is evaluated over the whole block before the next,
+// in tight loops over contiguous buffers that the compiler vectorizes for
+// the elementwise ops. Window state carries over between blocks, so the
+// targets do not depend on how the series is split; step() is a block of
+// one bar.
+class RuleEvaluator {
+public:
+  // Buffers hold `block` bars per node; an evaluator that only step()s
+  // needs 1.
+  explicit RuleEvaluator(RuleProgram program, size_t block = kBlock);
+
+  // Targets for bars [begin, end) of `bars`, which continue the bars
+  // already pushed.
+  void run(const BarStore &bars, size_t begin, size_t end,
+           std::span<double> targets);
+
+  double step(const MarketState &bar);
+
+  double target() const { return target_; }
+
+private:
+  static constexpr size_t kBlock = 1024;
+
+  struct Window {
+    std::vector<double> ring;
+    size_t pos = 0;
+    size_t missing = 0; // NaN or not yet seen values in ring
+    double sum = 0.0;
+    std::deque<std::pair<uint64_t, double>> extrema; // highest / lowest
+    uint64_t seen = 0;
+    double prev_a; // ema value, or the last operands of a cross
+    double prev_b;
+  };
+
+  void eval(const double *const *columns, size_t n, double *targets);
+
+  RuleProgram program_;
+  size_t block_;
+  std::vector<double> buffers_;      // block_ values per node
+  std::vector<const double *> out_;  // per node
+  std::vector<Window> windows_;      // per node
+  double target_ = 0.0;
+};
+
+// Targets for every bar.
+std::vector<double> evaluate_rules(const RuleProgram &program,
+                                   const BarStore &bars);
+
+// One target series per store, stores evaluated in parallel.
+std::vector<std::vector<double>>
+evaluate_rules(const RuleProgram &program,
+               std::span<const BarStore *const> stores, unsigned threads = 0);
+
+// --- Strategy ---
+
+// Trades a program on every asset of a universe of `n_assets`: each bar
+// advances its asset's evaluator, and a changed target is sent as
+// set_target_weights over all n_assets. Bars for an asset_id outside
+// [0, n_assets) throw std::out_of_range.
+class RuleStrategy : public Strategy {
+public:
+  RuleStrategy(RuleProgram program, size_t n_assets);
+
+  void init() override;
+  void on_bar(const MarketState &market, ExecutionContext &ctx) override;
+
+  std::span<const double> weights() const { return weights_; }
+
+private:
+  RuleProgram program_;
+  size_t n_assets_;
+  std::vector<RuleEvaluator> evaluators_; // by asset_id, one-bar blocks
+  std::vector<double> weights_;
+};
+
+} // namespace ctrade
@@ -0,0 +1,112 @@
+#pragma once
+#include "backtest_result.hpp"
+#include "sweep.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ctrade {
+
+// --- Serialization ---
+
+// Little-endian byte stream for engine and strategy state.
+class SnapshotWriter {
+public:
+  void u64(uint64_t v);
+  void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+  void f64(double v);
+  void str(const std::string &s);
+  void f64s(std::span<const double> values);
+  void i64s(std::span<const int64_t> values);
+  void blob(std::span<const uint8_t> data);
+
+  const std::vector<uint8_t> &bytes() const { return bytes_; }
+
+private:
+  std::vector<uint8_t> bytes_;
+};
+
+// Reads what a SnapshotWriter wrote, in the same order. Throws
+// std::runtime_error on truncated input.
+class SnapshotReader {
+public:
+  explicit SnapshotReader(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+  uint64_t u64();
+  int64_t i64() { return static_cast<int64_t>(u64()); }
+  double f64();
+  std::string str();
+  std::vector<double> f64s();
+  std::vector<int64_t> i64s();
+  std::vector<uint8_t> blob();
+
+  bool done() const { return pos_ == bytes_.size(); }
+
+private:
+  void need(size_t n) const;
+
+  std::span<const uint8_t> bytes_;
+  size_t pos_ = 0;
+};
+
+// --- Continuation ---
+
+// A backtest that can stop at any timestamp and carry on later from saved
+// state. run() must produce the same rows whether a range is simulated in
+// one call or split across calls with save()/load() in between.
+class ResumableBacktest {
+public:
+  virtual ~ResumableBacktest() = default;
+
+  // Simulates bars with begin_ts <= timestamp < end_ts, appending one row
+  // per bar to `result`.
+  virtual void run(int64_t begin_ts, int64_t end_ts,
+                   BacktestResult &result) = 0;
+
+  // Returns to the state before the first bar.
+  virtual void reset() = 0;
+
+  virtual void save(SnapshotWriter &out) const = 0;
+  virtual void load(SnapshotReader &in) = 0;
+};
+
+// A snapshot is only reused when all three match. Bump data_version when
+// history is revised, not when bars are appended.
+struct SnapshotKey {
+  std::string strategy;
+  ParamSet params;
+  std::string data_version;
+};
+
+uint64_t snapshot_id(const SnapshotKey &key);
+
+// One file per key in `directory`, holding the result so far, the end_ts it
+// reaches and the backtest's state there. Files are replaced atomically;
+// an unreadable file is treated as missing.
+class SnapshotStore {
+public:
+  explicit SnapshotStore(std::string directory);
+
+  // Returns the result over [start_ts, end_ts). With a snapshot that also
+  // starts at start_ts, loads its state and simulates only the bars from
+  // its end to end_ts; otherwise, or if the state fails to load, resets the
+  // backtest and runs from start_ts. Saves the new end state. Requests
+  // ending at or before the snapshot are served from it without
+  // simulating.
+  BacktestResult extend(const SnapshotKey &key, ResumableBacktest &backtest,
+                        int64_t start_ts, int64_t end_ts);
+
+  // Where the stored snapshot ends; INT64_MIN if there is none.
+  int64_t end_ts(const SnapshotKey &key) const;
+
+  void erase(const SnapshotKey &key);
+
+private:
+  std::string path(const SnapshotKey &key) const;
+
+  std::string directory_;
+};
+
+} // namespace ctrade
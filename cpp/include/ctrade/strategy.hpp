@@ -1,14 +1,45 @@
 #pragma once
+#include "asset_slice.hpp"
+#include "event.hpp"
 #include "execution_context.hpp"
 #include "market_state.hpp"
 
 namespace ctrade {
 
+enum class WakeMode {
+  EveryBar,
+  // on_bar only for bars that touch a resting order or stop level, or that
+  // follow a timer. Lets the driver jump over quiet stretches of bars.
+  TriggersOnly,
+};
+
+struct WakePolicy {
+  WakeMode mode = WakeMode::EveryBar;
+  int64_t timer_period = 0; // > 0: periodic on_timer every timer_period
+  // false: when the driver builds slices, skip on_bar and deliver only
+  // on_slice, one call per timestamp instead of one per asset bar.
+  bool bar_callbacks = true;
+};
+
 struct Strategy {
   virtual void init() = 0;
 
+  // Queried once when the driver is built.
+  virtual WakePolicy wake_policy() const { return {}; }
+
   virtual void on_bar(const MarketState &market, ExecutionContext &ctx) = 0;
 
+  // Called once per timestamp with every asset's bar. Default: no-op.
+  virtual void on_slice(const AssetSlice &, ExecutionContext &) {}
+
+  // --- Event callbacks (default: no-op) ---
+  // on_fill sees every partial fill of this strategy's orders.
+  virtual void on_fill(const Fill &, ExecutionContext &) {}
+  virtual void on_tick(const Tick &, ExecutionContext &) {}
+  virtual void on_timer(const TimerEvent &, ExecutionContext &) {}
+  virtual void on_funding(const FundingEvent &, ExecutionContext &) {}
+  virtual void on_liquidation(const LiquidationEvent &, ExecutionContext &) {}
+
   virtual ~Strategy() = default;
 };
 
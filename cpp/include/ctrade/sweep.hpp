@@ -0,0 +1,55 @@
+#pragma once
+#include "backtest_result.hpp"
+#include "config.hpp"
+#include "rng.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ctrade {
+
+using ParamSet = std::vector<double>;
+
+// Per-run statistics, computed in a single sequential pass.
+struct RunSummary {
+  double final_equity;
+  double total_return;
+  double max_drawdown; // Largest peak-to-trough loss as a fraction of peak
+  double sharpe;       // Mean / stdev of per-bar returns, not annualized
+  int64_t n_bars;
+};
+
+RunSummary summarize(const BacktestResult &result);
+
+// Aggregates over all runs of a sweep.
+struct SweepStats {
+  size_t n_runs = 0;
+  double mean_return = 0.0;
+  double mean_sharpe = 0.0;
+  double best_sharpe = 0.0;
+  size_t best_index = 0; // Lowest index wins ties
+  double worst_drawdown = 0.0;
+
+  void add(size_t index, const RunSummary &run);
+};
+
+struct SweepResult {
+  std::vector<RunSummary> runs; // In input order
+  SweepStats stats;
+};
+
+// One backtest for one parameter set, drawing randomness only from `rng`.
+using RunFn = std::function<BacktestResult(const ParamSet &, CounterRng &)>;
+
+// Runs every parameter set on a thread pool. In deterministic mode run i
+// uses RNG stream i and statistics are reduced in input order, so the result
+// is bit-identical for any thread count on one platform (across platforms,
+// see CounterRng on libm). Otherwise each worker owns one
+// stream and statistics are merged as runs complete.
+SweepResult run_sweep(const std::vector<ParamSet> &params, const RunFn &run,
+                      const SweepConfig &config);
+
+uint64_t hash_summaries(const std::vector<RunSummary> &runs);
+
+} // namespace ctrade
@@ -0,0 +1,63 @@
+#pragma once
+#include "sweep.hpp"
+#include "sweep_journal.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ctrade {
+
+// Scale-out sweeps: a coordinator hands parameter sets to worker processes
+// over a stream socket and reduces their summaries. Endpoints are
+// "unix:/path/to.sock" or "tcp:host:port"; port 0 binds an ephemeral port.
+//
+// Workers pull one job at a time, so faster workers naturally take more.
+// Once the queue is empty, idle workers are given duplicates of jobs still
+// in flight and the first result wins, so a straggler cannot hold up the
+// sweep. A worker that disconnects, reports a failed run or sends a
+// malformed message is dropped and its job requeued. Job i always runs on
+// RNG stream i and statistics are reduced in input order, so the result
+// equals run_sweep in deterministic mode.
+//
+// The wire format is little-endian and versioned by the handshake; every
+// process must run the same build on the same platform, since runs that
+// draw normals or call libm can differ in the last bits elsewhere.
+struct ClusterConfig {
+  unsigned max_retries = 3; // per job, counting dropped workers
+  int idle_timeout_ms = 0;  // fail after this long without a result; 0 = never
+};
+
+class SweepCoordinator {
+public:
+  // Binds and listens immediately, so workers may connect before run(). A
+  // stale socket at a unix path is replaced; any other file there is left
+  // alone and binding fails.
+  explicit SweepCoordinator(const std::string &endpoint,
+                            ClusterConfig config = {});
+  ~SweepCoordinator();
+
+  SweepCoordinator(const SweepCoordinator &) = delete;
+  SweepCoordinator &operator=(const SweepCoordinator &) = delete;
+
+  // The bound endpoint, with the actual port for "tcp:host:0".
+  const std::string &endpoint() const { return endpoint_; }
+
+  // Blocks until every job has a result, then tells workers to exit. Jobs
+  // already in `journal` are not sent out; new results are appended.
+  SweepResult run(const std::vector<ParamSet> &params, uint64_t seed,
+                  SweepJournal *journal = nullptr);
+
+private:
+  ClusterConfig config_;
+  std::string endpoint_;
+  std::string unix_path_; // unlinked on destruction
+  int listen_fd_ = -1;
+};
+
+// Connects `threads` job loops to a coordinator and runs jobs until told to
+// stop or the coordinator goes away. Retries the initial connection for up
+// to connect_timeout_ms.
+void run_sweep_worker(const std::string &endpoint, const RunFn &run,
+                      unsigned threads = 1, int connect_timeout_ms = 10000);
+
+} // namespace ctrade
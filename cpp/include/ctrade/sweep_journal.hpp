@@ -0,0 +1,58 @@
+#pragma once
+#include "config.hpp"
+#include "sweep.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ctrade {
+
+// Key of one run within a sweep: its parameter bits, the sweep seed and its
+// index (which selects the RNG stream); any change re-runs it. The key does
+// not cover the strategy or the data, which the journal's sweep id does.
+uint64_t run_key(const ParamSet &params, uint64_t seed, size_t index);
+
+// Append-only file of completed runs, one fixed-size checksummed record per
+// run. Each record is a single write(2), so it survives the process being
+// killed; pass durable = true to also fdatasync each record against power
+// loss. A torn or corrupt tail left by a crash is truncated on open.
+//
+// `sweep_id` names what the runs depend on beyond their keys, such as the
+// strategy and the data version. It is stored in the header, and reopening
+// the journal with a different id throws std::invalid_argument rather than
+// returning another sweep's results.
+class SweepJournal {
+public:
+  SweepJournal(const std::string &path, const std::string &sweep_id,
+               bool durable = false);
+  ~SweepJournal();
+
+  SweepJournal(const SweepJournal &) = delete;
+  SweepJournal &operator=(const SweepJournal &) = delete;
+
+  std::optional<RunSummary> find(uint64_t key) const;
+
+  // Thread-safe.
+  void append(uint64_t key, const RunSummary &summary);
+
+  size_t size() const;
+
+private:
+  mutable std::mutex mutex_;
+  int fd_ = -1;
+  bool durable_;
+  std::unordered_map<uint64_t, RunSummary> done_;
+};
+
+// Deterministic run_sweep that skips runs already in the journal and
+// records each new run as soon as it finishes. Restarting an interrupted
+// sweep with the same journal re-runs only what had not completed, and the
+// result is bit-identical to an uninterrupted sweep.
+SweepResult run_sweep(const std::vector<ParamSet> &params, const RunFn &run,
+                      const SweepConfig &config, SweepJournal &journal);
+
+} // namespace ctrade
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+namespace ctrade {
+
+// One aggregated trade (Binance aggTrades).
+struct Tick {
+  int asset_id;
+  int venue_id;
+  int64_t timestamp;
+
+  double price;
+  double size;
+  bool is_buyer_maker;
+};
+
+} // namespace ctrade
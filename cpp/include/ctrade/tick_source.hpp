@@ -0,0 +1,51 @@
+#pragma once
+#include "tick.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ctrade {
+
+// Trades for one asset in [from_ts, to_ts), in time order.
+struct TickSource {
+  virtual std::vector<Tick> load(int asset_id, int64_t from_ts,
+                                 int64_t to_ts) = 0;
+  virtual ~TickSource() = default;
+};
+
+// Keeps the most recently loaded windows of an underlying TickSource, so
+// orders resting across consecutive bars load each minute only once.
+class TickCache {
+public:
+  TickCache(TickSource &source, size_t capacity);
+
+  // Valid until the next call.
+  std::span<const Tick> get(int asset_id, int64_t from_ts, int64_t to_ts);
+
+  size_t loads() const { return loads_; }
+
+private:
+  struct Key {
+    int asset_id;
+    int64_t from_ts;
+    int64_t to_ts;
+    bool operator==(const Key &) const = default;
+  };
+  struct KeyHash {
+    size_t operator()(const Key &k) const;
+  };
+  using Entry = std::pair<Key, std::vector<Tick>>;
+
+  TickSource &source_;
+  size_t capacity_;
+  size_t loads_ = 0;
+
+  std::list<Entry> lru_; // Most recent first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+};
+
+} // namespace ctrade
@@ -0,0 +1,49 @@
+#pragma once
+#include "backtest_result.hpp"
+#include "snapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ctrade {
+
+// Time-parallel backtesting: one long run split into segments that are
+// simulated concurrently, each from a fresh backtest warmed up on the bars
+// just before its start. Segments are then checked in order: when the
+// state one segment ends in equals the state the next one assumed, the
+// speculative rows are kept; otherwise the next segment is rerun from the
+// true state. The result is bit-identical to a single-segment run.
+//
+// States are compared through save(), byte for byte, so save() should hold
+// what decides future trading and nothing else. Strategies that go flat on
+// a schedule (align boundaries to it) or forget their history within the
+// warm-up match and scale with cores; others fall back to serial reruns.
+//
+// Segments contribute timestamps and pnl. Equity is rebuilt as
+// initial_equity plus the running pnl, and drawdown as the fraction below
+// the running peak, so a segment need not know the equity it starts from.
+struct TimeParallelConfig {
+  unsigned threads = 0;   // 0 = one per core
+  size_t segments = 0;    // 0 = one per thread
+  int64_t align = 1;      // boundaries fall on start_ts + k * align
+  int64_t warmup = 0;     // time simulated before each boundary, discarded
+  double initial_equity = 10000.0;
+};
+
+struct TimeParallelResult {
+  BacktestResult result;
+  std::vector<int64_t> boundaries; // segment k covers [b[k], b[k + 1])
+  size_t reruns = 0;               // segments whose speculation failed
+};
+
+using BacktestFactory = std::function<std::unique_ptr<ResumableBacktest>()>;
+
+// Simulates [start_ts, end_ts). `make` must return backtests in the same
+// initial state on every call and is called from worker threads.
+TimeParallelResult run_time_parallel(const BacktestFactory &make,
+                                     int64_t start_ts, int64_t end_ts,
+                                     const TimeParallelConfig &config = {});
+
+} // namespace ctrade
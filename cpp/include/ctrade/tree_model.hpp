@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ctrade {
+
+// --- Model description ---
+
+// One split: rows with x <= threshold go left. Children >= 0 are nodes of
+// the same tree; a negative child c is leaf ~c.
+struct TreeNode {
+  int feature;
+  double threshold;
+  int left;
+  int right;
+  bool default_left;  // direction for missing values
+  bool nan_missing;   // NaN is missing; otherwise NaN is read as 0
+  bool zero_missing;  // 0 is missing as well
+};
+
+// Node 0 is the root; a tree without nodes is the single leaf 0.
+struct Tree {
+  std::vector<TreeNode> nodes;
+  std::vector<double> leaves;
+};
+
+enum class TreeOutput {
+  Raw,     // sum of leaves plus base score
+  Sigmoid, // 1 / (1 + exp(-scale * raw)), for binary classifiers
+};
+
+// --- Inference ---
+
+// Gradient-boosted tree ensemble flattened into contiguous arrays, so a
+// prediction walks a few cache lines, takes splits without branching on
+// the data and allocates nothing. Batches are evaluated tree by tree with
+// a block of rows descending in lockstep: their independent chains of
+// loads overlap, and each tree stays hot in cache across the block. Every
+// row sums its trees in model order, so batch and single-row predictions
+// match bit for bit.
+class TreeEnsemble {
+public:
+  TreeEnsemble(const std::vector<Tree> &trees, double base_score = 0.0,
+               TreeOutput output = TreeOutput::Raw, double sigmoid_scale = 1.0);
+
+  size_t n_trees() const { return roots_.size(); }
+  size_t n_features() const { return n_features_; }
+
+  // `row` holds at least n_features() values; NaN marks a missing value.
+  double predict(std::span<const double> row) const;
+
+  // Row-major `rows`, one prediction per row into `out`.
+  void predict(std::span<const double> rows, std::span<double> out) const;
+
+private:
+  // 24 bytes, so taking a split is one load from one cache line.
+  struct Split {
+    double threshold;
+    int32_t feature;
+    int32_t child[2];  // [x <= threshold, otherwise]; ~leaf if negative
+    uint8_t nan_child; // child taken for NaN
+    bool zero_missing; // 0 takes nan_child too
+  };
+
+  int32_t step(const Split &split, double x) const;
+  double finish(double raw) const;
+
+  std::vector<int32_t> roots_;
+  std::vector<int32_t> depth_; // splits on the longest path, per tree
+  std::vector<Split> splits_;
+  std::vector<double> leaves_;
+  size_t n_features_ = 0;
+  bool zero_missing_ = false; // any split has zero_missing
+  double base_score_;
+  TreeOutput output_;
+  double sigmoid_scale_;
+};
+
+// Parses a LightGBM text model (Booster.save_model). Supports regression
+// and binary objectives with numerical splits; leaf values already include
+// shrinkage.
+TreeEnsemble parse_lightgbm_model(const std::string &text);
+
+// Parses an XGBoost text dump (Booster.get_dump, with or without stats)
+// whose features are named f0, f1, .... The dump omits the base score and
+// objective, so pass them here; base_score is on the margin scale.
+// Splits follow XGBoost's float32 comparison, so every double feature takes
+// the branch it would after XGBoost rounds it to float.
+TreeEnsemble parse_xgboost_dump(const std::string &text,
+                                double base_score = 0.0,
+                                TreeOutput output = TreeOutput::Raw);
+
+} // namespace ctrade
@@ -0,0 +1,95 @@
+#pragma once
+#include "config.hpp"
+#include "event.hpp"
+#include "execution_engine.hpp"
+#include "fill.hpp"
+#include "market_state.hpp"
+#include "order.hpp"
+#include "order_book.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ctrade {
+
+enum class VenueKind {
+  Spot,     // cash and inventory, no borrowing
+  UsdtPerp, // USDT-margined perpetual futures
+};
+
+struct VenueSpec {
+  std::string name;
+  VenueKind kind = VenueKind::Spot;
+  FeeSchedule fees{0.0, 0.0};
+  double initial_balance = 0.0; // USDT
+
+  // Perps only.
+  double leverage = 1.0;
+  double maintenance_margin = 0.005; // fraction of notional
+};
+
+// Balances, positions and resting orders of every (venue, asset) pair in
+// one run. Each venue has its own account; per-pair state lives in dense
+// arrays indexed by venue_id * n_assets + asset_id.
+class VenueAccounts {
+public:
+  VenueAccounts(std::vector<VenueSpec> venues, size_t n_assets);
+
+  size_t n_venues() const { return venues_.size(); }
+  size_t n_assets() const { return n_assets_; }
+  size_t index(int venue_id, int asset_id) const;
+  const VenueSpec &venue(int venue_id) const;
+
+  // Pre-trade check at `price`. Spot buys need cash and spot sells need
+  // inventory; perps need free margin for any added exposure.
+  bool can_fill(const Order &order, double price) const;
+
+  // Spot fills settle cash and inventory. Perp fills move a signed position
+  // with an average entry price and realize PnL when it is reduced.
+  void apply_fill(const Fill &fill, Side side);
+
+  // Updates the mark used for equity and margin (mark_price, else close).
+  void mark(const MarketState &market);
+
+  // Perps only: longs pay rate * notional at the event's mark price.
+  void apply_funding(const FundingEvent &event);
+
+  double balance(int venue_id) const { return balance_.at(venue_id); }
+  double position(int venue_id, int asset_id) const;
+  double entry_price(int venue_id, int asset_id) const;
+
+  double equity(int venue_id) const;
+  double total_equity() const;
+  double initial_margin(int venue_id) const;
+  double maintenance_margin(int venue_id) const;
+  double free_margin(int venue_id) const;
+
+  OrderBook &book(int venue_id, int asset_id);
+
+private:
+  std::vector<VenueSpec> venues_;
+  size_t n_assets_;
+
+  std::vector<double> balance_; // per venue
+  std::vector<double> position_;
+  std::vector<double> entry_;
+  std::vector<double> mark_;
+  std::vector<OrderBook> books_;
+};
+
+// Sends each bar's orders for that (venue, asset) to the venue's engine, so
+// venues keep separate fee schedules and fill models. Fills are stamped
+// with the venue.
+class MultiVenueExecutionEngine : public ExecutionEngine {
+public:
+  explicit MultiVenueExecutionEngine(std::vector<ExecutionEngine *> venues);
+
+  std::vector<Fill> execute(const std::vector<Order> &orders,
+                            const MarketState &market) override;
+
+private:
+  std::vector<ExecutionEngine *> venues_;
+  std::vector<Order> routed_;
+};
+
+} // namespace ctrade
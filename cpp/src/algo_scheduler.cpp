@@ -0,0 +1,261 @@
+#include "ctrade/algo_scheduler.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Residual sizes below this fraction of the parent are treated as zero.
+constexpr double kSizeTolerance = 1e-9;
+
+void validate(const ParentOrder &parent) {
+  if (parent.size <= 0.0) {
+    throw std::invalid_argument("ParentOrder: size must be positive");
+  }
+  switch (parent.algo) {
+  case ParentAlgo::TWAP:
+  case ParentAlgo::VWAP:
+    if (parent.slices < 1 || parent.end_ts <= parent.start_ts) {
+      throw std::invalid_argument("ParentOrder: empty schedule");
+    }
+    if (parent.algo == ParentAlgo::VWAP &&
+        parent.volume_profile.size() != static_cast<size_t>(parent.slices)) {
+      throw std::invalid_argument("ParentOrder: profile size != slices");
+    }
+    break;
+  case ParentAlgo::POV:
+    if (parent.participation <= 0.0 || parent.participation > 1.0) {
+      throw std::invalid_argument("ParentOrder: participation not in (0, 1]");
+    }
+    break;
+  case ParentAlgo::Iceberg:
+    if (parent.limit_price <= 0.0 || parent.display_size <= 0.0) {
+      throw std::invalid_argument("ParentOrder: iceberg needs limit/display");
+    }
+    break;
+  }
+}
+
+std::vector<double> cumulative_targets(const ParentOrder &parent) {
+  std::vector<double> cumulative(static_cast<size_t>(parent.slices), 1.0);
+  if (parent.algo == ParentAlgo::TWAP) {
+    for (int k = 0; k < parent.slices; ++k) {
+      cumulative[k] = static_cast<double>(k + 1) / parent.slices;
+    }
+  } else if (parent.algo == ParentAlgo::VWAP) {
+    const auto &profile = parent.volume_profile;
+    const double total = std::accumulate(profile.begin(), profile.end(), 0.0);
+    if (total <= 0.0) {
+      throw std::invalid_argument("ParentOrder: empty volume profile");
+    }
+    double running = 0.0;
+    for (size_t k = 0; k < profile.size(); ++k) {
+      running += profile[k];
+      cumulative[k] = running / total;
+    }
+  }
+  if (!cumulative.empty()) {
+    cumulative.back() = 1.0;
+  }
+  return cumulative;
+}
+
+} // namespace
+
+AlgoScheduler::AlgoScheduler(ExecutionContext &ctx) : ctx_(ctx) {}
+
+int64_t AlgoScheduler::submit(const ParentOrder &parent) {
+  validate(parent);
+  Parent state;
+  state.order = parent;
+  if (parent.algo == ParentAlgo::TWAP || parent.algo == ParentAlgo::VWAP) {
+    state.cumulative = cumulative_targets(parent);
+  }
+  parents_.push_back(std::move(state));
+  return static_cast<int64_t>(parents_.size()) - 1;
+}
+
+void AlgoScheduler::cancel(int64_t parent_id) {
+  auto &parent = parents_.at(static_cast<size_t>(parent_id));
+  for (auto it = children_.begin(); it != children_.end();) {
+    if (it->second.parent_id == parent_id) {
+      ctx_.cancel_order(it->first);
+      it = children_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  parent.working = 0;
+  parent.status.done = true;
+}
+
+bool AlgoScheduler::active(const Parent &parent, int asset_id) const {
+  return !parent.status.done && parent.order.asset_id == asset_id;
+}
+
+int64_t AlgoScheduler::slice_start(const Parent &parent, int slice) const {
+  const auto &order = parent.order;
+  return order.start_ts +
+         (order.end_ts - order.start_ts) * slice / order.slices;
+}
+
+void AlgoScheduler::send(int64_t parent_id, double size) {
+  const ParentOrder order = parents_[parent_id].order;
+
+  // Routed by asset and venue, so parents on different assets share one
+  // context.
+  Order child{};
+  child.asset_id = order.asset_id;
+  child.venue_id = order.venue_id;
+  child.side = order.side;
+  child.type = order.limit_price > 0.0 ? OrderType::Limit : OrderType::Market;
+  child.price = order.limit_price;
+  child.size = size;
+  const int64_t child_id = ctx_.submit_order(child);
+
+  auto &parent = parents_[parent_id];
+  children_[child_id] = Child{parent_id, size};
+  parent.status.sent += size;
+  ++parent.working;
+}
+
+void AlgoScheduler::on_bar(const MarketState &bar) {
+  for (size_t id = 0; id < parents_.size(); ++id) {
+    const auto &parent = parents_[id];
+    const auto &order = parent.order;
+    if (!active(parent, bar.asset_id) || bar.timestamp < order.start_ts) {
+      continue;
+    }
+    const bool window_open = order.end_ts == 0 || bar.timestamp < order.end_ts;
+    const double remaining = order.size - parent.status.sent;
+
+    double amount = 0.0;
+    switch (order.algo) {
+    case ParentAlgo::TWAP:
+    case ParentAlgo::VWAP: {
+      int due = parent.next_slice;
+      while (due < order.slices && slice_start(parent, due) <= bar.timestamp) {
+        ++due;
+      }
+      if (due == parent.next_slice) {
+        continue;
+      }
+      parents_[id].next_slice = due;
+      amount = order.size * parent.cumulative[due - 1] - parent.status.sent;
+      break;
+    }
+    case ParentAlgo::POV:
+      if (window_open) {
+        amount = std::min(order.participation * bar.volume, remaining);
+      }
+      break;
+    case ParentAlgo::Iceberg:
+      if (window_open && parent.working == 0) {
+        amount = std::min(order.display_size, remaining);
+      }
+      break;
+    }
+
+    if (amount > kSizeTolerance * order.size) {
+      send(static_cast<int64_t>(id), amount);
+    }
+  }
+}
+
+bool AlgoScheduler::on_fill(const Fill &fill) {
+  auto it = children_.find(fill.order_id);
+  if (it == children_.end()) {
+    return false;
+  }
+  const int64_t parent_id = it->second.parent_id;
+  auto &parent = parents_[parent_id];
+  const double tolerance = kSizeTolerance * parent.order.size;
+
+  parent.status.filled += fill.size;
+  it->second.remaining -= fill.size;
+  const bool child_done = it->second.remaining <= tolerance;
+  if (child_done) {
+    children_.erase(it);
+    --parent.working;
+  }
+
+  if (parent.status.filled >= parent.order.size - tolerance) {
+    parent.status.done = true;
+    return true;
+  }
+
+  // Icebergs show the next slice as soon as the visible one is gone.
+  const auto &order = parent.order;
+  const bool window_open = order.end_ts == 0 || fill.timestamp < order.end_ts;
+  if (order.algo == ParentAlgo::Iceberg && child_done && window_open &&
+      parent.working == 0) {
+    const double remaining = order.size - parent.status.sent;
+    if (remaining > tolerance) {
+      send(parent_id, std::min(order.display_size, remaining));
+    }
+  }
+  return true;
+}
+
+const ParentStatus &AlgoScheduler::status(int64_t parent_id) const {
+  return parents_.at(static_cast<size_t>(parent_id)).status;
+}
+
+bool AlgoScheduler::needs_every_bar(int asset_id) const {
+  return std::any_of(parents_.begin(), parents_.end(), [&](const Parent &p) {
+    return active(p, asset_id) && p.order.algo == ParentAlgo::POV;
+  });
+}
+
+int64_t AlgoScheduler::next_wake(int asset_id) const {
+  int64_t wake = std::numeric_limits<int64_t>::max();
+  for (const auto &parent : parents_) {
+    if (!active(parent, asset_id)) {
+      continue;
+    }
+    const auto &order = parent.order;
+    if (order.algo == ParentAlgo::TWAP || order.algo == ParentAlgo::VWAP) {
+      if (parent.next_slice < order.slices) {
+        wake = std::min(wake, slice_start(parent, parent.next_slice));
+      }
+    } else if (parent.working == 0) {
+      wake = std::min(wake, order.start_ts);
+    }
+  }
+  return wake;
+}
+
+void AlgoScheduler::trigger_levels(int asset_id,
+                                   TriggerLevels &levels) const {
+  for (const auto &parent : parents_) {
+    const auto &order = parent.order;
+    if (active(parent, asset_id) && parent.working > 0 &&
+        order.limit_price > 0.0) {
+      auto &side = order.side == Side::Buy ? levels.falling : levels.rising;
+      side.push_back(order.limit_price);
+    }
+  }
+}
+
+std::vector<double> intraday_volume_profile(std::span<const MarketState> bars,
+                                            int64_t period, int slices) {
+  if (period <= 0 || slices < 1) {
+    throw std::invalid_argument("intraday_volume_profile: bad bucketing");
+  }
+  std::vector<double> profile(static_cast<size_t>(slices), 0.0);
+  for (const auto &bar : bars) {
+    const int64_t offset = ((bar.timestamp % period) + period) % period;
+    profile[static_cast<size_t>(offset * slices / period)] += bar.volume;
+  }
+
+  const double total = std::accumulate(profile.begin(), profile.end(), 0.0);
+  for (auto &share : profile) {
+    share = total > 0.0 ? share / total : 1.0 / slices;
+  }
+  return profile;
+}
+
+} // namespace ctrade
@@ -0,0 +1,37 @@
+#include "ctrade/asset_slice.hpp"
+#include <stdexcept>
+
+namespace ctrade {
+
+AssetSliceBuffer::AssetSliceBuffer(size_t n_assets, size_t n_venues)
+    : n_assets_(n_assets), open_(n_assets * n_venues),
+      high_(n_assets * n_venues), low_(n_assets * n_venues),
+      close_(n_assets * n_venues), volume_(n_assets * n_venues),
+      funding_rate_(n_assets * n_venues) {}
+
+void AssetSliceBuffer::begin(int64_t timestamp) { timestamp_ = timestamp; }
+
+void AssetSliceBuffer::set(const MarketState &market) {
+  if (market.asset_id < 0 ||
+      static_cast<size_t>(market.asset_id) >= n_assets_ ||
+      market.venue_id < 0 ||
+      static_cast<size_t>(market.venue_id) >= size() / n_assets_) {
+    throw std::out_of_range("AssetSliceBuffer: asset or venue out of range");
+  }
+
+  const size_t i = static_cast<size_t>(market.venue_id) * n_assets_ +
+                   static_cast<size_t>(market.asset_id);
+  open_[i] = market.open;
+  high_[i] = market.high;
+  low_[i] = market.low;
+  close_[i] = market.close;
+  volume_[i] = market.volume;
+  funding_rate_[i] = market.funding_rate;
+}
+
+AssetSlice AssetSliceBuffer::view() const {
+  return AssetSlice{timestamp_, open_, high_, low_, close_, volume_,
+                    funding_rate_};
+}
+
+} // namespace ctrade
@@ -0,0 +1,29 @@
+#include "ctrade/backtest_result.hpp"
+#include "ctrade/fnv.hpp"
+#include <bit>
+
+namespace ctrade {
+
+namespace {
+
+template <typename T>
+void hash_series(uint64_t &h, const std::vector<T> &series) {
+  for (const T &value : series) {
+    fnv_word(h, std::bit_cast<uint64_t>(value));
+  }
+  // Length separator so moving a value between series changes the hash.
+  h = (h ^ series.size()) * kFnvPrime;
+}
+
+} // namespace
+
+uint64_t hash_result(const BacktestResult &result) {
+  uint64_t h = kFnvOffset;
+  hash_series(h, result.timestamps);
+  hash_series(h, result.equity);
+  hash_series(h, result.pnl);
+  hash_series(h, result.drawdown);
+  return h;
+}
+
+} // namespace ctrade
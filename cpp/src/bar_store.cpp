@@ -0,0 +1,136 @@
+#include "ctrade/bar_store.hpp"
+#include "ctrade/fnv.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// True if some level lies in [low, high].
+bool touches(std::span<const double> sorted_levels, double low, double high) {
+  auto it = std::lower_bound(sorted_levels.begin(), sorted_levels.end(), low);
+  return it != sorted_levels.end() && *it <= high;
+}
+
+} // namespace
+
+BarStore::BarStore(int asset_id, size_t block_size, int venue_id)
+    : asset_id_(asset_id), venue_id_(venue_id), block_size_(block_size),
+      content_hash_(kFnvOffset) {
+  if (block_size_ == 0) {
+    throw std::invalid_argument("BarStore: block_size must be positive");
+  }
+}
+
+void BarStore::append(const MarketState &bar) {
+  if (!timestamp_.empty() && bar.timestamp <= timestamp_.back()) {
+    throw std::invalid_argument("BarStore: timestamps must increase");
+  }
+
+  const double reach_low =
+      close_.empty() ? bar.low : std::min(bar.low, close_.back());
+  const double reach_high =
+      close_.empty() ? bar.high : std::max(bar.high, close_.back());
+  if (size() % block_size_ == 0) {
+    block_low_.push_back(reach_low);
+    block_high_.push_back(reach_high);
+  } else {
+    block_low_.back() = std::min(block_low_.back(), reach_low);
+    block_high_.back() = std::max(block_high_.back(), reach_high);
+  }
+
+  timestamp_.push_back(bar.timestamp);
+  open_.push_back(bar.open);
+  high_.push_back(bar.high);
+  low_.push_back(bar.low);
+  close_.push_back(bar.close);
+  volume_.push_back(bar.volume);
+  funding_rate_.push_back(bar.funding_rate);
+
+  fnv_word(content_hash_, static_cast<uint64_t>(bar.timestamp));
+  for (double v : {bar.open, bar.high, bar.low, bar.close, bar.volume,
+                   bar.funding_rate}) {
+    fnv_word(content_hash_, std::bit_cast<uint64_t>(v));
+  }
+}
+
+MarketState BarStore::at(size_t i) const {
+  MarketState s{};
+  s.asset_id = asset_id_;
+  s.venue_id = venue_id_;
+  s.timestamp = timestamp_[i];
+  s.open = open_[i];
+  s.high = high_[i];
+  s.low = low_[i];
+  s.close = close_[i];
+  s.volume = volume_[i];
+  s.bid = close_[i];
+  s.ask = close_[i];
+  s.mid = close_[i];
+  s.mark_price = close_[i];
+  s.index_price = close_[i];
+  s.funding_rate = funding_rate_[i];
+  return s;
+}
+
+size_t BarStore::lower_bound(int64_t timestamp) const {
+  return static_cast<size_t>(
+      std::lower_bound(timestamp_.begin(), timestamp_.end(), timestamp) -
+      timestamp_.begin());
+}
+
+size_t BarStore::next_touch(size_t from, size_t to,
+                            std::span<const double> sorted_levels) const {
+  to = std::min(to, size());
+  if (sorted_levels.empty()) {
+    return to;
+  }
+
+  size_t i = from;
+  while (i < to) {
+    const size_t block = i / block_size_;
+    const size_t block_end = std::min((block + 1) * block_size_, to);
+
+    if (touches(sorted_levels, block_low_[block], block_high_[block])) {
+      for (; i < block_end; ++i) {
+        double low = low_[i];
+        double high = high_[i];
+        if (i > 0) {
+          low = std::min(low, close_[i - 1]);
+          high = std::max(high, close_[i - 1]);
+        }
+        if (touches(sorted_levels, low, high)) {
+          return i;
+        }
+      }
+    }
+    i = block_end;
+  }
+  return to;
+}
+
+// ---- BarStoreMarketData ----
+
+BarStoreMarketData::BarStoreMarketData(const BarStore &store, size_t begin,
+                                       size_t end)
+    : store_(store), next_(begin), end_(std::min(end, store.size())) {}
+
+bool BarStoreMarketData::next() {
+  if (next_ >= end_) {
+    return false;
+  }
+  current_ = store_.at(next_++);
+  return true;
+}
+
+void BarStoreMarketData::skip_quiet(std::span<const double> sorted_levels,
+                                    int64_t until_ts) {
+  const size_t stop = std::min(end_, store_.lower_bound(until_ts));
+  if (next_ < stop) {
+    next_ = store_.next_touch(next_, stop, sorted_levels);
+  }
+}
+
+} // namespace ctrade
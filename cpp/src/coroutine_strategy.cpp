@@ -0,0 +1,183 @@
+#include "ctrade/coroutine_strategy.hpp"
+#include <algorithm>
+
+namespace ctrade {
+
+// ---- StrategyTask ----
+
+StrategyTask &StrategyTask::operator=(StrategyTask &&other) noexcept {
+  if (this != &other) {
+    if (handle_) {
+      handle_.destroy();
+    }
+    handle_ = std::exchange(other.handle_, {});
+  }
+  return *this;
+}
+
+StrategyTask::~StrategyTask() {
+  if (handle_) {
+    handle_.destroy();
+  }
+}
+
+void StrategyTask::rethrow_if_failed() const {
+  if (handle_ && handle_.promise().error) {
+    std::rethrow_exception(handle_.promise().error);
+  }
+}
+
+// ---- Awaiters ----
+
+void CoroutineStrategy::FillAwaiter::await_suspend(std::coroutine_handle<> h) {
+  waiter.handle = h;
+  waiter.order_id = order_id;
+  const uint64_t ticket = self->add_waiter(waiter);
+  self->fill_tickets_.emplace(order_id, ticket);
+  if (max_wait >= 0) {
+    self->add_timer(self->now_ + max_wait, ticket);
+  }
+}
+
+void CoroutineStrategy::TimeoutAwaiter::await_suspend(
+    std::coroutine_handle<> h) {
+  waiter.handle = h;
+  const uint64_t ticket = self->add_waiter(waiter);
+  self->add_timer(self->now_ + duration, ticket);
+}
+
+// ---- CoroutineStrategy ----
+
+void CoroutineStrategy::on_bar(const MarketState &market,
+                               ExecutionContext &ctx) {
+  now_ = market.timestamp;
+  market_ = &market;
+
+  if (!started_) {
+    started_ = true;
+    ctx_ = &ctx;
+    spawn(run(ctx));
+  }
+
+  fire_timers();
+
+  if (!bar_waiters_.empty()) {
+    // Coroutines awaiting next_bar() again re-register for the next bar.
+    std::vector<std::coroutine_handle<>> ready;
+    ready.swap(bar_waiters_);
+    resume_all(ready);
+  }
+
+  market_ = nullptr;
+}
+
+void CoroutineStrategy::on_fill(const Fill &fill, ExecutionContext &) {
+  now_ = std::max(now_, fill.timestamp);
+
+  // Unregister every waiter first: a resumed task may await the same
+  // order id again, which must wait for the next fill. Waiters resume in
+  // the order they started waiting.
+  const auto [first, last] = fill_tickets_.equal_range(fill.order_id);
+  std::vector<uint64_t> tickets;
+  for (auto it = first; it != last; ++it) {
+    tickets.push_back(it->second);
+  }
+  fill_tickets_.erase(first, last);
+  std::sort(tickets.begin(), tickets.end());
+
+  std::vector<std::coroutine_handle<>> ready;
+  for (const uint64_t ticket : tickets) {
+    auto waiter_it = waiters_.find(ticket);
+    if (waiter_it != waiters_.end()) {
+      waiter_it->second->fill = fill;
+      ready.push_back(waiter_it->second->handle);
+      waiters_.erase(waiter_it);
+    }
+  }
+  resume_all(ready);
+}
+
+void CoroutineStrategy::on_timer(const TimerEvent &timer, ExecutionContext &) {
+  now_ = std::max(now_, timer.timestamp);
+  fire_timers();
+}
+
+void CoroutineStrategy::spawn(StrategyTask task) {
+  auto handle = task.handle_;
+  tasks_.push_back(std::move(task));
+  resume(handle);
+}
+
+uint64_t CoroutineStrategy::add_waiter(Waiter &waiter) {
+  const uint64_t ticket = next_ticket_++;
+  waiters_[ticket] = &waiter;
+  return ticket;
+}
+
+void CoroutineStrategy::add_timer(int64_t deadline, uint64_t ticket) {
+  timers_.push({deadline, ticket});
+  ctx_->schedule_timer(deadline);
+}
+
+void CoroutineStrategy::fire_timers() {
+  while (!timers_.empty() && timers_.top().deadline <= now_) {
+    const uint64_t ticket = timers_.top().ticket;
+    timers_.pop();
+
+    // Fill waiters whose fill already arrived left a stale timer behind.
+    auto it = waiters_.find(ticket);
+    if (it == waiters_.end()) {
+      continue;
+    }
+    Waiter *waiter = it->second;
+    waiters_.erase(it);
+    if (waiter->order_id >= 0) {
+      const auto [first, last] = fill_tickets_.equal_range(waiter->order_id);
+      const auto match = std::find_if(first, last, [&](const auto &entry) {
+        return entry.second == ticket;
+      });
+      if (match != last) {
+        fill_tickets_.erase(match);
+      }
+    }
+    resume(waiter->handle);
+  }
+}
+
+void CoroutineStrategy::resume(std::coroutine_handle<> handle) {
+  handle.resume();
+
+  // A failed task is finished, so it is dropped with the others before its
+  // error propagates; later callbacks do not rethrow it again.
+  std::exception_ptr error;
+  for (const auto &task : tasks_) {
+    if (!error && task.handle_ && task.handle_.promise().error) {
+      error = task.handle_.promise().error;
+    }
+  }
+  std::erase_if(tasks_, [](const StrategyTask &task) { return task.done(); });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void CoroutineStrategy::resume_all(
+    const std::vector<std::coroutine_handle<>> &handles) {
+  // The waiters are no longer registered, so a task that throws must not
+  // stop the others from running; the first error propagates afterwards.
+  std::exception_ptr error;
+  for (auto handle : handles) {
+    try {
+      resume(handle);
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ctrade
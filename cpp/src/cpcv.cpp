@@ -0,0 +1,228 @@
+#include "ctrade/cpcv.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Running sums of per-bar returns; bar i holds equity[i] / equity[i-1] - 1
+// and bar 0 has none.
+struct ReturnPrefix {
+  std::vector<double> sum;
+  std::vector<double> sum_sq;
+  std::vector<size_t> count;
+
+  explicit ReturnPrefix(const std::vector<double> &equity)
+      : sum(equity.size() + 1, 0.0), sum_sq(equity.size() + 1, 0.0),
+        count(equity.size() + 1, 0) {
+    for (size_t i = 0; i < equity.size(); ++i) {
+      const bool has_return = i > 0 && equity[i - 1] != 0.0;
+      const double r = has_return ? equity[i] / equity[i - 1] - 1.0 : 0.0;
+      sum[i + 1] = sum[i] + r;
+      sum_sq[i + 1] = sum_sq[i] + r * r;
+      count[i + 1] = count[i] + (has_return ? 1 : 0);
+    }
+  }
+};
+
+struct Moments {
+  double n = 0.0;
+  double sum = 0.0;
+  double sum_sq = 0.0;
+
+  void add(const ReturnPrefix &p, const BarRange &range) {
+    n += static_cast<double>(p.count[range.second] - p.count[range.first]);
+    sum += p.sum[range.second] - p.sum[range.first];
+    sum_sq += p.sum_sq[range.second] - p.sum_sq[range.first];
+  }
+
+  // Mean / sample stdev, not annualized, as in summarize().
+  double sharpe() const {
+    if (n < 2.0) {
+      return 0.0;
+    }
+    const double var = (sum_sq - sum * sum / n) / (n - 1.0);
+    return var > 0.0 ? (sum / n) / std::sqrt(var) : 0.0;
+  }
+};
+
+} // namespace
+
+std::vector<std::vector<size_t>> combinations(size_t n, size_t k) {
+  std::vector<std::vector<size_t>> out;
+  if (k > n) {
+    return out;
+  }
+  std::vector<size_t> current(k);
+  for (size_t i = 0; i < k; ++i) {
+    current[i] = i;
+  }
+  while (true) {
+    out.push_back(current);
+    // Advance the rightmost index that still has room.
+    size_t i = k;
+    while (i > 0 && current[i - 1] == n - k + (i - 1)) {
+      --i;
+    }
+    if (i == 0) {
+      return out;
+    }
+    ++current[i - 1];
+    for (size_t j = i; j < k; ++j) {
+      current[j] = current[j - 1] + 1;
+    }
+  }
+}
+
+std::vector<BarRange> cpcv_groups(size_t n_bars, size_t n_groups) {
+  if (n_groups == 0 || n_groups > n_bars) {
+    throw std::invalid_argument("cpcv_groups: need 1 <= n_groups <= n_bars");
+  }
+  std::vector<BarRange> groups;
+  groups.reserve(n_groups);
+  for (size_t g = 0; g < n_groups; ++g) {
+    groups.emplace_back(g * n_bars / n_groups, (g + 1) * n_bars / n_groups);
+  }
+  return groups;
+}
+
+std::vector<BarRange> cpcv_train_ranges(const std::vector<BarRange> &groups,
+                                        const std::vector<size_t> &test_groups,
+                                        size_t purge, size_t embargo) {
+  std::vector<bool> is_test(groups.size(), false);
+  for (size_t g : test_groups) {
+    is_test.at(g) = true;
+  }
+
+  std::vector<BarRange> train;
+  for (size_t g = 0; g < groups.size(); ++g) {
+    if (is_test[g]) {
+      continue;
+    }
+    auto [begin, end] = groups[g];
+    if (g > 0 && is_test[g - 1]) {
+      begin = std::min(end, begin + embargo);
+    }
+    if (g + 1 < groups.size() && is_test[g + 1]) {
+      end = end - std::min(end - begin, purge);
+    }
+    if (begin >= end) {
+      continue;
+    }
+    if (!train.empty() && train.back().second == begin) {
+      train.back().second = end;
+    } else {
+      train.emplace_back(begin, end);
+    }
+  }
+  return train;
+}
+
+CpcvResult run_cpcv(const std::vector<ParamSet> &params, const RunFn &run,
+                    const CpcvConfig &cpcv, const SweepConfig &config) {
+  if (params.empty()) {
+    throw std::invalid_argument("run_cpcv: no parameter sets");
+  }
+  if (cpcv.n_test_groups == 0 || cpcv.n_test_groups >= cpcv.n_groups) {
+    throw std::invalid_argument(
+        "run_cpcv: need 0 < n_test_groups < n_groups");
+  }
+
+  // ---- One full-range run per parameter set ----
+  std::vector<std::vector<double>> equity(params.size());
+  parallel_for(params.size(), config.threads, [&](size_t i, unsigned) {
+    CounterRng rng(config.seed, i);
+    equity[i] = run(params[i], rng).equity;
+  });
+  const size_t n_bars = equity[0].size();
+  std::vector<ReturnPrefix> prefix;
+  prefix.reserve(params.size());
+  for (const auto &curve : equity) {
+    if (curve.size() != n_bars) {
+      throw std::runtime_error("run_cpcv: runs differ in length");
+    }
+    prefix.emplace_back(curve);
+  }
+
+  CpcvResult result;
+  result.n_runs = params.size();
+  result.groups = cpcv_groups(n_bars, cpcv.n_groups);
+  const auto tests = combinations(cpcv.n_groups, cpcv.n_test_groups);
+  result.splits.resize(tests.size());
+
+  // ---- Score every split ----
+  const size_t n_params = params.size();
+  parallel_for(tests.size(), config.threads, [&](size_t s, unsigned) {
+    const auto train =
+        cpcv_train_ranges(result.groups, tests[s], cpcv.purge, cpcv.embargo);
+    std::vector<double> train_sharpe(n_params);
+    std::vector<double> test_sharpe(n_params);
+    for (size_t p = 0; p < n_params; ++p) {
+      Moments in_sample;
+      for (const auto &range : train) {
+        in_sample.add(prefix[p], range);
+      }
+      Moments out_of_sample;
+      for (size_t g : tests[s]) {
+        out_of_sample.add(prefix[p], result.groups[g]);
+      }
+      train_sharpe[p] = in_sample.sharpe();
+      test_sharpe[p] = out_of_sample.sharpe();
+    }
+
+    // Lowest index wins ties.
+    const size_t selected = static_cast<size_t>(
+        std::max_element(train_sharpe.begin(), train_sharpe.end()) -
+        train_sharpe.begin());
+    size_t rank = 1;
+    for (size_t p = 0; p < n_params; ++p) {
+      rank += test_sharpe[p] < test_sharpe[selected] ? 1 : 0;
+    }
+
+    auto &split = result.splits[s];
+    split.test_groups = tests[s];
+    split.selected = selected;
+    split.train_sharpe = train_sharpe[selected];
+    split.test_sharpe = test_sharpe[selected];
+    split.test_rank =
+        static_cast<double>(rank) / static_cast<double>(n_params + 1);
+  });
+
+  // ---- Reduce in split order ----
+  size_t overfit = 0;
+  for (const auto &split : result.splits) {
+    result.mean_train_sharpe += split.train_sharpe;
+    result.mean_test_sharpe += split.test_sharpe;
+    overfit += split.test_rank <= 0.5 ? 1 : 0;
+  }
+  const double n_splits = static_cast<double>(result.splits.size());
+  result.mean_train_sharpe /= n_splits;
+  result.mean_test_sharpe /= n_splits;
+  result.pbo = static_cast<double>(overfit) / n_splits;
+
+  // ---- Stitch backtest paths ----
+  // Each group is tested in C(N-1, k-1) splits; path j takes the j-th of
+  // them for every group.
+  std::vector<std::vector<size_t>> tested_in(cpcv.n_groups);
+  for (size_t s = 0; s < result.splits.size(); ++s) {
+    for (size_t g : result.splits[s].test_groups) {
+      tested_in[g].push_back(s);
+    }
+  }
+  const size_t n_paths = tested_in[0].size();
+  result.path_sharpe.reserve(n_paths);
+  for (size_t j = 0; j < n_paths; ++j) {
+    Moments path;
+    for (size_t g = 0; g < cpcv.n_groups; ++g) {
+      const auto &split = result.splits[tested_in[g][j]];
+      path.add(prefix[split.selected], result.groups[g]);
+    }
+    result.path_sharpe.push_back(path.sharpe());
+  }
+  return result;
+}
+
+} // namespace ctrade
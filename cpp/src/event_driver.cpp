@@ -0,0 +1,196 @@
+#include "ctrade/event_driver.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ctrade {
+
+EventDriver::EventDriver(Strategy &strategy, ExecutionContext &ctx)
+    : strategy_(strategy), ctx_(ctx), wake_(strategy.wake_policy()) {}
+
+void EventDriver::set_trigger_levels(TriggerLevelsFn levels) {
+  trigger_levels_ = std::move(levels);
+}
+
+void EventDriver::add_market_data(MarketData &source) {
+  sources_.push_back(&source);
+  ++active_sources_;
+  advance(sources_.size() - 1);
+}
+
+void EventDriver::enable_slices(size_t n_assets, size_t n_venues) {
+  slices_.emplace(n_assets, n_venues);
+}
+
+void EventDriver::enable_risk(double lambda) {
+  if (!slices_) {
+    throw std::logic_error("EventDriver: enable_risk needs enable_slices");
+  }
+  risk_.emplace(slices_->size(), lambda);
+}
+
+int64_t EventDriver::schedule_timer(int64_t timestamp) {
+  const int64_t id = next_timer_id_++;
+  timestamp = std::max(timestamp, now_);
+  push(Event{EventType::Timer, timestamp, 0, TimerEvent{id, timestamp}});
+  return id;
+}
+
+void EventDriver::push_tick(const Tick &tick) {
+  push(Event{EventType::Tick, tick.timestamp, 0, tick});
+}
+
+void EventDriver::push_fill(const Fill &fill) {
+  push(Event{EventType::Fill, fill.timestamp, 0, fill});
+}
+
+void EventDriver::push_funding(const FundingEvent &event) {
+  push(Event{EventType::Funding, event.timestamp, 0, event});
+}
+
+void EventDriver::push_liquidation(const LiquidationEvent &event) {
+  push(Event{EventType::Liquidation, event.timestamp, 0, event});
+}
+
+void EventDriver::run(int64_t end_ts) {
+  for (;;) {
+    // Events at the slice's timestamp (e.g. fills of orders placed in
+    // on_bar) sort ahead of its remaining bars, so the slice is only
+    // complete once the next event is later.
+    if (slice_pending_ &&
+        (queue_.empty() || queue_.top().timestamp > slice_ts_)) {
+      flush_slice();
+      continue;
+    }
+    if (queue_.empty() || queue_.top().timestamp > end_ts) {
+      break;
+    }
+    Event event = queue_.pop();
+    now_ = event.timestamp;
+    if (event.type != EventType::Bar) {
+      wake_times_.pop();
+    }
+    dispatch(event);
+  }
+}
+
+void EventDriver::push(Event event) {
+  event.timestamp = std::max(event.timestamp, now_);
+  if (event.type != EventType::Bar) {
+    wake_times_.push(event.timestamp);
+  }
+  queue_.push(std::move(event));
+}
+
+void EventDriver::advance(size_t source) {
+  MarketData &data = *sources_[source];
+  if (data.next()) {
+    push(Event{EventType::Bar, data.current().timestamp, source, {}});
+  } else {
+    --active_sources_;
+  }
+}
+
+void EventDriver::skip_quiet_bars(size_t source) {
+  if (wake_.mode != WakeMode::TriggersOnly || !trigger_levels_) {
+    return;
+  }
+
+  const MarketState &last = sources_[source]->current();
+  const int asset_id = last.asset_id;
+  levels_.clear();
+  if (!trigger_levels_(asset_id, levels_)) {
+    return;
+  }
+
+  int64_t until = wake_times_.empty() ? std::numeric_limits<int64_t>::max()
+                                      : wake_times_.top();
+  if (algos_ != nullptr) {
+    if (algos_->needs_every_bar(asset_id)) {
+      return;
+    }
+    algos_->trigger_levels(asset_id, levels_);
+    until = std::min(until, algos_->next_wake(asset_id));
+  }
+
+  // A level already on the wrong side of the last price (a marketable
+  // limit, a stop through the market) acts on the next bar.
+  const auto &falling = levels_.falling;
+  const auto &rising = levels_.rising;
+  if (std::any_of(falling.begin(), falling.end(),
+                  [&](double level) { return level > last.close; }) ||
+      std::any_of(rising.begin(), rising.end(),
+                  [&](double level) { return level < last.close; })) {
+    return;
+  }
+  sorted_levels_.assign(falling.begin(), falling.end());
+  sorted_levels_.insert(sorted_levels_.end(), rising.begin(), rising.end());
+  std::sort(sorted_levels_.begin(), sorted_levels_.end());
+  sources_[source]->skip_quiet(sorted_levels_, until);
+}
+
+void EventDriver::dispatch(const Event &event) {
+  switch (event.type) {
+  case EventType::Bar:
+    dispatch_bar(event);
+    break;
+  case EventType::Tick:
+    strategy_.on_tick(std::get<Tick>(event.data), ctx_);
+    break;
+  case EventType::Timer: {
+    const auto &timer = std::get<TimerEvent>(event.data);
+    // Periodic timers stop once all market data is consumed.
+    if (timer.timer_id == periodic_timer_id_ && active_sources_ > 0) {
+      periodic_timer_id_ = schedule_timer(timer.timestamp + wake_.timer_period);
+    }
+    strategy_.on_timer(timer, ctx_);
+    break;
+  }
+  case EventType::Funding:
+    strategy_.on_funding(std::get<FundingEvent>(event.data), ctx_);
+    break;
+  case EventType::Fill:
+    if (algos_ != nullptr) {
+      algos_->on_fill(std::get<Fill>(event.data));
+    }
+    strategy_.on_fill(std::get<Fill>(event.data), ctx_);
+    break;
+  case EventType::Liquidation:
+    strategy_.on_liquidation(std::get<LiquidationEvent>(event.data), ctx_);
+    break;
+  }
+}
+
+void EventDriver::dispatch_bar(const Event &event) {
+  const MarketState &market = sources_[event.source]->current();
+  if (wake_.timer_period > 0 && periodic_timer_id_ < 0) {
+    periodic_timer_id_ = schedule_timer(market.timestamp + wake_.timer_period);
+  }
+  if (algos_ != nullptr) {
+    algos_->on_bar(market);
+  }
+  if (wake_.bar_callbacks || !slices_) {
+    strategy_.on_bar(market, ctx_);
+  }
+
+  if (slices_) {
+    if (market.timestamp != slice_ts_) {
+      slice_ts_ = market.timestamp;
+      slices_->begin(slice_ts_);
+    }
+    slices_->set(market);
+  }
+
+  skip_quiet_bars(event.source);
+  advance(event.source);
+  slice_pending_ = slices_.has_value();
+}
+
+void EventDriver::flush_slice() {
+  slice_pending_ = false;
+  if (risk_) {
+    risk_->update(slices_->view());
+  }
+  strategy_.on_slice(slices_->view(), ctx_);
+}
+
+} // namespace ctrade
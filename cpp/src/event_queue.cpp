@@ -0,0 +1,87 @@
+#include "ctrade/event_queue.hpp"
+#include <stdexcept>
+#include <utility>
+
+namespace ctrade {
+
+bool EventQueue::before(const Key &a, const Key &b) {
+  if (a.timestamp != b.timestamp) {
+    return a.timestamp < b.timestamp;
+  }
+  if (a.type != b.type) {
+    return a.type < b.type;
+  }
+  return a.seq < b.seq;
+}
+
+void EventQueue::push(Event event) {
+  uint32_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot] = std::move(event);
+  } else {
+    slot = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(std::move(event));
+  }
+
+  const Event &stored = slots_[slot];
+  heap_.push_back(Key{stored.timestamp, next_seq_++, slot, stored.type});
+  sift_up(heap_.size() - 1);
+}
+
+Event EventQueue::pop() {
+  if (heap_.empty()) {
+    throw std::out_of_range("EventQueue::pop on empty queue");
+  }
+
+  const uint32_t slot = heap_.front().slot;
+  heap_.front() = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    sift_down(0);
+  }
+
+  free_slots_.push_back(slot);
+  return std::move(slots_[slot]);
+}
+
+void EventQueue::sift_up(size_t i) {
+  Key key = heap_[i];
+  while (i > 0) {
+    const size_t parent = (i - 1) / kArity;
+    if (!before(key, heap_[parent])) {
+      break;
+    }
+    heap_[i] = heap_[parent];
+    i = parent;
+  }
+  heap_[i] = key;
+}
+
+void EventQueue::sift_down(size_t i) {
+  const size_t n = heap_.size();
+  Key key = heap_[i];
+  for (;;) {
+    const size_t first = i * kArity + 1;
+    if (first >= n) {
+      break;
+    }
+    const size_t last = first + kArity < n ? first + kArity : n;
+
+    size_t best = first;
+    for (size_t c = first + 1; c < last; ++c) {
+      if (before(heap_[c], heap_[best])) {
+        best = c;
+      }
+    }
+    if (!before(heap_[best], key)) {
+      break;
+    }
+    heap_[i] = heap_[best];
+    i = best;
+  }
+  heap_[i] = key;
+}
+
+} // namespace ctrade
@@ -0,0 +1,148 @@
+#include "ctrade/event_study.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ctrade {
+
+namespace {
+
+// Bars per parallel scan task.
+constexpr size_t kTaskBars = size_t{1} << 16;
+
+// Events per parallel gather task.
+constexpr size_t kTaskEvents = 1024;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// (store, first bar) for every scan task over every store.
+std::vector<std::pair<size_t, size_t>>
+tasks_for(std::span<const BarStore *const> stores) {
+  std::vector<std::pair<size_t, size_t>> tasks;
+  for (size_t s = 0; s < stores.size(); ++s) {
+    for (size_t begin = 0; begin < stores[s]->size(); begin += kTaskBars) {
+      tasks.emplace_back(s, begin);
+    }
+  }
+  return tasks;
+}
+
+void gather(const BarStore &bars, size_t i, size_t before, double *ret,
+            double *volume, double *funding, size_t width) {
+  const auto close = bars.close();
+  const auto vol = bars.volume();
+  const auto rate = bars.funding_rate();
+  const double base = close[i];
+  for (size_t k = 0; k < width; ++k) {
+    // Wraps below zero, which the bound check catches as well.
+    const size_t j = i + k - before;
+    if (i + k < before || j >= bars.size()) {
+      ret[k] = volume[k] = funding[k] = kNaN;
+      continue;
+    }
+    ret[k] = close[j] / base - 1.0;
+    volume[k] = vol[j];
+    funding[k] = rate[j];
+  }
+}
+
+} // namespace
+
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       const EventMaskFn &mask,
+                       const EventStudyConfig &config) {
+  std::vector<std::vector<uint8_t>> masks(stores.size());
+  for (size_t s = 0; s < stores.size(); ++s) {
+    masks[s].resize(stores[s]->size());
+  }
+  const auto tasks = tasks_for(stores);
+  parallel_for(tasks.size(), config.threads, [&](size_t t, unsigned) {
+    const auto [s, begin] = tasks[t];
+    const size_t end = std::min(stores[s]->size(), begin + kTaskBars);
+    mask(*stores[s], begin,
+         std::span<uint8_t>(masks[s]).subspan(begin, end - begin));
+  });
+
+  std::vector<std::span<const uint8_t>> views(masks.begin(), masks.end());
+  return event_study(stores, views, config);
+}
+
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       const EventPredicate &predicate,
+                       const EventStudyConfig &config) {
+  const EventMaskFn mask = [&predicate](const BarStore &bars, size_t begin,
+                                        std::span<uint8_t> out) {
+    for (size_t k = 0; k < out.size(); ++k) {
+      out[k] = predicate(bars, begin + k) ? 1 : 0;
+    }
+  };
+  return event_study(stores, mask, config);
+}
+
+EventPanel event_study(std::span<const BarStore *const> stores,
+                       std::span<const std::span<const uint8_t>> masks,
+                       const EventStudyConfig &config) {
+  if (masks.size() != stores.size()) {
+    throw std::invalid_argument("event_study: need one mask per store");
+  }
+  for (size_t s = 0; s < stores.size(); ++s) {
+    if (masks[s].size() != stores[s]->size()) {
+      throw std::invalid_argument("event_study: mask needs one byte per bar");
+    }
+  }
+
+  // ---- Find matches per chunk ----
+  const auto tasks = tasks_for(stores);
+  std::vector<std::vector<uint32_t>> matches(tasks.size());
+  parallel_for(tasks.size(), config.threads, [&](size_t t, unsigned) {
+    const auto [s, begin] = tasks[t];
+    const size_t end = std::min(stores[s]->size(), begin + kTaskBars);
+    for (size_t i = begin; i < end; ++i) {
+      if (masks[s][i] != 0) {
+        matches[t].push_back(static_cast<uint32_t>(i));
+      }
+    }
+  });
+
+  // ---- Apply the cooldown in bar order ----
+  EventPanel panel;
+  panel.before = config.before;
+  panel.after = config.after;
+  size_t prev_store = stores.size();
+  size_t last = 0;
+  for (size_t t = 0; t < tasks.size(); ++t) {
+    const size_t s = tasks[t].first;
+    for (const uint32_t i : matches[t]) {
+      if (s == prev_store && i - last <= config.cooldown) {
+        continue;
+      }
+      prev_store = s;
+      last = i;
+      panel.store.push_back(static_cast<uint32_t>(s));
+      panel.bar.push_back(i);
+      panel.timestamp.push_back(stores[s]->timestamps()[i]);
+    }
+  }
+
+  // ---- Gather windows ----
+  const size_t n = panel.n_events();
+  const size_t width = panel.width();
+  panel.returns.resize(n * width);
+  panel.volume.resize(n * width);
+  panel.funding_rate.resize(n * width);
+  parallel_for((n + kTaskEvents - 1) / kTaskEvents, config.threads,
+               [&](size_t t, unsigned) {
+                 const size_t end = std::min(n, (t + 1) * kTaskEvents);
+                 for (size_t e = t * kTaskEvents; e < end; ++e) {
+                   const size_t at = e * width;
+                   gather(*stores[panel.store[e]], panel.bar[e],
+                          config.before, &panel.returns[at],
+                          &panel.volume[at], &panel.funding_rate[at], width);
+                 }
+               });
+  return panel;
+}
+
+} // namespace ctrade
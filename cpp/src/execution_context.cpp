@@ -4,24 +4,48 @@
 namespace ctrade {
 
 struct TodoExecutionContext : ExecutionContext {
-  void market_buy(double) override { throw std::runtime_error("TODO"); }
-  void market_sell(double) override { throw std::runtime_error("TODO"); }
-  void limit_buy(double, double) override { throw std::runtime_error("TODO"); }
-  void limit_sell(double, double) override { throw std::runtime_error("TODO"); }
-  void stop_buy(double, double) override { throw std::runtime_error("TODO"); }
-  void stop_sell(double, double) override { throw std::runtime_error("TODO"); }
-  void stop_limit_buy(double, double, double) override {
+  int64_t market_buy(double) override { throw std::runtime_error("TODO"); }
+  int64_t market_sell(double) override { throw std::runtime_error("TODO"); }
+  int64_t limit_buy(double, double) override {
     throw std::runtime_error("TODO");
   }
-  void stop_limit_sell(double, double, double) override {
+  int64_t limit_sell(double, double) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t stop_buy(double, double) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t stop_sell(double, double) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t stop_limit_buy(double, double, double) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t stop_limit_sell(double, double, double) override {
     throw std::runtime_error("TODO");
   }
   void close_position() override { throw std::runtime_error("TODO"); }
   void close_long() override { throw std::runtime_error("TODO"); }
   void close_short() override { throw std::runtime_error("TODO"); }
   void close_amount(double) override { throw std::runtime_error("TODO"); }
-  void cancel_order(int) override { throw std::runtime_error("TODO"); }
+  void set_target_weights(std::span<const double>) override {
+    throw std::runtime_error("TODO");
+  }
+  void set_target_positions(std::span<const double>) override {
+    throw std::runtime_error("TODO");
+  }
+  void cancel_order(int64_t) override { throw std::runtime_error("TODO"); }
   void cancel_all() override { throw std::runtime_error("TODO"); }
+  void amend_order(int64_t, double, double) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t submit_parent_order(const ParentOrder &) override {
+    throw std::runtime_error("TODO");
+  }
+  void cancel_parent_order(int64_t) override {
+    throw std::runtime_error("TODO");
+  }
+  int64_t schedule_timer(int64_t) override { throw std::runtime_error("TODO"); }
   void set_leverage(int) override { throw std::runtime_error("TODO"); }
   void set_cross_mode() override { throw std::runtime_error("TODO"); }
   void set_isolated_mode() override { throw std::runtime_error("TODO"); }
@@ -0,0 +1,224 @@
+#include "ctrade/feature_store.hpp"
+#include "ctrade/fnv.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ctrade {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x3154414546544300; // "\0CTFEAT1", native order
+
+// Values start after this, so they stay 8-byte aligned in the mapping.
+struct Header {
+  uint64_t magic;
+  uint64_t id;
+  uint64_t fingerprint;
+  uint64_t rows;
+  uint64_t reserved[4];
+};
+static_assert(sizeof(Header) == 64);
+
+template <typename T> void fnv_series(uint64_t &h, std::span<const T> series) {
+  for (T value : series) {
+    fnv_word(h, std::bit_cast<uint64_t>(value));
+  }
+  fnv_word(h, series.size());
+}
+
+// Maps `path` if it holds the expected column; nullptr otherwise.
+void *map_column(const std::string &path, uint64_t id, uint64_t fingerprint,
+                 size_t rows) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st {};
+  const size_t bytes = sizeof(Header) + rows * sizeof(double);
+  void *map = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == bytes) {
+    map = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return nullptr;
+  }
+  const auto *header = static_cast<const Header *>(map);
+  if (header->magic != kMagic || header->id != id ||
+      header->fingerprint != fingerprint || header->rows != rows) {
+    ::munmap(map, bytes);
+    return nullptr;
+  }
+  return map;
+}
+
+void write_column(const std::string &path, uint64_t id, uint64_t fingerprint,
+                  std::span<const double> values) {
+  Header header{};
+  header.magic = kMagic;
+  header.id = id;
+  header.fingerprint = fingerprint;
+  header.rows = values.size();
+
+  // Write then rename, so readers never map a partial file.
+  const std::string tmp = path + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(values.data()),
+              static_cast<std::streamsize>(values.size_bytes()));
+    // close() flushes, so a full disk shows up here rather than after
+    // the rename.
+    out.close();
+    if (!out) {
+      throw std::runtime_error("FeatureStore: cannot write " + tmp);
+    }
+  }
+  std::filesystem::rename(tmp, path);
+}
+
+} // namespace
+
+uint64_t feature_id(const FeatureKey &key) {
+  uint64_t h = kFnvOffset;
+  fnv_bytes(h, reinterpret_cast<const uint8_t *>(key.name.data()),
+            key.name.size());
+  fnv_word(h, key.name.size());
+  fnv_series(h, std::span<const double>(key.params));
+  fnv_word(h, key.version);
+  return h;
+}
+
+uint64_t bars_fingerprint(const BarStore &bars) {
+  uint64_t h = kFnvOffset;
+  fnv_word(h, static_cast<uint64_t>(bars.asset_id()));
+  fnv_word(h, static_cast<uint64_t>(bars.venue_id()));
+  fnv_word(h, bars.content_hash());
+  fnv_word(h, bars.size());
+  return h;
+}
+
+// ---- FeatureColumn ----
+
+FeatureColumn::FeatureColumn(void *map, size_t map_bytes, size_t size)
+    : map_(map), map_bytes_(map_bytes),
+      values_(reinterpret_cast<const double *>(static_cast<const char *>(map) +
+                                               sizeof(Header))),
+      size_(size) {}
+
+FeatureColumn::~FeatureColumn() { ::munmap(map_, map_bytes_); }
+
+// ---- FeatureStore ----
+
+FeatureStore::FeatureStore(std::string directory)
+    : directory_(std::move(directory)) {
+  std::filesystem::create_directories(directory_);
+}
+
+std::string FeatureStore::path(uint64_t id, uint64_t fingerprint) const {
+  char name[48];
+  std::snprintf(name, sizeof(name), "%016llx-%016llx.col",
+                static_cast<unsigned long long>(id),
+                static_cast<unsigned long long>(fingerprint));
+  return (std::filesystem::path(directory_) / name).string();
+}
+
+FeatureHandle FeatureStore::get(const FeatureKey &key, const BarStore &bars,
+                                const FeatureFn &compute) {
+  const uint64_t id = feature_id(key);
+  const uint64_t fingerprint = bars_fingerprint(bars);
+  const std::string file = path(id, fingerprint);
+  const size_t bytes = sizeof(Header) + bars.size() * sizeof(double);
+
+  // The first caller computes; the rest wait on its future.
+  std::promise<FeatureHandle> promise;
+  std::shared_future<FeatureHandle> pending;
+  {
+    std::lock_guard lock(mutex_);
+    auto [it, inserted] = open_.try_emplace(file);
+    if (inserted) {
+      it->second = promise.get_future().share();
+    } else {
+      pending = it->second;
+    }
+  }
+  if (pending.valid()) {
+    return pending.get();
+  }
+
+  try {
+    void *map = map_column(file, id, fingerprint, bars.size());
+    if (!map) {
+      std::vector<double> values(bars.size(),
+                                 std::numeric_limits<double>::quiet_NaN());
+      compute(bars, values);
+      write_column(file, id, fingerprint, values);
+      map = map_column(file, id, fingerprint, bars.size());
+      if (!map) {
+        throw std::runtime_error("FeatureStore: cannot map " + file);
+      }
+      std::lock_guard lock(mutex_);
+      ++computed_;
+    }
+    FeatureHandle handle(new FeatureColumn(map, bytes, bars.size()));
+    promise.set_value(handle);
+    return handle;
+  } catch (...) {
+    {
+      std::lock_guard lock(mutex_);
+      open_.erase(file);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+FeatureHandle FeatureStore::find(const FeatureKey &key, const BarStore &bars) {
+  const uint64_t id = feature_id(key);
+  const uint64_t fingerprint = bars_fingerprint(bars);
+  const std::string file = path(id, fingerprint);
+
+  std::shared_future<FeatureHandle> pending;
+  {
+    std::lock_guard lock(mutex_);
+    auto it = open_.find(file);
+    if (it != open_.end()) {
+      pending = it->second;
+    }
+  }
+  if (pending.valid()) {
+    try {
+      return pending.get();
+    } catch (...) {
+      return nullptr;
+    }
+  }
+
+  void *map = map_column(file, id, fingerprint, bars.size());
+  if (!map) {
+    return nullptr;
+  }
+  FeatureHandle handle(new FeatureColumn(
+      map, sizeof(Header) + bars.size() * sizeof(double), bars.size()));
+  std::promise<FeatureHandle> ready;
+  ready.set_value(handle);
+  std::lock_guard lock(mutex_);
+  return open_.emplace(file, ready.get_future().share()).first->second.get();
+}
+
+size_t FeatureStore::computed() const {
+  std::lock_guard lock(mutex_);
+  return computed_;
+}
+
+} // namespace ctrade
@@ -0,0 +1,153 @@
+#include "ctrade/hybrid_execution.hpp"
+#include <algorithm>
+
+namespace ctrade {
+
+namespace {
+
+bool is_buy(const Order &order) { return order.side == Side::Buy; }
+
+// Limit is traded through: strictly better than our price.
+bool trades_through(const Order &order, double price) {
+  return is_buy(order) ? price < order.price : price > order.price;
+}
+
+bool triggers(const Order &order, double price) {
+  return is_buy(order) ? price >= order.stop_price
+                       : price <= order.stop_price;
+}
+
+bool marketable(const Order &order, double price) {
+  return is_buy(order) ? price <= order.price : price >= order.price;
+}
+
+} // namespace
+
+bool bar_touches(const Order &order, const MarketState &market) {
+  switch (order.type) {
+  case OrderType::Market:
+    return true;
+  case OrderType::Limit:
+    return is_buy(order) ? market.low < order.price
+                         : market.high > order.price;
+  case OrderType::Stop:
+  case OrderType::StopLimit:
+    return is_buy(order) ? market.high >= order.stop_price
+                         : market.low <= order.stop_price;
+  }
+  return false;
+}
+
+HybridExecutionEngine::HybridExecutionEngine(TickCache &ticks,
+                                             FeeSchedule fees,
+                                             int64_t bar_duration,
+                                             PathModel path_model,
+                                             uint64_t seed)
+    : ticks_(ticks), fees_(fees), bar_duration_(bar_duration),
+      path_model_(path_model), rng_(seed, 0) {}
+
+std::vector<Fill>
+HybridExecutionEngine::execute(const std::vector<Order> &orders,
+                               const MarketState &market) {
+  std::vector<Fill> fills;
+  auto &on_path = path_orders_;
+  on_path.clear();
+
+  for (const auto &order : orders) {
+    std::optional<Fill> fill;
+    if (order.type == OrderType::Market) {
+      fill = execute_market(order, market);
+    } else if (bar_touches(order, market)) {
+      auto ticks = ticks_.get(order.asset_id, market.timestamp,
+                              market.timestamp + bar_duration_);
+      if (ticks.empty()) {
+        on_path.push_back(order);
+      } else {
+        fill = resolve_on_ticks(order, market, ticks);
+      }
+    }
+    if (fill) {
+      fills.push_back(*fill);
+    }
+  }
+
+  if (!on_path.empty()) {
+    const auto path = intrabar_path(market, path_model_, &rng_);
+    for (const auto &fill :
+         resolve_on_path(on_path, path, market, bar_duration_, fees_)) {
+      fills.push_back(fill);
+    }
+    if (ambiguous_ != nullptr && is_ambiguous(on_path, market)) {
+      ambiguous_->push_back(AmbiguousBar{market, on_path});
+    }
+  }
+
+  std::stable_sort(fills.begin(), fills.end(),
+                   [](const Fill &a, const Fill &b) {
+                     return a.timestamp < b.timestamp;
+                   });
+  return fills;
+}
+
+Fill HybridExecutionEngine::make_fill(const Order &order, double price,
+                                      int64_t timestamp, bool maker) const {
+  Fill fill{};
+  fill.order_id = order.id;
+  fill.asset_id = order.asset_id;
+  fill.venue_id = order.venue_id;
+  fill.price = price;
+  fill.size = order.size;
+  fill.fee = order.size * price * (maker ? fees_.maker : fees_.taker);
+  fill.timestamp = timestamp;
+  fill.maker = maker;
+  return fill;
+}
+
+std::optional<Fill>
+HybridExecutionEngine::execute_market(const Order &order,
+                                      const MarketState &market) const {
+  double price = is_buy(order) ? market.ask : market.bid;
+  if (price <= 0.0) {
+    price = market.open;
+  }
+  return make_fill(order, price, market.timestamp, false);
+}
+
+std::optional<Fill>
+HybridExecutionEngine::resolve_on_ticks(const Order &order,
+                                        const MarketState &market,
+                                        std::span<const Tick> ticks) const {
+  size_t i = 0;
+
+  if (order.type == OrderType::Stop || order.type == OrderType::StopLimit) {
+    while (i < ticks.size() && !triggers(order, ticks[i].price)) {
+      ++i;
+    }
+    if (i == ticks.size()) {
+      return std::nullopt;
+    }
+    if (order.type == OrderType::Stop) {
+      return make_fill(order, ticks[i].price, ticks[i].timestamp, false);
+    }
+    // Stop-limit: marketable at the trigger print, otherwise it rests.
+    if (marketable(order, ticks[i].price)) {
+      return make_fill(order, ticks[i].price, ticks[i].timestamp, false);
+    }
+    ++i;
+  } else if (submitted_in(order, market) &&
+             marketable(order, ticks[0].price)) {
+    // A new limit already through the market takes liquidity at the first
+    // print, like a market order. One resting from earlier bars is traded
+    // through below and fills at its limit as maker.
+    return make_fill(order, ticks[0].price, ticks[0].timestamp, false);
+  }
+
+  for (; i < ticks.size(); ++i) {
+    if (trades_through(order, ticks[i].price)) {
+      return make_fill(order, order.price, ticks[i].timestamp, true);
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace ctrade
@@ -0,0 +1,156 @@
+#include "ctrade/impact.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Power-law kernel as a Laplace mixture:
+//   (1 + t/tau)^-b = 1/Gamma(b) * integral s^b e^-s e^(-s t/tau) d(ln s),
+// discretized on a geometric grid of s.
+constexpr double kGridTop = 2.5;
+constexpr double kGridStep = 1.5;
+
+MarketState shifted(const MarketState &market, double pressure) {
+  const double scale = 1.0 + pressure;
+  MarketState out = market;
+  out.open *= scale;
+  out.high *= scale;
+  out.low *= scale;
+  out.close *= scale;
+  out.bid *= scale;
+  out.ask *= scale;
+  out.mid *= scale;
+  out.mark_price *= scale;
+  return out;
+}
+
+} // namespace
+
+// ---- ImpactModel ----
+
+ImpactModel::ImpactModel(ImpactConfig config) : config_(config) {
+  if (config_.timescale <= 0.0 || config_.volume_scale <= 0.0) {
+    throw std::invalid_argument("ImpactModel: scales must be positive");
+  }
+
+  if (config_.decay == ImpactDecay::Exponential) {
+    terms_ = 1;
+    weights_[0] = 1.0;
+    rates_[0] = std::log(2.0) / config_.timescale;
+    return;
+  }
+
+  const double b = config_.decay_exponent;
+  if (b <= 0.0) {
+    throw std::invalid_argument("ImpactModel: decay_exponent must be > 0");
+  }
+  terms_ = kMaxTerms;
+  double total = 0.0;
+  for (size_t k = 0; k < terms_; ++k) {
+    const double s = std::exp(kGridTop - kGridStep * static_cast<double>(k));
+    weights_[k] = std::pow(s, b) * std::exp(-s);
+    rates_[k] = s / config_.timescale;
+    total += weights_[k];
+  }
+  // Normalize so G(0) = 1 exactly.
+  for (size_t k = 0; k < terms_; ++k) {
+    weights_[k] /= total;
+  }
+}
+
+double ImpactModel::instantaneous(double signed_size) const {
+  if (signed_size == 0.0) {
+    return 0.0;
+  }
+  const double magnitude =
+      config_.coefficient *
+      std::pow(std::abs(signed_size) / config_.volume_scale, config_.exponent);
+  return signed_size > 0.0 ? magnitude : -magnitude;
+}
+
+double ImpactModel::kernel(int64_t elapsed) const {
+  double g = 0.0;
+  for (size_t k = 0; k < terms_; ++k) {
+    g += weights_[k] * std::exp(-rates_[k] * static_cast<double>(elapsed));
+  }
+  return g;
+}
+
+ImpactModel::State &ImpactModel::decay_to(int asset_id, int64_t timestamp) {
+  if (asset_id < 0) {
+    throw std::out_of_range("ImpactModel: negative asset id");
+  }
+  const auto index = static_cast<size_t>(asset_id);
+  if (index >= states_.size()) {
+    states_.resize(index + 1);
+  }
+
+  auto &state = states_[index];
+  const int64_t elapsed = timestamp - state.timestamp;
+  if (elapsed > 0) {
+    for (size_t k = 0; k < terms_; ++k) {
+      state.components[k] *=
+          std::exp(-rates_[k] * static_cast<double>(elapsed));
+    }
+    state.timestamp = timestamp;
+  }
+  return state;
+}
+
+double ImpactModel::pressure(int asset_id, int64_t timestamp) {
+  const auto &state = decay_to(asset_id, timestamp);
+  double total = 0.0;
+  for (size_t k = 0; k < terms_; ++k) {
+    total += state.components[k];
+  }
+  return total;
+}
+
+void ImpactModel::add(int asset_id, int64_t timestamp, double signed_size) {
+  auto &state = decay_to(asset_id, timestamp);
+  const double impact = instantaneous(signed_size);
+  for (size_t k = 0; k < terms_; ++k) {
+    state.components[k] += weights_[k] * impact;
+  }
+}
+
+// ---- ImpactExecutionEngine ----
+
+ImpactExecutionEngine::ImpactExecutionEngine(ExecutionEngine &inner,
+                                             ImpactConfig config)
+    : inner_(inner), model_(config) {}
+
+std::vector<Fill> ImpactExecutionEngine::execute(
+    const std::vector<Order> &orders, const MarketState &market) {
+  const double at_open = model_.pressure(market.asset_id, market.timestamp);
+  auto fills = inner_.execute(
+      orders, at_open == 0.0 ? market : shifted(market, at_open));
+
+  for (auto &fill : fills) {
+    auto order =
+        std::find_if(orders.begin(), orders.end(),
+                     [&](const Order &o) { return o.id == fill.order_id; });
+    if (order == orders.end()) {
+      continue;
+    }
+    const double signed_size =
+        order->side == Side::Buy ? fill.size : -fill.size;
+
+    if (!fill.maker) {
+      // Replace the bar-open pressure with the pressure at fill time and
+      // pay for crossing with our own size.
+      const double now = model_.pressure(fill.asset_id, fill.timestamp);
+      const double scale = (1.0 + now) / (1.0 + at_open) *
+                           (1.0 + model_.instantaneous(signed_size));
+      fill.price *= scale;
+      fill.fee *= scale;
+    }
+    model_.add(fill.asset_id, fill.timestamp, signed_size);
+  }
+  return fills;
+}
+
+} // namespace ctrade
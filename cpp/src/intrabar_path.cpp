@@ -0,0 +1,251 @@
+#include "ctrade/intrabar_path.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+constexpr int kBridgeSteps = 32;
+
+bool is_buy(const Order &order) { return order.side == Side::Buy; }
+
+// True if the high comes before the low on a Brownian bridge pinned to the
+// bar's open and close.
+bool bridge_high_first(const MarketState &bar, CounterRng &rng) {
+  const double range = std::max(bar.high - bar.low, 1e-12);
+  const double sigma = range / std::sqrt(static_cast<double>(kBridgeSteps));
+
+  std::array<double, kBridgeSteps + 1> walk{};
+  for (int i = 1; i <= kBridgeSteps; ++i) {
+    walk[i] = walk[i - 1] + sigma * rng.normal();
+  }
+
+  const double drift = walk[kBridgeSteps] - (bar.close - bar.open);
+  int argmax = 0;
+  int argmin = 0;
+  double max_value = 0.0;
+  double min_value = 0.0;
+  for (int i = 1; i <= kBridgeSteps; ++i) {
+    const double t = static_cast<double>(i) / kBridgeSteps;
+    const double b = walk[i] - t * drift;
+    if (b > max_value) {
+      max_value = b;
+      argmax = i;
+    }
+    if (b < min_value) {
+      min_value = b;
+      argmin = i;
+    }
+  }
+  return argmax <= argmin;
+}
+
+// Position in [0, n_segments] where the path first satisfies `hit`, found
+// per segment by linear interpolation toward `level`.
+template <typename Hit>
+std::optional<double> first_hit(std::span<const double> path, double level,
+                                double from, Hit hit) {
+  const size_t segments = path.size() - 1;
+  size_t seg = static_cast<size_t>(from);
+  if (seg >= segments) {
+    return std::nullopt;
+  }
+
+  double frac = from - static_cast<double>(seg);
+  for (; seg < segments; ++seg, frac = 0.0) {
+    const double a = path[seg];
+    const double b = path[seg + 1];
+    const double start = a + (b - a) * frac;
+    if (hit(start)) {
+      return static_cast<double>(seg) + frac;
+    }
+    if (hit(b)) {
+      const double t = b != a ? (level - a) / (b - a) : 1.0;
+      return static_cast<double>(seg) + std::clamp(t, frac, 1.0);
+    }
+  }
+  return std::nullopt;
+}
+
+struct PathFill {
+  double pos;
+  Fill fill;
+};
+
+std::optional<PathFill> resolve_order(const Order &order,
+                                      std::span<const double> path,
+                                      const MarketState &bar,
+                                      int64_t bar_duration, FeeSchedule fees) {
+  const bool buy = is_buy(order);
+  // Resting limits fill only when the path trades through them, the same
+  // rule as bar_touches and the tick resolver.
+  auto trades_through = [buy](double level) {
+    return [buy, level](double p) { return buy ? p < level : p > level; };
+  };
+  auto triggers = [buy](double level) {
+    return [buy, level](double p) { return buy ? p >= level : p <= level; };
+  };
+
+  std::optional<double> pos;
+  double price = 0.0;
+  bool maker = false;
+
+  switch (order.type) {
+  case OrderType::Market:
+    pos = 0.0;
+    price = path.front();
+    break;
+  case OrderType::Limit:
+    // A new limit already through the market takes liquidity at the open.
+    if (submitted_in(order, bar) &&
+        (buy ? path.front() <= order.price : path.front() >= order.price)) {
+      pos = 0.0;
+      price = path.front();
+      break;
+    }
+    pos = first_hit(path, order.price, 0.0, trades_through(order.price));
+    price = order.price;
+    maker = true;
+    break;
+  case OrderType::Stop:
+  case OrderType::StopLimit: {
+    pos = first_hit(path, order.stop_price, 0.0, triggers(order.stop_price));
+    if (!pos) {
+      break;
+    }
+    // Gaps through the trigger fill at the open.
+    price = *pos == 0.0 ? path.front() : order.stop_price;
+    if (order.type == OrderType::Stop) {
+      break;
+    }
+    const bool marketable = buy ? price <= order.price : price >= order.price;
+    if (!marketable) {
+      pos = first_hit(path, order.price, *pos, trades_through(order.price));
+      price = order.price;
+      maker = true;
+    }
+    break;
+  }
+  }
+
+  if (!pos) {
+    return std::nullopt;
+  }
+
+  const double segments = static_cast<double>(path.size() - 1);
+  Fill fill{};
+  fill.order_id = order.id;
+  fill.asset_id = order.asset_id;
+  fill.venue_id = order.venue_id;
+  fill.price = price;
+  fill.size = order.size;
+  fill.fee = order.size * price * (maker ? fees.maker : fees.taker);
+  fill.timestamp =
+      bar.timestamp + static_cast<int64_t>(*pos / segments *
+                                           static_cast<double>(bar_duration));
+  fill.maker = maker;
+  return PathFill{*pos, fill};
+}
+
+} // namespace
+
+std::vector<double> intrabar_path(const MarketState &bar, PathModel model,
+                                  CounterRng *rng) {
+  bool high_first = true;
+  switch (model) {
+  case PathModel::OHLC:
+    high_first = true;
+    break;
+  case PathModel::OLHC:
+    high_first = false;
+    break;
+  case PathModel::NearestFirst:
+    high_first = bar.high - bar.open <= bar.open - bar.low;
+    break;
+  case PathModel::BrownianBridge:
+    if (rng == nullptr) {
+      throw std::invalid_argument("intrabar_path: BrownianBridge needs rng");
+    }
+    high_first = bridge_high_first(bar, *rng);
+    break;
+  }
+
+  if (high_first) {
+    return {bar.open, bar.high, bar.low, bar.close};
+  }
+  return {bar.open, bar.low, bar.high, bar.close};
+}
+
+bool submitted_in(const Order &order, const MarketState &bar) {
+  return order.timestamp >= bar.timestamp;
+}
+
+std::vector<Fill> resolve_on_path(std::span<const Order> orders,
+                                  std::span<const double> path,
+                                  const MarketState &bar,
+                                  int64_t bar_duration, FeeSchedule fees) {
+  std::vector<PathFill> hits;
+  if (path.size() >= 2) {
+    for (const auto &order : orders) {
+      if (auto hit = resolve_order(order, path, bar, bar_duration, fees)) {
+        hits.push_back(*hit);
+      }
+    }
+  }
+  std::stable_sort(hits.begin(), hits.end(),
+                   [](const PathFill &a, const PathFill &b) {
+                     return a.pos < b.pos;
+                   });
+
+  std::vector<Fill> fills;
+  fills.reserve(hits.size());
+  for (const auto &hit : hits) {
+    fills.push_back(hit.fill);
+  }
+  return fills;
+}
+
+bool is_ambiguous(std::span<const Order> touched, const MarketState &bar) {
+  bool above = false;
+  bool below = false;
+  for (const auto &order : touched) {
+    if (order.type == OrderType::Market) {
+      continue;
+    }
+    const double level =
+        order.type == OrderType::Limit ? order.price : order.stop_price;
+    above = above || level > bar.open;
+    below = below || level < bar.open;
+  }
+  return above && below;
+}
+
+std::vector<double> sample_ambiguous_paths(std::span<const AmbiguousBar> bars,
+                                           size_t n_samples,
+                                           const PathOutcomeFn &evaluate,
+                                           int64_t bar_duration,
+                                           FeeSchedule fees,
+                                           const SweepConfig &config) {
+  std::vector<double> outcomes(n_samples);
+
+  parallel_for(n_samples, config.threads, [&](size_t sample, unsigned) {
+    CounterRng rng(config.seed, sample);
+    std::vector<std::vector<Fill>> fills(bars.size());
+
+    for (size_t b = 0; b < bars.size(); ++b) {
+      const auto &bar = bars[b].bar;
+      const auto path = intrabar_path(bar, PathModel::BrownianBridge, &rng);
+      fills[b] = resolve_on_path(bars[b].orders, path, bar, bar_duration, fees);
+    }
+    outcomes[sample] = evaluate(fills);
+  });
+
+  return outcomes;
+}
+
+} // namespace ctrade
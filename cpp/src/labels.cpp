@@ -0,0 +1,183 @@
+#include "ctrade/labels.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ctrade {
+
+namespace {
+
+// Bars per high/low extremum; a window skips a chunk that cannot touch.
+constexpr size_t kChunk = 64;
+
+// Bars per parallel task.
+constexpr size_t kTaskBars = size_t{1} << 16;
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+struct Extrema {
+  std::vector<double> max_high;
+  std::vector<double> min_low;
+};
+
+// (job, first bar) for every task over every job.
+std::vector<std::pair<size_t, size_t>>
+tasks_for(std::span<const LabelJob> jobs) {
+  std::vector<std::pair<size_t, size_t>> tasks;
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    for (size_t begin = 0; begin < jobs[j].bars->size(); begin += kTaskBars) {
+      tasks.emplace_back(j, begin);
+    }
+  }
+  return tasks;
+}
+
+void fill_extrema(const BarStore &bars, Extrema &extrema, size_t begin,
+                  size_t end) {
+  const auto high = bars.high();
+  const auto low = bars.low();
+  for (size_t c = begin / kChunk; c * kChunk < end; ++c) {
+    double hi = -kInf;
+    double lo = kInf;
+    const size_t stop = std::min(bars.size(), (c + 1) * kChunk);
+    for (size_t i = c * kChunk; i < stop; ++i) {
+      hi = std::max(hi, high[i]);
+      lo = std::min(lo, low[i]);
+    }
+    extrema.max_high[c] = hi;
+    extrema.min_low[c] = lo;
+  }
+}
+
+void label_range(const LabelJob &job, const Extrema &extrema,
+                 const TripleBarrierConfig &config, BarrierLabels &out,
+                 size_t begin, size_t end) {
+  const BarStore &bars = *job.bars;
+  const size_t n = bars.size();
+  const auto high = bars.high();
+  const auto low = bars.low();
+  const auto close = bars.close();
+
+  for (size_t i = begin; i < end; ++i) {
+    const double entry = close[i];
+    const double scale = job.scale.empty() ? 1.0 : job.scale[i];
+    const double upper =
+        config.take_profit > 0.0 ? entry * (1.0 + config.take_profit * scale)
+                                 : kInf;
+    const double lower =
+        config.stop_loss > 0.0 ? entry * (1.0 - config.stop_loss * scale)
+                               : -kInf;
+    const size_t last = i + config.max_holding;
+    const size_t stop = std::min(last, n - 1);
+
+    int8_t label = 0;
+    size_t exit = n;
+    for (size_t j = i + 1; j <= stop;) {
+      if (j % kChunk == 0 && j + kChunk - 1 <= stop) {
+        const size_t c = j / kChunk;
+        if (extrema.max_high[c] < upper && extrema.min_low[c] > lower) {
+          j += kChunk;
+          continue;
+        }
+      }
+      if (low[j] <= lower) {
+        label = -1;
+        exit = j;
+        break;
+      }
+      if (high[j] >= upper) {
+        label = 1;
+        exit = j;
+        break;
+      }
+      ++j;
+    }
+
+    double ret = kNaN;
+    if (label > 0) {
+      ret = upper / entry - 1.0;
+    } else if (label < 0) {
+      ret = lower / entry - 1.0;
+    } else if (last < n) {
+      exit = last;
+      ret = close[last] / entry - 1.0;
+    }
+    out.label[i] = label;
+    out.ret[i] = ret;
+    out.exit[i] = exit;
+  }
+}
+
+} // namespace
+
+std::vector<std::vector<double>>
+forward_returns(const BarStore &bars, std::span<const size_t> horizons,
+                unsigned threads) {
+  const size_t n = bars.size();
+  const auto close = bars.close();
+  std::vector<std::vector<double>> out(horizons.size(),
+                                       std::vector<double>(n, kNaN));
+  const size_t tasks_per = (n + kTaskBars - 1) / kTaskBars;
+  parallel_for(horizons.size() * tasks_per, threads, [&](size_t t, unsigned) {
+    const size_t h = horizons[t / tasks_per];
+    const size_t begin = t % tasks_per * kTaskBars;
+    const size_t end = std::min(n, begin + kTaskBars);
+    auto &column = out[t / tasks_per];
+    // Branch-free over the bars that have a horizon, so it vectorizes.
+    const size_t full = n > h ? std::min(end, n - h) : begin;
+    for (size_t i = begin; i < full; ++i) {
+      column[i] = close[i + h] / close[i] - 1.0;
+    }
+  });
+  return out;
+}
+
+BarrierLabels triple_barrier_labels(const BarStore &bars,
+                                    const TripleBarrierConfig &config,
+                                    std::span<const double> scale,
+                                    unsigned threads) {
+  const LabelJob job{&bars, scale};
+  return std::move(
+      triple_barrier_labels(std::span<const LabelJob>(&job, 1), config,
+                            threads)
+          .front());
+}
+
+std::vector<BarrierLabels>
+triple_barrier_labels(std::span<const LabelJob> jobs,
+                      const TripleBarrierConfig &config, unsigned threads) {
+  std::vector<Extrema> extrema(jobs.size());
+  std::vector<BarrierLabels> out(jobs.size());
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    const size_t n = jobs[j].bars->size();
+    if (!jobs[j].scale.empty() && jobs[j].scale.size() != n) {
+      throw std::invalid_argument(
+          "triple_barrier_labels: scale needs one value per bar");
+    }
+    const size_t chunks = (n + kChunk - 1) / kChunk;
+    extrema[j].max_high.resize(chunks);
+    extrema[j].min_low.resize(chunks);
+    out[j].label.resize(n);
+    out[j].ret.resize(n);
+    out[j].exit.resize(n);
+  }
+
+  // Task boundaries are multiples of kChunk, so tasks fill disjoint chunks.
+  const auto tasks = tasks_for(jobs);
+  parallel_for(tasks.size(), threads, [&](size_t t, unsigned) {
+    const auto [j, begin] = tasks[t];
+    const size_t end = std::min(jobs[j].bars->size(), begin + kTaskBars);
+    fill_extrema(*jobs[j].bars, extrema[j], begin, end);
+  });
+  parallel_for(tasks.size(), threads, [&](size_t t, unsigned) {
+    const auto [j, begin] = tasks[t];
+    const size_t end = std::min(jobs[j].bars->size(), begin + kTaskBars);
+    label_range(jobs[j], extrema[j], config, out[j], begin, end);
+  });
+  return out;
+}
+
+} // namespace ctrade
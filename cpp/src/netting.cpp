@@ -0,0 +1,200 @@
+#include "ctrade/netting.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Fills within this fraction of the order size complete it.
+constexpr double kSizeEpsilon = 1e-12;
+
+struct Leg {
+  size_t strategy;
+  int64_t order_id;
+  double size;
+};
+
+struct Netted {
+  std::vector<Leg> buys;
+  std::vector<Leg> sells;
+  double buy_total = 0.0;
+  double sell_total = 0.0;
+};
+
+} // namespace
+
+// ---- OrderNetter ----
+
+OrderNetter::OrderNetter(size_t n_strategies) : n_strategies_(n_strategies) {}
+
+int64_t OrderNetter::submit(size_t strategy, Order order) {
+  if (strategy >= n_strategies_) {
+    throw std::out_of_range("OrderNetter::submit: strategy out of range");
+  }
+  if (order.size <= 0.0) {
+    throw std::invalid_argument("OrderNetter::submit: size must be positive");
+  }
+  order.id = next_id_++;
+  pending_.emplace_back(strategy, order);
+  ++stats_.orders_in;
+  return order.id;
+}
+
+std::vector<Order> OrderNetter::net(std::span<const double> prices,
+                                    int64_t timestamp,
+                                    std::vector<StrategyFill> &crossed) {
+  std::map<std::pair<int, int>, Netted> groups; // by (venue, asset)
+  std::vector<Order> passed;
+  for (const auto &[strategy, order] : pending_) {
+    if (order.type != OrderType::Market) {
+      routed_[order.id] = {order.side, order.size,
+                           {{strategy, order.id, 1.0}}};
+      passed.push_back(order);
+      continue;
+    }
+    if (order.asset_id < 0 ||
+        static_cast<size_t>(order.asset_id) >= prices.size()) {
+      throw std::out_of_range("OrderNetter::net: asset has no price");
+    }
+    auto &group = groups[{order.venue_id, order.asset_id}];
+    const Leg leg{strategy, order.id, order.size};
+    if (order.side == Side::Buy) {
+      group.buys.push_back(leg);
+      group.buy_total += order.size;
+    } else {
+      group.sells.push_back(leg);
+      group.sell_total += order.size;
+    }
+  }
+  pending_.clear();
+
+  std::vector<Order> out;
+  for (const auto &[key, group] : groups) {
+    const auto [venue_id, asset_id] = key;
+    const double matched = std::min(group.buy_total, group.sell_total);
+
+    // Every leg crosses the same fraction of its side.
+    auto cross = [&](const std::vector<Leg> &legs, double total, Side side) {
+      if (matched <= 0.0) {
+        return;
+      }
+      const double ratio = matched == total ? 1.0 : matched / total;
+      for (const auto &leg : legs) {
+        Fill fill{};
+        fill.order_id = leg.order_id;
+        fill.asset_id = asset_id;
+        fill.venue_id = venue_id;
+        fill.price = prices[asset_id];
+        fill.size = leg.size * ratio;
+        fill.timestamp = timestamp;
+        crossed.push_back({leg.strategy, side, fill});
+      }
+    };
+    cross(group.buys, group.buy_total, Side::Buy);
+    cross(group.sells, group.sell_total, Side::Sell);
+    stats_.crossed_size += matched;
+
+    const bool buy = group.buy_total > group.sell_total;
+    const double total = buy ? group.buy_total : group.sell_total;
+    const double remainder = total - matched;
+    if (remainder <= kSizeEpsilon * total) {
+      continue;
+    }
+
+    Order order{};
+    order.id = next_id_++;
+    order.asset_id = asset_id;
+    order.venue_id = venue_id;
+    order.side = buy ? Side::Buy : Side::Sell;
+    order.type = OrderType::Market;
+    order.size = remainder;
+    order.timestamp = timestamp;
+
+    Routed routed{order.side, remainder, {}};
+    for (const auto &leg : buy ? group.buys : group.sells) {
+      routed.shares.push_back({leg.strategy, leg.order_id, leg.size / total});
+    }
+    routed_[order.id] = std::move(routed);
+    out.push_back(order);
+  }
+
+  out.insert(out.end(), passed.begin(), passed.end());
+  stats_.orders_out += out.size();
+  return out;
+}
+
+std::vector<StrategyFill> OrderNetter::attribute(std::span<const Fill> fills) {
+  std::vector<StrategyFill> out;
+  for (const auto &fill : fills) {
+    auto it = routed_.find(fill.order_id);
+    if (it == routed_.end()) {
+      throw std::invalid_argument("OrderNetter::attribute: unknown order id");
+    }
+    auto &routed = it->second;
+    for (const auto &share : routed.shares) {
+      Fill part = fill;
+      part.order_id = share.order_id;
+      part.size = fill.size * share.fraction;
+      part.fee = fill.fee * share.fraction;
+      out.push_back({share.strategy, routed.side, part});
+    }
+    const double size = routed.remaining + fill.size;
+    routed.remaining -= fill.size;
+    if (routed.remaining <= kSizeEpsilon * size) {
+      routed_.erase(it);
+    }
+  }
+  return out;
+}
+
+// ---- StrategyBook ----
+
+StrategyBook::StrategyBook(std::span<const double> initial_cash,
+                           size_t n_assets)
+    : n_assets_(n_assets), cash_(initial_cash.begin(), initial_cash.end()),
+      fees_(initial_cash.size(), 0.0),
+      position_(initial_cash.size() * n_assets, 0.0) {}
+
+size_t StrategyBook::slot(size_t strategy, int asset_id) const {
+  if (strategy >= cash_.size() || asset_id < 0 ||
+      static_cast<size_t>(asset_id) >= n_assets_) {
+    throw std::out_of_range("StrategyBook: strategy or asset out of range");
+  }
+  return strategy * n_assets_ + static_cast<size_t>(asset_id);
+}
+
+double StrategyBook::position(size_t strategy, int asset_id) const {
+  return position_[slot(strategy, asset_id)];
+}
+
+void StrategyBook::apply(const StrategyFill &fill) {
+  const size_t i = slot(fill.strategy, fill.fill.asset_id);
+  const double signed_size =
+      fill.side == Side::Buy ? fill.fill.size : -fill.fill.size;
+  cash_[fill.strategy] -= signed_size * fill.fill.price + fill.fill.fee;
+  fees_[fill.strategy] += fill.fill.fee;
+  position_[i] += signed_size;
+}
+
+double StrategyBook::equity(size_t strategy,
+                            std::span<const double> prices) const {
+  if (prices.size() != n_assets_) {
+    throw std::invalid_argument("StrategyBook::equity: one price per asset");
+  }
+  double equity = cash(strategy);
+  for (size_t a = 0; a < n_assets_; ++a) {
+    equity += position_[strategy * n_assets_ + a] * prices[a];
+  }
+  return equity;
+}
+
+double StrategyBook::total_equity(std::span<const double> prices) const {
+  double total = 0.0;
+  for (size_t s = 0; s < cash_.size(); ++s) {
+    total += equity(s, prices);
+  }
+  return total;
+}
+
+} // namespace ctrade
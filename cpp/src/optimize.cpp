@@ -0,0 +1,625 @@
+#include "ctrade/optimize.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+constexpr double kWorst = -std::numeric_limits<double>::infinity();
+
+// The optimizer's own draws use a stream no run index can reach.
+constexpr uint64_t kOptimizerStream = std::numeric_limits<uint64_t>::max();
+
+double finite_or_worst(double score) {
+  return std::isfinite(score) ? score : kWorst;
+}
+
+// Indices sorted best first; the lower index wins ties.
+std::vector<size_t> rank_best_first(std::span<const double> scores) {
+  std::vector<size_t> order(scores.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return finite_or_worst(scores[a]) > finite_or_worst(scores[b]);
+  });
+  return order;
+}
+
+// ---- Random search ----
+
+class RandomSearch : public Optimizer {
+public:
+  RandomSearch(size_t dims, uint64_t seed)
+      : dims_(dims), rng_(seed, kOptimizerStream) {}
+
+  std::vector<std::vector<double>> ask(size_t n) override {
+    std::vector<std::vector<double>> points(n, std::vector<double>(dims_));
+    for (auto &point : points) {
+      for (auto &x : point) {
+        x = rng_.uniform();
+      }
+    }
+    return points;
+  }
+
+  void tell(std::span<const std::vector<double>>,
+            std::span<const double>) override {}
+
+private:
+  size_t dims_;
+  CounterRng rng_;
+};
+
+// ---- Sobol search ----
+
+class SobolSearch : public Optimizer {
+public:
+  explicit SobolSearch(size_t dims) : sequence_(dims) {}
+
+  std::vector<std::vector<double>> ask(size_t n) override {
+    std::vector<std::vector<double>> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      points.push_back(sequence_.next());
+    }
+    return points;
+  }
+
+  void tell(std::span<const std::vector<double>>,
+            std::span<const double>) override {}
+
+private:
+  SobolSequence sequence_;
+};
+
+// ---- CMA-ES ----
+
+// Eigendecomposition of a symmetric row-major matrix by cyclic Jacobi
+// rotations. On return `a` holds the eigenvalues on its diagonal and `v`
+// the eigenvectors as columns. Parameter dimensions are small, so O(n^3)
+// per sweep is cheap next to a backtest.
+void jacobi_eigen(std::vector<double> &a, std::vector<double> &v, size_t n) {
+  v.assign(n * n, 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    v[i * n + i] = 1.0;
+  }
+  for (int sweep = 0; sweep < 64; ++sweep) {
+    double off = 0.0;
+    for (size_t p = 0; p < n; ++p) {
+      for (size_t q = p + 1; q < n; ++q) {
+        off += a[p * n + q] * a[p * n + q];
+      }
+    }
+    if (off < 1e-30) {
+      return;
+    }
+    for (size_t p = 0; p < n; ++p) {
+      for (size_t q = p + 1; q < n; ++q) {
+        const double apq = a[p * n + q];
+        if (apq == 0.0) {
+          continue;
+        }
+        const double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+        const double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                         (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+        const double c = 1.0 / std::sqrt(t * t + 1.0);
+        const double s = t * c;
+        for (size_t k = 0; k < n; ++k) {
+          const double akp = a[k * n + p];
+          const double akq = a[k * n + q];
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+        }
+        for (size_t k = 0; k < n; ++k) {
+          const double apk = a[p * n + k];
+          const double aqk = a[q * n + k];
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+        }
+        for (size_t k = 0; k < n; ++k) {
+          const double vkp = v[k * n + p];
+          const double vkq = v[k * n + q];
+          v[k * n + p] = c * vkp - s * vkq;
+          v[k * n + q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+}
+
+// Hansen's (mu/mu_w, lambda)-CMA-ES in the unit cube. Samples are clamped
+// to the cube and the clamped points drive the update. Scores arrive in
+// batches of any size; a generation is consumed every `lambda` results.
+class CmaEs : public Optimizer {
+public:
+  CmaEs(size_t dims, size_t lambda, uint64_t seed)
+      : n_(dims), lambda_(std::max<size_t>(lambda, 4)), mu_(lambda_ / 2),
+        rng_(seed, kOptimizerStream), mean_(dims, 0.5), pc_(dims, 0.0),
+        ps_(dims, 0.0), cov_(dims * dims, 0.0), basis_(dims * dims, 0.0),
+        scale_(dims, 1.0) {
+    for (size_t i = 0; i < n_; ++i) {
+      cov_[i * n_ + i] = 1.0;
+      basis_[i * n_ + i] = 1.0;
+    }
+
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (size_t i = 0; i < mu_; ++i) {
+      const double w = std::log(static_cast<double>(mu_) + 0.5) -
+                       std::log(static_cast<double>(i + 1));
+      weights_.push_back(w);
+      sum += w;
+    }
+    for (auto &w : weights_) {
+      w /= sum;
+      sum_sq += w * w;
+    }
+    mu_eff_ = 1.0 / sum_sq;
+
+    const double n = static_cast<double>(n_);
+    cc_ = (4.0 + mu_eff_ / n) / (n + 4.0 + 2.0 * mu_eff_ / n);
+    cs_ = (mu_eff_ + 2.0) / (n + mu_eff_ + 5.0);
+    c1_ = 2.0 / ((n + 1.3) * (n + 1.3) + mu_eff_);
+    cmu_ = std::min(1.0 - c1_, 2.0 * (mu_eff_ - 2.0 + 1.0 / mu_eff_) /
+                                   ((n + 2.0) * (n + 2.0) + mu_eff_));
+    damps_ = 1.0 +
+             2.0 * std::max(0.0, std::sqrt((mu_eff_ - 1.0) / (n + 1.0)) - 1.0) +
+             cs_;
+    chi_n_ = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+  }
+
+  std::vector<std::vector<double>> ask(size_t count) override {
+    std::vector<std::vector<double>> points(count, std::vector<double>(n_));
+    std::vector<double> z(n_);
+    for (auto &point : points) {
+      for (auto &zi : z) {
+        zi = rng_.normal();
+      }
+      for (size_t i = 0; i < n_; ++i) {
+        double y = 0.0;
+        for (size_t j = 0; j < n_; ++j) {
+          y += basis_[i * n_ + j] * scale_[j] * z[j];
+        }
+        point[i] = std::clamp(mean_[i] + sigma_ * y, 0.0, 1.0);
+      }
+    }
+    return points;
+  }
+
+  void tell(std::span<const std::vector<double>> points,
+            std::span<const double> scores) override {
+    for (size_t i = 0; i < points.size(); ++i) {
+      pending_.push_back(points[i]);
+      pending_scores_.push_back(scores[i]);
+      if (pending_.size() == lambda_) {
+        update();
+        pending_.clear();
+        pending_scores_.clear();
+      }
+    }
+  }
+
+private:
+  void update() {
+    const auto order = rank_best_first(pending_scores_);
+    const std::vector<double> old_mean = mean_;
+    std::fill(mean_.begin(), mean_.end(), 0.0);
+    for (size_t k = 0; k < mu_; ++k) {
+      const auto &x = pending_[order[k]];
+      for (size_t i = 0; i < n_; ++i) {
+        mean_[i] += weights_[k] * x[i];
+      }
+    }
+
+    std::vector<double> step(n_);
+    for (size_t i = 0; i < n_; ++i) {
+      step[i] = (mean_[i] - old_mean[i]) / sigma_;
+    }
+
+    // ps <- (1 - cs) ps + sqrt(cs (2 - cs) mu_eff) C^{-1/2} step
+    std::vector<double> rotated(n_, 0.0);
+    for (size_t j = 0; j < n_; ++j) {
+      double bt = 0.0;
+      for (size_t i = 0; i < n_; ++i) {
+        bt += basis_[i * n_ + j] * step[i];
+      }
+      rotated[j] = bt / scale_[j];
+    }
+    const double ps_gain = std::sqrt(cs_ * (2.0 - cs_) * mu_eff_);
+    double ps_norm = 0.0;
+    for (size_t i = 0; i < n_; ++i) {
+      double whitened = 0.0;
+      for (size_t j = 0; j < n_; ++j) {
+        whitened += basis_[i * n_ + j] * rotated[j];
+      }
+      ps_[i] = (1.0 - cs_) * ps_[i] + ps_gain * whitened;
+      ps_norm += ps_[i] * ps_[i];
+    }
+    ps_norm = std::sqrt(ps_norm);
+
+    ++generation_;
+    const double n = static_cast<double>(n_);
+    const double hsig_denominator = std::sqrt(
+        1.0 - std::pow(1.0 - cs_, 2.0 * static_cast<double>(generation_)));
+    const bool hsig =
+        ps_norm / hsig_denominator / chi_n_ < 1.4 + 2.0 / (n + 1.0);
+
+    const double pc_gain = std::sqrt(cc_ * (2.0 - cc_) * mu_eff_);
+    for (size_t i = 0; i < n_; ++i) {
+      pc_[i] = (1.0 - cc_) * pc_[i] + (hsig ? pc_gain * step[i] : 0.0);
+    }
+
+    const double keep = 1.0 - c1_ - cmu_ +
+                        (hsig ? 0.0 : c1_ * cc_ * (2.0 - cc_));
+    for (size_t i = 0; i < n_; ++i) {
+      for (size_t j = 0; j < n_; ++j) {
+        double rank_mu = 0.0;
+        for (size_t k = 0; k < mu_; ++k) {
+          const auto &x = pending_[order[k]];
+          rank_mu += weights_[k] * (x[i] - old_mean[i]) *
+                     (x[j] - old_mean[j]) / (sigma_ * sigma_);
+        }
+        cov_[i * n_ + j] = keep * cov_[i * n_ + j] +
+                           c1_ * pc_[i] * pc_[j] + cmu_ * rank_mu;
+      }
+    }
+
+    sigma_ *= std::exp((cs_ / damps_) * (ps_norm / chi_n_ - 1.0));
+    sigma_ = std::clamp(sigma_, 1e-12, 1.0);
+
+    std::vector<double> eigen = cov_;
+    jacobi_eigen(eigen, basis_, n_);
+    for (size_t i = 0; i < n_; ++i) {
+      scale_[i] = std::sqrt(std::max(eigen[i * n_ + i], 1e-20));
+    }
+  }
+
+  size_t n_;
+  size_t lambda_;
+  size_t mu_;
+  CounterRng rng_;
+
+  std::vector<double> weights_;
+  double mu_eff_ = 0.0;
+  double cc_ = 0.0;
+  double cs_ = 0.0;
+  double c1_ = 0.0;
+  double cmu_ = 0.0;
+  double damps_ = 0.0;
+  double chi_n_ = 0.0;
+
+  std::vector<double> mean_;
+  double sigma_ = 0.3;
+  std::vector<double> pc_;
+  std::vector<double> ps_;
+  std::vector<double> cov_;   // row-major C
+  std::vector<double> basis_; // eigenvectors of C as columns
+  std::vector<double> scale_; // square roots of the eigenvalues of C
+  size_t generation_ = 0;
+
+  std::vector<std::vector<double>> pending_;
+  std::vector<double> pending_scores_;
+};
+
+// ---- TPE ----
+
+// Independent (per-dimension) tree-structured Parzen estimator. Trials are
+// split into the best quarter and the rest; each candidate is drawn from
+// the good density l(x) and the one maximizing l(x) / g(x) is suggested.
+class Tpe : public Optimizer {
+public:
+  Tpe(size_t dims, size_t batch_size, uint64_t seed)
+      : dims_(dims), startup_(std::max<size_t>(10, batch_size)),
+        rng_(seed, kOptimizerStream) {}
+
+  std::vector<std::vector<double>> ask(size_t n) override {
+    std::vector<std::vector<double>> points(n, std::vector<double>(dims_));
+    if (scores_.size() < startup_) {
+      for (auto &point : points) {
+        for (auto &x : point) {
+          x = rng_.uniform();
+        }
+      }
+      return points;
+    }
+
+    const auto order = rank_best_first(scores_);
+    const size_t n_good =
+        std::clamp<size_t>((order.size() + 3) / 4, size_t{1}, size_t{25});
+    std::vector<size_t> good(order.begin(), order.begin() + n_good);
+    std::vector<size_t> bad(order.begin() + n_good, order.end());
+
+    std::vector<Parzen> l(dims_);
+    std::vector<Parzen> g(dims_);
+    for (size_t d = 0; d < dims_; ++d) {
+      l[d] = fit(good, d);
+      g[d] = fit(bad, d);
+    }
+
+    std::vector<double> candidate(dims_);
+    for (auto &point : points) {
+      double best = kWorst;
+      for (size_t c = 0; c < kCandidates; ++c) {
+        double ratio = 0.0;
+        for (size_t d = 0; d < dims_; ++d) {
+          candidate[d] = sample(l[d]);
+          ratio += std::log(density(l[d], candidate[d])) -
+                   std::log(density(g[d], candidate[d]));
+        }
+        if (ratio > best) {
+          best = ratio;
+          point = candidate;
+        }
+      }
+    }
+    return points;
+  }
+
+  void tell(std::span<const std::vector<double>> points,
+            std::span<const double> scores) override {
+    for (size_t i = 0; i < points.size(); ++i) {
+      points_.push_back(points[i]);
+      scores_.push_back(scores[i]);
+    }
+  }
+
+private:
+  static constexpr size_t kCandidates = 24;
+
+  // Gaussian kernels at the observations, with a Scott's-rule bandwidth
+  // floored at 1 / sqrt(1 + trials) so the search narrows only as evidence
+  // accumulates, plus a unit-width prior at the centre of the cube.
+  struct Parzen {
+    std::vector<double> centers;
+    double bandwidth = 1.0;
+  };
+
+  static constexpr double kPriorCenter = 0.5;
+  static constexpr double kPriorWidth = 1.0;
+
+  Parzen fit(const std::vector<size_t> &trials, size_t d) const {
+    Parzen p;
+    double mean = 0.0;
+    for (size_t t : trials) {
+      p.centers.push_back(points_[t][d]);
+      mean += points_[t][d];
+    }
+    if (trials.empty()) {
+      return p;
+    }
+    const double m = static_cast<double>(trials.size());
+    mean /= m;
+    double var = 0.0;
+    for (double c : p.centers) {
+      var += (c - mean) * (c - mean);
+    }
+    const double sd = std::sqrt(var / m);
+    const double floor =
+        std::max(1.0 / std::sqrt(1.0 + static_cast<double>(scores_.size())),
+                 0.01);
+    p.bandwidth = std::clamp(1.06 * sd * std::pow(m, -0.2), floor, 0.5);
+    return p;
+  }
+
+  double sample(const Parzen &p) {
+    const size_t k = static_cast<size_t>(
+        rng_.uniform() * static_cast<double>(p.centers.size() + 1));
+    const bool prior = k >= p.centers.size();
+    const double center = prior ? kPriorCenter : p.centers[k];
+    const double width = prior ? kPriorWidth : p.bandwidth;
+    double x = center;
+    for (int attempt = 0; attempt < 16; ++attempt) {
+      x = center + width * rng_.normal();
+      if (x >= 0.0 && x <= 1.0) {
+        return x;
+      }
+    }
+    return std::clamp(x, 0.0, 1.0);
+  }
+
+  static double density(const Parzen &p, double x) {
+    const double prior = (x - kPriorCenter) / kPriorWidth;
+    double total = std::exp(-0.5 * prior * prior) / kPriorWidth;
+    for (double c : p.centers) {
+      const double z = (x - c) / p.bandwidth;
+      total += std::exp(-0.5 * z * z) / p.bandwidth;
+    }
+    return total / static_cast<double>(p.centers.size() + 1) + 1e-300;
+  }
+
+  size_t dims_;
+  size_t startup_;
+  CounterRng rng_;
+  std::vector<std::vector<double>> points_;
+  std::vector<double> scores_;
+};
+
+// Joe-Kuo (new-joe-kuo-6.21201) primitive polynomials and initial direction
+// numbers for dimensions 2..21; dimension 1 is van der Corput.
+struct SobolInit {
+  unsigned degree;
+  uint32_t coefficients;
+  std::array<uint32_t, 7> m;
+};
+
+constexpr SobolInit kSobolInit[] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+} // namespace
+
+// ---- Objectives ----
+
+Objective make_objective(ObjectiveKind kind) {
+  switch (kind) {
+  case ObjectiveKind::Sharpe:
+    return [](const RunSummary &s) { return s.sharpe; };
+  case ObjectiveKind::TotalReturn:
+    return [](const RunSummary &s) { return s.total_return; };
+  case ObjectiveKind::Calmar:
+    return [](const RunSummary &s) {
+      return s.max_drawdown > 0.0 ? s.total_return / s.max_drawdown
+                                  : s.total_return;
+    };
+  }
+  throw std::invalid_argument("make_objective: unknown objective");
+}
+
+// ---- SobolSequence ----
+
+SobolSequence::SobolSequence(size_t dims)
+    : dims_(dims), state_(dims, 0), directions_(dims) {
+  if (dims == 0 || dims > kMaxDims) {
+    throw std::invalid_argument("SobolSequence: dimensions must be in 1..21");
+  }
+  for (size_t k = 0; k < 32; ++k) {
+    directions_[0][k] = uint32_t{1} << (31 - k);
+  }
+  for (size_t d = 1; d < dims; ++d) {
+    const auto &init = kSobolInit[d - 1];
+    auto &v = directions_[d];
+    const unsigned s = init.degree;
+    for (unsigned k = 0; k < s; ++k) {
+      v[k] = init.m[k] << (31 - k);
+    }
+    for (unsigned k = s; k < 32; ++k) {
+      v[k] = v[k - s] ^ (v[k - s] >> s);
+      for (unsigned j = 1; j < s; ++j) {
+        if ((init.coefficients >> (s - 1 - j)) & 1u) {
+          v[k] ^= v[k - j];
+        }
+      }
+    }
+  }
+}
+
+std::vector<double> SobolSequence::next() {
+  if (index_ == std::numeric_limits<uint32_t>::max()) {
+    throw std::out_of_range("SobolSequence: sequence exhausted");
+  }
+  // Gray-code order: flip the direction of the lowest zero bit.
+  unsigned bit = 0;
+  while ((index_ >> bit) & 1u) {
+    ++bit;
+  }
+  ++index_;
+
+  std::vector<double> point(dims_);
+  for (size_t d = 0; d < dims_; ++d) {
+    state_[d] ^= directions_[d][bit];
+    point[d] = static_cast<double>(state_[d]) * 0x1p-32;
+  }
+  return point;
+}
+
+// ---- Optimizers ----
+
+std::unique_ptr<Optimizer> make_optimizer(OptimizerKind kind, size_t dims,
+                                          size_t batch_size, uint64_t seed) {
+  if (dims == 0) {
+    throw std::invalid_argument("make_optimizer: no dimensions");
+  }
+  switch (kind) {
+  case OptimizerKind::Random:
+    return std::make_unique<RandomSearch>(dims, seed);
+  case OptimizerKind::Sobol:
+    return std::make_unique<SobolSearch>(dims);
+  case OptimizerKind::CmaEs:
+    return std::make_unique<CmaEs>(dims, batch_size, seed);
+  case OptimizerKind::Tpe:
+    return std::make_unique<Tpe>(dims, batch_size, seed);
+  }
+  throw std::invalid_argument("make_optimizer: unknown optimizer");
+}
+
+OptimizeResult optimize(const std::vector<ParamBound> &bounds, const RunFn &run,
+                        const Objective &objective,
+                        const OptimizeConfig &config) {
+  if (bounds.empty()) {
+    throw std::invalid_argument("optimize: no parameters");
+  }
+  for (const auto &b : bounds) {
+    if (!(b.low <= b.high)) {
+      throw std::invalid_argument("optimize: bound low exceeds high");
+    }
+    if (b.integer && std::ceil(b.low) > std::floor(b.high)) {
+      throw std::invalid_argument("optimize: integer bound holds no integer");
+    }
+  }
+  if (config.batch_size == 0) {
+    throw std::invalid_argument("optimize: batch_size must be positive");
+  }
+  if (config.budget == 0) {
+    throw std::invalid_argument("optimize: budget must be positive");
+  }
+
+  auto optimizer = make_optimizer(config.kind, bounds.size(),
+                                  config.batch_size, config.sweep.seed);
+  OptimizeResult result;
+  result.trials.reserve(config.budget);
+
+  std::vector<ParamSet> params;
+  std::vector<RunSummary> summaries;
+  std::vector<double> scores;
+  while (result.trials.size() < config.budget) {
+    const size_t offset = result.trials.size();
+    const size_t n = std::min(config.batch_size, config.budget - offset);
+    const auto points = optimizer->ask(n);
+
+    params.assign(n, ParamSet(bounds.size()));
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t d = 0; d < bounds.size(); ++d) {
+        const auto &b = bounds[d];
+        double x = b.low + points[i][d] * (b.high - b.low);
+        if (b.integer) {
+          x = std::clamp(std::round(x), std::ceil(b.low), std::floor(b.high));
+        }
+        params[i][d] = x;
+      }
+    }
+
+    summaries.assign(n, RunSummary{});
+    parallel_for(n, config.sweep.threads, [&](size_t i, unsigned) {
+      CounterRng rng(config.sweep.seed, offset + i);
+      summaries[i] = summarize(run(params[i], rng));
+    });
+
+    // Objectives and the optimizer update run on the calling thread, in
+    // evaluation order.
+    scores.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      scores[i] = finite_or_worst(objective(summaries[i]));
+      result.trials.push_back({params[i], summaries[i], scores[i]});
+      if (scores[i] > result.trials[result.best_index].score) {
+        result.best_index = offset + i;
+      }
+    }
+    optimizer->tell(points, scores);
+  }
+  return result;
+}
+
+} // namespace ctrade
@@ -0,0 +1,204 @@
+#include "ctrade/order_book.hpp"
+#include <stdexcept>
+
+namespace ctrade {
+
+OrderBook::OrderBook(size_t capacity) {
+  slots_.reserve(capacity);
+  index_.reserve(capacity);
+}
+
+bool OrderBook::is_trigger(const Order &order) {
+  return order.type == OrderType::Stop || order.type == OrderType::StopLimit;
+}
+
+double OrderBook::working_price(const Order &order) {
+  return is_trigger(order) ? order.stop_price : order.price;
+}
+
+OrderBook::Levels &OrderBook::levels_for(const Order &order) {
+  if (is_trigger(order)) {
+    return order.side == Side::Buy ? buy_stops_ : sell_stops_;
+  }
+  return order.side == Side::Buy ? bids_ : asks_;
+}
+
+void OrderBook::link_back(uint32_t slot) {
+  auto &s = slots_[slot];
+  auto &level = levels_for(s.order)[working_price(s.order)];
+  s.prev = level.tail;
+  s.next = kNone;
+  if (level.tail != kNone) {
+    slots_[level.tail].next = slot;
+  } else {
+    level.head = slot;
+  }
+  level.tail = slot;
+}
+
+void OrderBook::unlink(uint32_t slot) {
+  auto &s = slots_[slot];
+  auto &levels = levels_for(s.order);
+  auto it = levels.find(working_price(s.order));
+  auto &level = it->second;
+
+  if (s.prev != kNone) {
+    slots_[s.prev].next = s.next;
+  } else {
+    level.head = s.next;
+  }
+  if (s.next != kNone) {
+    slots_[s.next].prev = s.prev;
+  } else {
+    level.tail = s.prev;
+  }
+  s.prev = s.next = kNone;
+
+  if (level.head == kNone) {
+    levels.erase(it);
+  }
+}
+
+void OrderBook::release(uint32_t slot) {
+  unlink(slot);
+  index_.erase(slots_[slot].order.id);
+  free_slots_.push_back(slot);
+}
+
+void OrderBook::add(const Order &order) {
+  if (order.type == OrderType::Market) {
+    throw std::invalid_argument("OrderBook: market orders do not rest");
+  }
+  if (index_.count(order.id) != 0) {
+    throw std::invalid_argument("OrderBook: duplicate order id");
+  }
+
+  uint32_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot].order = order;
+  } else {
+    slot = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(Slot{order});
+  }
+  index_.emplace(order.id, slot);
+  link_back(slot);
+}
+
+bool OrderBook::cancel(int64_t order_id) {
+  auto it = index_.find(order_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  release(it->second);
+  return true;
+}
+
+void OrderBook::clear() {
+  slots_.clear();
+  free_slots_.clear();
+  index_.clear();
+  bids_.clear();
+  asks_.clear();
+  buy_stops_.clear();
+  sell_stops_.clear();
+}
+
+bool OrderBook::amend(int64_t order_id, double new_size, double new_price) {
+  auto it = index_.find(order_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  const uint32_t slot = it->second;
+  if (new_size <= 0.0) {
+    release(slot);
+    return true;
+  }
+
+  // Plain stops amend their trigger, everything else its limit price.
+  auto &order = slots_[slot].order;
+  const double old_price =
+      order.type == OrderType::Stop ? order.stop_price : order.price;
+  const bool moves = new_price != old_price;
+  const bool grows = new_size > order.size;
+
+  if (moves || grows) {
+    unlink(slot);
+  }
+  order.size = new_size;
+  if (order.type == OrderType::Stop) {
+    order.stop_price = new_price;
+  } else {
+    order.price = new_price;
+  }
+  if (moves || grows) {
+    link_back(slot);
+  }
+  return true;
+}
+
+void OrderBook::apply_fills(std::span<const Fill> fills) {
+  for (const auto &fill : fills) {
+    auto it = index_.find(fill.order_id);
+    if (it == index_.end()) {
+      continue;
+    }
+    auto &order = slots_[it->second].order;
+    order.size -= fill.size;
+    if (order.size <= 0.0) {
+      release(it->second);
+    }
+  }
+}
+
+const Order *OrderBook::find(int64_t order_id) const {
+  auto it = index_.find(order_id);
+  return it == index_.end() ? nullptr : &slots_[it->second].order;
+}
+
+double OrderBook::queue_ahead(int64_t order_id) const {
+  auto it = index_.find(order_id);
+  if (it == index_.end()) {
+    throw std::out_of_range("OrderBook: unknown order id");
+  }
+  if (is_trigger(slots_[it->second].order)) {
+    return 0.0;
+  }
+  double ahead = 0.0;
+  for (uint32_t s = slots_[it->second].prev; s != kNone; s = slots_[s].prev) {
+    ahead += slots_[s].order.size;
+  }
+  return ahead;
+}
+
+void OrderBook::append(const Level &level, std::vector<Order> &out) const {
+  for (uint32_t s = level.head; s != kNone; s = slots_[s].next) {
+    out.push_back(slots_[s].order);
+  }
+}
+
+std::vector<Order> OrderBook::resting() const {
+  std::vector<Order> out;
+  out.reserve(index_.size());
+  for (auto it = bids_.rbegin(); it != bids_.rend(); ++it) {
+    append(it->second, out);
+  }
+  for (const auto &[price, level] : asks_) {
+    append(level, out);
+  }
+  return out;
+}
+
+std::vector<Order> OrderBook::stops() const {
+  std::vector<Order> out;
+  for (const auto &[price, level] : buy_stops_) {
+    append(level, out);
+  }
+  for (auto it = sell_stops_.rbegin(); it != sell_stops_.rend(); ++it) {
+    append(it->second, out);
+  }
+  return out;
+}
+
+} // namespace ctrade
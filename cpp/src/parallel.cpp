@@ -0,0 +1,63 @@
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ctrade {
+
+unsigned resolve_threads(unsigned threads) {
+  if (threads > 0) {
+    return threads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallel_for(size_t n, unsigned threads,
+                  const std::function<void(size_t, unsigned)> &fn) {
+  const unsigned workers = static_cast<unsigned>(
+      std::min<size_t>(resolve_threads(threads), n));
+  if (workers <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(i, 0);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&](unsigned worker) {
+    for (size_t i = next++; i < n && !failed; i = next++) {
+      try {
+        fn(i, worker);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (unsigned w = 1; w < workers; ++w) {
+    pool.emplace_back(work, w);
+  }
+  work(0);
+  for (auto &t : pool) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ctrade
@@ -0,0 +1,70 @@
+#include "ctrade/rebalancer.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Tolerates float noise such as 0.3 / 0.1 = 2.9999999999999996.
+constexpr double kLotEpsilon = 1e-9;
+
+double round_to_lot(double size, double lot_size) {
+  if (lot_size <= 0.0) {
+    return size;
+  }
+  return std::floor(size / lot_size + kLotEpsilon) * lot_size;
+}
+
+} // namespace
+
+std::vector<double> weights_to_positions(std::span<const double> weights,
+                                         std::span<const double> prices,
+                                         double equity) {
+  if (weights.size() != prices.size()) {
+    throw std::invalid_argument("weights_to_positions: size mismatch");
+  }
+
+  std::vector<double> positions(weights.size(), 0.0);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if (prices[i] > 0.0) {
+      positions[i] = weights[i] * equity / prices[i];
+    }
+  }
+  return positions;
+}
+
+std::vector<Order> rebalance_orders(std::span<const double> current,
+                                    std::span<const double> target,
+                                    std::span<const double> prices,
+                                    std::span<const InstrumentSpec> specs) {
+  const size_t n = current.size();
+  if (target.size() != n || prices.size() != n || specs.size() != n) {
+    throw std::invalid_argument("rebalance_orders: size mismatch");
+  }
+
+  std::vector<Order> orders;
+  for (size_t i = 0; i < n; ++i) {
+    const bool flatten = target[i] == 0.0 && current[i] != 0.0;
+    const double delta = target[i] - current[i];
+
+    double size = flatten ? std::fabs(current[i])
+                          : round_to_lot(std::fabs(delta), specs[i].lot_size);
+    if (size <= 0.0) {
+      continue;
+    }
+    if (!flatten && size * prices[i] < specs[i].min_notional) {
+      continue;
+    }
+
+    Order order{};
+    order.asset_id = static_cast<int>(i);
+    order.side = delta > 0.0 ? Side::Buy : Side::Sell;
+    order.type = OrderType::Market;
+    order.size = size;
+    orders.push_back(order);
+  }
+  return orders;
+}
+
+} // namespace ctrade
@@ -0,0 +1,230 @@
+#include "ctrade/risk.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace ctrade {
+
+EwmaCovariance::EwmaCovariance(size_t n_assets, double lambda)
+    : n_(n_assets), lambda_(lambda), cov_(n_assets * n_assets, 0.0),
+      last_close_(n_assets, 0.0), returns_(n_assets, 0.0) {
+  if (lambda <= 0.0 || lambda >= 1.0) {
+    throw std::invalid_argument("EwmaCovariance: lambda must be in (0, 1)");
+  }
+}
+
+void EwmaCovariance::update(std::span<const double> returns) {
+  if (returns.size() != n_) {
+    throw std::invalid_argument("EwmaCovariance: wrong number of returns");
+  }
+
+  const double lambda = lambda_;
+  const double *r = returns.data();
+  for (size_t i = 0; i < n_; ++i) {
+    const double a = (1.0 - lambda) * r[i];
+    double *row = cov_.data() + i * n_;
+    for (size_t j = 0; j < n_; ++j) {
+      row[j] = lambda * row[j] + a * r[j];
+    }
+  }
+  weight_ = lambda * weight_ + (1.0 - lambda);
+  ++observations_;
+}
+
+void EwmaCovariance::update(const AssetSlice &slice) {
+  if (slice.size() != n_) {
+    throw std::invalid_argument("EwmaCovariance: slice size mismatch");
+  }
+  bool any_priced = false;
+  for (size_t i = 0; i < n_; ++i) {
+    const double close = slice.close[i];
+    const bool priced = close > 0.0 && last_close_[i] > 0.0;
+    returns_[i] = priced ? std::log(close / last_close_[i]) : 0.0;
+    any_priced = any_priced || priced;
+    if (close > 0.0) {
+      last_close_[i] = close;
+    }
+  }
+  // The first slice only sets the reference prices.
+  if (any_priced) {
+    update(returns_);
+  }
+}
+
+double EwmaCovariance::covariance(size_t i, size_t j) const {
+  return weight_ > 0.0 ? cov_[i * n_ + j] / weight_ : 0.0;
+}
+
+std::vector<double> EwmaCovariance::matrix() const {
+  std::vector<double> out(cov_);
+  const double scale = weight_ > 0.0 ? 1.0 / weight_ : 0.0;
+  for (auto &c : out) {
+    c *= scale;
+  }
+  return out;
+}
+
+double EwmaCovariance::variance(std::span<const double> w) const {
+  if (w.size() != n_) {
+    throw std::invalid_argument("EwmaCovariance: wrong number of weights");
+  }
+  if (weight_ <= 0.0) {
+    return 0.0;
+  }
+  double total = 0.0;
+  for (size_t i = 0; i < n_; ++i) {
+    const double *row = cov_.data() + i * n_;
+    double row_dot = 0.0;
+    for (size_t j = 0; j < n_; ++j) {
+      row_dot += row[j] * w[j];
+    }
+    total += w[i] * row_dot;
+  }
+  return std::max(total / weight_, 0.0);
+}
+
+double EwmaCovariance::volatility(std::span<const double> w) const {
+  return std::sqrt(variance(w));
+}
+
+double EwmaCovariance::value_at_risk(std::span<const double> w,
+                                     double confidence) const {
+  if (confidence <= 0.0 || confidence >= 1.0) {
+    throw std::invalid_argument("value_at_risk: confidence not in (0, 1)");
+  }
+  return normal_quantile(confidence) * volatility(w);
+}
+
+std::span<const double> EwmaCovariance::risk_parity_weights(size_t max_sweeps,
+                                                            double tolerance) {
+  const double budget = n_ > 0 ? 1.0 / static_cast<double>(n_) : 0.0;
+  bool defined = true;
+  for (size_t i = 0; i < n_; ++i) {
+    defined = defined && cov_[i * n_ + i] > 0.0;
+  }
+  if (!defined) {
+    parity_.assign(n_, budget);
+    return parity_;
+  }
+
+  // Start from the previous solution, else inverse volatility.
+  if (parity_.size() != n_) {
+    parity_.resize(n_);
+    for (size_t i = 0; i < n_; ++i) {
+      parity_[i] = 1.0 / std::sqrt(cov_[i * n_ + i]);
+    }
+  }
+
+  // Scale so y' C y = 1, the fixed point's normalization.
+  cov_parity_.assign(n_, 0.0);
+  double quad = 0.0;
+  for (size_t i = 0; i < n_; ++i) {
+    const double *row = cov_.data() + i * n_;
+    for (size_t j = 0; j < n_; ++j) {
+      cov_parity_[i] += row[j] * parity_[j];
+    }
+    quad += parity_[i] * cov_parity_[i];
+  }
+  const double scale = quad > 0.0 ? 1.0 / std::sqrt(quad) : 1.0;
+  for (size_t i = 0; i < n_; ++i) {
+    parity_[i] *= scale;
+    cov_parity_[i] *= scale;
+  }
+
+  // Each coordinate solves y_i (C y)_i = budget for y_i > 0.
+  for (size_t sweep = 0; sweep < max_sweeps; ++sweep) {
+    double max_change = 0.0;
+    for (size_t i = 0; i < n_; ++i) {
+      const double *row = cov_.data() + i * n_;
+      const double cii = row[i];
+      const double others = cov_parity_[i] - cii * parity_[i];
+      const double y =
+          (-others + std::sqrt(others * others + 4.0 * cii * budget)) /
+          (2.0 * cii);
+      const double delta = y - parity_[i];
+      if (delta != 0.0) {
+        for (size_t j = 0; j < n_; ++j) {
+          cov_parity_[j] += delta * row[j];
+        }
+        parity_[i] = y;
+        max_change = std::max(max_change, std::abs(delta) / y);
+      }
+    }
+    if (max_change < tolerance) {
+      break;
+    }
+  }
+
+  const double total = std::accumulate(parity_.begin(), parity_.end(), 0.0);
+  for (auto &w : parity_) {
+    w /= total;
+  }
+  return parity_;
+}
+
+void EwmaCovariance::save(SnapshotWriter &out) const {
+  out.u64(n_);
+  out.f64(lambda_);
+  out.f64(weight_);
+  out.u64(observations_);
+  out.f64s(cov_);
+  out.f64s(last_close_);
+  out.f64s(parity_);
+}
+
+void EwmaCovariance::load(SnapshotReader &in) {
+  if (in.u64() != n_ || in.f64() != lambda_) {
+    throw std::runtime_error("EwmaCovariance: snapshot shape mismatch");
+  }
+  weight_ = in.f64();
+  observations_ = in.u64();
+  cov_ = in.f64s();
+  last_close_ = in.f64s();
+  parity_ = in.f64s();
+  if (cov_.size() != n_ * n_ || last_close_.size() != n_ ||
+      (!parity_.empty() && parity_.size() != n_)) {
+    throw std::runtime_error("EwmaCovariance: corrupt snapshot");
+  }
+}
+
+double normal_quantile(double p) {
+  if (p <= 0.0 || p >= 1.0) {
+    throw std::invalid_argument("normal_quantile: p not in (0, 1)");
+  }
+
+  // Acklam's rational approximation (relative error < 1.2e-9).
+  static constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                                 -2.759285104469687e+02, 1.383577518672690e+02,
+                                 -3.066479806614716e+01, 2.506628277459239e+00};
+  static constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                                 -1.556989798598866e+02, 6.680131188771972e+01,
+                                 -1.328068155288572e+01};
+  static constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                 -2.400758277161838e+00, -2.549732539343734e+00,
+                                 4.374664141464968e+00,  2.938163982698783e+00};
+  static constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                                 2.445134137142996e+00, 3.754408661907416e+00};
+  constexpr double low = 0.02425;
+
+  if (p < low) {
+    const double q = std::sqrt(-2.0 * std::log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+            c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+  if (p > 1.0 - low) {
+    const double q = std::sqrt(-2.0 * std::log(1.0 - p));
+    return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+             c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+  const double q = p - 0.5;
+  const double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r +
+          a[5]) *
+         q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+} // namespace ctrade
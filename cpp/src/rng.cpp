@@ -0,0 +1,73 @@
+#include "ctrade/rng.hpp"
+#include <cmath>
+#include <numbers>
+
+namespace ctrade {
+
+namespace {
+
+constexpr uint32_t kMul0 = 0xD2511F53;
+constexpr uint32_t kMul1 = 0xCD9E8D57;
+constexpr uint32_t kWeyl0 = 0x9E3779B9;
+constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+std::array<uint32_t, 4> philox4x32_10(std::array<uint32_t, 4> ctr,
+                                      std::array<uint32_t, 2> key) {
+  for (int round = 0; round < 10; ++round) {
+    const uint64_t p0 = static_cast<uint64_t>(kMul0) * ctr[0];
+    const uint64_t p1 = static_cast<uint64_t>(kMul1) * ctr[2];
+    const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+    const uint32_t lo0 = static_cast<uint32_t>(p0);
+    const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+    const uint32_t lo1 = static_cast<uint32_t>(p1);
+
+    ctr = {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+  return ctr;
+}
+
+} // namespace
+
+CounterRng::CounterRng(uint64_t seed, uint64_t stream)
+    : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+      counter_{0, 0, static_cast<uint32_t>(stream),
+               static_cast<uint32_t>(stream >> 32)} {}
+
+void CounterRng::refill() {
+  block_ = philox4x32_10(counter_, key_);
+  index_ = 0;
+
+  // 64-bit block counter in the low words; the stream id stays in the high
+  // words.
+  if (++counter_[0] == 0) {
+    ++counter_[1];
+  }
+}
+
+uint32_t CounterRng::next_u32() {
+  if (index_ == 4) {
+    refill();
+  }
+  return block_[index_++];
+}
+
+uint64_t CounterRng::next_u64() {
+  const uint64_t hi = next_u32();
+  return (hi << 32) | next_u32();
+}
+
+double CounterRng::uniform() {
+  return static_cast<double>(next_u64() >> 11) * 0x1.0p-53;
+}
+
+double CounterRng::normal() {
+  // 1 - uniform() is in (0, 1], keeping log() finite.
+  const double u1 = 1.0 - uniform();
+  const double u2 = uniform();
+  return std::sqrt(-2.0 * std::log(u1)) *
+         std::cos(2.0 * std::numbers::pi * u2);
+}
+
+} // namespace ctrade
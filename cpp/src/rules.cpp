@@ -0,0 +1,619 @@
+#include "ctrade/rules.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace ctrade {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+constexpr size_t kColumns = 6;
+
+// ---- Lexer ----
+
+enum class Tok { Number, Name, Symbol, Separator, End };
+
+struct Token {
+  Tok kind;
+  std::string text;
+  double number = 0.0;
+  size_t line;
+  size_t column;
+};
+
+std::vector<Token> tokenize(const std::string &src) {
+  std::vector<Token> tokens;
+  size_t line = 1;
+  size_t line_start = 0;
+  size_t i = 0;
+  auto fail = [&](const std::string &what) {
+    throw std::invalid_argument("compile_rules: line " +
+                                std::to_string(line) + ", column " +
+                                std::to_string(i - line_start + 1) + ": " +
+                                what);
+  };
+  while (i < src.size()) {
+    const char c = src[i];
+    const size_t column = i - line_start + 1;
+    if (c == '#') {
+      while (i < src.size() && src[i] != '\n') {
+        ++i;
+      }
+    } else if (c == '\n' || c == ';') {
+      tokens.push_back({Tok::Separator, c == ';' ? ";" : "end of line", 0.0,
+                        line, column});
+      ++i;
+      if (c == '\n') {
+        ++line;
+        line_start = i;
+      }
+    } else if (std::isspace(static_cast<unsigned char>(c))) {
+      ++i;
+    } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      const char *begin = src.c_str() + i;
+      char *end = nullptr;
+      const double value = std::strtod(begin, &end);
+      if (end == begin) {
+        fail("bad number");
+      }
+      const auto length = static_cast<size_t>(end - begin);
+      tokens.push_back(
+          {Tok::Number, src.substr(i, length), value, line, column});
+      i += length;
+    } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      const size_t begin = i;
+      while (i < src.size() &&
+             (std::isalnum(static_cast<unsigned char>(src[i])) ||
+              src[i] == '_')) {
+        ++i;
+      }
+      tokens.push_back(
+          {Tok::Name, src.substr(begin, i - begin), 0.0, line, column});
+    } else {
+      static const char *const kTwo[] = {"<=", ">=", "==", "!=", "->"};
+      std::string symbol(1, c);
+      for (const char *two : kTwo) {
+        if (src.compare(i, 2, two) == 0) {
+          symbol = two;
+        }
+      }
+      if (symbol.size() == 1 &&
+          std::string("+-*/<>&|!(),").find(c) == std::string::npos) {
+        fail(std::string("unexpected '") + c + "'");
+      }
+      tokens.push_back({Tok::Symbol, symbol, 0.0, line, column});
+      i += symbol.size();
+    }
+  }
+  tokens.push_back({Tok::End, "end of input", 0.0, line,
+                    i - line_start + 1});
+  return tokens;
+}
+
+// ---- Parser ----
+
+struct Function {
+  const char *name;
+  RuleOp op;
+  int arity;
+  bool window; // second argument is a window length
+};
+
+constexpr Function kFunctions[] = {
+    {"abs", RuleOp::Abs, 1, false},
+    {"min", RuleOp::Min, 2, false},
+    {"max", RuleOp::Max, 2, false},
+    {"cross", RuleOp::Cross, 2, false},
+    {"cross_under", RuleOp::CrossUnder, 2, false},
+    {"lag", RuleOp::Lag, 2, true},
+    {"sma", RuleOp::Sma, 2, true},
+    {"ema", RuleOp::Ema, 2, true},
+    {"highest", RuleOp::Highest, 2, true},
+    {"lowest", RuleOp::Lowest, 2, true},
+};
+
+constexpr const char *kColumnNames[] = {"open",  "high",   "low",
+                                        "close", "volume", "funding"};
+
+class Parser {
+public:
+  explicit Parser(const std::string &source) : tokens_(tokenize(source)) {}
+
+  void parse(std::vector<RuleNode> &nodes, std::vector<Rule> &rules) {
+    nodes_ = &nodes;
+    for (;;) {
+      while (peek().kind == Tok::Separator) {
+        ++pos_;
+      }
+      if (peek().kind == Tok::End) {
+        break;
+      }
+      const int32_t condition = parse_or();
+      expect("->");
+      const Token &name = next();
+      if (name.kind != Tok::Name || name.text != "target") {
+        fail(name, "expected target(...)");
+      }
+      expect("(");
+      const int32_t target = parse_or();
+      expect(")");
+      rules.push_back({condition, target});
+      if (peek().kind != Tok::Separator && peek().kind != Tok::End) {
+        fail(peek(), "expected a new line or ';' after the rule");
+      }
+    }
+    if (rules.empty()) {
+      fail(peek(), "no rules");
+    }
+  }
+
+private:
+  const Token &peek() const { return tokens_[pos_]; }
+  const Token &next() { return tokens_[pos_++]; }
+
+  bool accept(const char *symbol) {
+    if (peek().kind == Tok::Symbol && peek().text == symbol) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(const char *symbol) {
+    if (!accept(symbol)) {
+      fail(peek(), std::string("expected '") + symbol + "'");
+    }
+  }
+
+  [[noreturn]] static void fail(const Token &at, const std::string &what) {
+    throw std::invalid_argument(
+        "compile_rules: line " + std::to_string(at.line) + ", column " +
+        std::to_string(at.column) + ": " + what + " (at '" + at.text + "')");
+  }
+
+  // Returns the existing node if an identical one was built before.
+  int32_t node(RuleOp op, int32_t a = -1, int32_t b = -1,
+               double value = 0.0) {
+    const auto key = std::make_tuple(op, a, b, value);
+    const auto it = interned_.find(key);
+    if (it != interned_.end()) {
+      return it->second;
+    }
+    const auto id = static_cast<int32_t>(nodes_->size());
+    nodes_->push_back({op, a, b, value});
+    interned_.emplace(key, id);
+    return id;
+  }
+
+  int32_t parse_or() {
+    int32_t lhs = parse_and();
+    while (accept("|")) {
+      lhs = node(RuleOp::Or, lhs, parse_and());
+    }
+    return lhs;
+  }
+
+  int32_t parse_and() {
+    int32_t lhs = parse_compare();
+    while (accept("&")) {
+      lhs = node(RuleOp::And, lhs, parse_compare());
+    }
+    return lhs;
+  }
+
+  int32_t parse_compare() {
+    static const std::pair<const char *, RuleOp> kOps[] = {
+        {"<", RuleOp::Lt},  {"<=", RuleOp::Le}, {">", RuleOp::Gt},
+        {">=", RuleOp::Ge}, {"==", RuleOp::Eq}, {"!=", RuleOp::Ne},
+    };
+    const int32_t lhs = parse_sum();
+    for (const auto &[symbol, op] : kOps) {
+      if (accept(symbol)) {
+        return node(op, lhs, parse_sum());
+      }
+    }
+    return lhs;
+  }
+
+  int32_t parse_sum() {
+    int32_t lhs = parse_product();
+    for (;;) {
+      if (accept("+")) {
+        lhs = node(RuleOp::Add, lhs, parse_product());
+      } else if (accept("-")) {
+        lhs = node(RuleOp::Sub, lhs, parse_product());
+      } else {
+        return lhs;
+      }
+    }
+  }
+
+  int32_t parse_product() {
+    int32_t lhs = parse_unary();
+    for (;;) {
+      if (accept("*")) {
+        lhs = node(RuleOp::Mul, lhs, parse_unary());
+      } else if (accept("/")) {
+        lhs = node(RuleOp::Div, lhs, parse_unary());
+      } else {
+        return lhs;
+      }
+    }
+  }
+
+  int32_t parse_unary() {
+    if (accept("-")) {
+      return node(RuleOp::Neg, parse_unary());
+    }
+    if (accept("!")) {
+      return node(RuleOp::Not, parse_unary());
+    }
+    return parse_primary();
+  }
+
+  int32_t parse_primary() {
+    const Token &token = next();
+    if (token.kind == Tok::Number) {
+      return node(RuleOp::Const, -1, -1, token.number);
+    }
+    if (token.kind == Tok::Symbol && token.text == "(") {
+      const int32_t inner = parse_or();
+      expect(")");
+      return inner;
+    }
+    if (token.kind != Tok::Name) {
+      fail(token, "expected a value");
+    }
+    const std::string &name =
+        token.text == "funding_rate" ? kColumnNames[5] : token.text;
+    for (size_t c = 0; c < kColumns; ++c) {
+      if (name == kColumnNames[c]) {
+        return node(RuleOp::Column, -1, -1, static_cast<double>(c));
+      }
+    }
+    for (const Function &fn : kFunctions) {
+      if (name == fn.name) {
+        return parse_call(fn);
+      }
+    }
+    fail(token, "unknown name");
+  }
+
+  int32_t parse_call(const Function &fn) {
+    expect("(");
+    const int32_t a = parse_or();
+    int32_t b = -1;
+    double window = 0.0;
+    if (fn.arity == 2) {
+      expect(",");
+      if (fn.window) {
+        const Token &n = next();
+        if (n.kind != Tok::Number || n.number < 1.0 ||
+            n.number != std::floor(n.number)) {
+          fail(n, std::string(fn.name) + " needs a whole number of bars");
+        }
+        window = n.number;
+      } else {
+        b = parse_or();
+      }
+    }
+    expect(")");
+    return node(fn.op, a, b, window);
+  }
+
+  std::vector<Token> tokens_;
+  size_t pos_ = 0;
+  std::vector<RuleNode> *nodes_ = nullptr;
+  std::map<std::tuple<RuleOp, int32_t, int32_t, double>, int32_t> interned_;
+};
+
+inline bool truthy(double x) { return x != 0.0 && x == x; }
+
+} // namespace
+
+RuleProgram compile_rules(const std::string &source) {
+  RuleProgram program;
+  Parser(source).parse(program.nodes_, program.rules_);
+  return program;
+}
+
+// ---- Evaluation ----
+
+RuleEvaluator::RuleEvaluator(RuleProgram program, size_t block)
+    : program_(std::move(program)), block_(block),
+      buffers_(program_.nodes().size() * block_),
+      out_(program_.nodes().size()), windows_(program_.nodes().size()) {
+  if (block_ == 0) {
+    throw std::invalid_argument("RuleEvaluator: block must be positive");
+  }
+  const auto &nodes = program_.nodes();
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    Window &w = windows_[i];
+    w.prev_a = w.prev_b = kNaN;
+    switch (nodes[i].op) {
+    case RuleOp::Const:
+      std::fill_n(&buffers_[i * block_], block_, nodes[i].value);
+      break;
+    case RuleOp::Lag:
+    case RuleOp::Sma:
+      w.ring.assign(static_cast<size_t>(nodes[i].value), kNaN);
+      w.missing = w.ring.size();
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void RuleEvaluator::run(const BarStore &bars, size_t begin, size_t end,
+                        std::span<double> targets) {
+  if (end > bars.size() || begin > end || targets.size() < end - begin) {
+    throw std::out_of_range("RuleEvaluator::run: bad range");
+  }
+  for (size_t at = begin; at < end; at += block_) {
+    const size_t n = std::min(block_, end - at);
+    const double *columns[kColumns] = {
+        bars.open().data() + at,   bars.high().data() + at,
+        bars.low().data() + at,    bars.close().data() + at,
+        bars.volume().data() + at, bars.funding_rate().data() + at,
+    };
+    eval(columns, n, targets.data() + (at - begin));
+  }
+}
+
+double RuleEvaluator::step(const MarketState &bar) {
+  const double values[kColumns] = {bar.open,  bar.high,   bar.low,
+                                   bar.close, bar.volume, bar.funding_rate};
+  const double *columns[kColumns];
+  for (size_t c = 0; c < kColumns; ++c) {
+    columns[c] = &values[c];
+  }
+  double target;
+  eval(columns, 1, &target);
+  return target;
+}
+
+void RuleEvaluator::eval(const double *const *columns, size_t n,
+                         double *targets) {
+  const auto &nodes = program_.nodes();
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const RuleNode &node = nodes[i];
+    double *out = &buffers_[i * block_];
+    out_[i] = out;
+    if (node.op == RuleOp::Column) {
+      out_[i] = columns[static_cast<size_t>(node.value)];
+      continue;
+    }
+    const double *a = node.a >= 0 ? out_[node.a] : nullptr;
+    const double *b = node.b >= 0 ? out_[node.b] : nullptr;
+    Window &w = windows_[i];
+    const size_t len = w.ring.size();
+
+    // Elementwise ops are plain loops over the block, so they vectorize.
+    auto unary = [&](auto f) {
+      for (size_t k = 0; k < n; ++k) {
+        out[k] = f(a[k]);
+      }
+    };
+    auto binary = [&](auto f) {
+      for (size_t k = 0; k < n; ++k) {
+        out[k] = f(a[k], b[k]);
+      }
+    };
+    switch (node.op) {
+    case RuleOp::Column:
+    case RuleOp::Const:
+      break;
+    case RuleOp::Add:
+      binary([](double x, double y) { return x + y; });
+      break;
+    case RuleOp::Sub:
+      binary([](double x, double y) { return x - y; });
+      break;
+    case RuleOp::Mul:
+      binary([](double x, double y) { return x * y; });
+      break;
+    case RuleOp::Div:
+      binary([](double x, double y) { return x / y; });
+      break;
+    case RuleOp::Lt:
+      binary([](double x, double y) { return x < y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::Le:
+      binary([](double x, double y) { return x <= y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::Gt:
+      binary([](double x, double y) { return x > y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::Ge:
+      binary([](double x, double y) { return x >= y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::Eq:
+      binary([](double x, double y) { return x == y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::Ne:
+      binary([](double x, double y) { return x != y ? 1.0 : 0.0; });
+      break;
+    case RuleOp::And:
+      binary([](double x, double y) {
+        return truthy(x) & truthy(y) ? 1.0 : 0.0;
+      });
+      break;
+    case RuleOp::Or:
+      binary([](double x, double y) {
+        return truthy(x) | truthy(y) ? 1.0 : 0.0;
+      });
+      break;
+    case RuleOp::Not:
+      unary([](double x) { return truthy(x) ? 0.0 : 1.0; });
+      break;
+    case RuleOp::Neg:
+      unary([](double x) { return -x; });
+      break;
+    case RuleOp::Abs:
+      unary([](double x) { return std::abs(x); });
+      break;
+    case RuleOp::Min:
+      binary([](double x, double y) { return std::min(x, y); });
+      break;
+    case RuleOp::Max:
+      binary([](double x, double y) { return std::max(x, y); });
+      break;
+
+    // ---- Stateful ops, sequential per bar ----
+    case RuleOp::Cross:
+    case RuleOp::CrossUnder: {
+      const double sign = node.op == RuleOp::Cross ? 1.0 : -1.0;
+      for (size_t k = 0; k < n; ++k) {
+        const bool now = sign * (a[k] - b[k]) > 0.0;
+        const bool before = sign * (w.prev_a - w.prev_b) <= 0.0;
+        out[k] = now & before ? 1.0 : 0.0;
+        w.prev_a = a[k];
+        w.prev_b = b[k];
+      }
+      break;
+    }
+    case RuleOp::Lag:
+      for (size_t k = 0; k < n; ++k) {
+        out[k] = w.ring[w.pos];
+        w.ring[w.pos] = a[k];
+        w.pos = w.pos + 1 == len ? 0 : w.pos + 1;
+      }
+      break;
+    case RuleOp::Sma:
+      for (size_t k = 0; k < n; ++k) {
+        const double old = w.ring[w.pos];
+        if (std::isnan(old)) {
+          --w.missing;
+        } else {
+          w.sum -= old;
+        }
+        if (std::isnan(a[k])) {
+          ++w.missing;
+        } else {
+          w.sum += a[k];
+        }
+        w.ring[w.pos] = a[k];
+        w.pos = w.pos + 1 == len ? 0 : w.pos + 1;
+        // Resum once per lap so rounding does not drift.
+        if (w.pos == 0 && w.missing == 0) {
+          w.sum = 0.0;
+          for (const double x : w.ring) {
+            w.sum += x;
+          }
+        }
+        out[k] = w.missing == 0 ? w.sum / static_cast<double>(len) : kNaN;
+      }
+      break;
+    case RuleOp::Ema: {
+      const double alpha = 2.0 / (node.value + 1.0);
+      double v = w.prev_a;
+      for (size_t k = 0; k < n; ++k) {
+        if (std::isnan(v)) {
+          v = a[k];
+        } else if (!std::isnan(a[k])) {
+          v += alpha * (a[k] - v);
+        }
+        out[k] = v;
+      }
+      w.prev_a = v;
+      break;
+    }
+    case RuleOp::Highest:
+    case RuleOp::Lowest: {
+      // Monotonic deque: the front is the extreme of the window.
+      const auto window = static_cast<uint64_t>(node.value);
+      const double sign = node.op == RuleOp::Highest ? 1.0 : -1.0;
+      for (size_t k = 0; k < n; ++k) {
+        const uint64_t t = w.seen++;
+        if (!std::isnan(a[k])) {
+          while (!w.extrema.empty() &&
+                 sign * w.extrema.back().second <= sign * a[k]) {
+            w.extrema.pop_back();
+          }
+          w.extrema.emplace_back(t, a[k]);
+        }
+        while (!w.extrema.empty() && w.extrema.front().first + window <= t) {
+          w.extrema.pop_front();
+        }
+        out[k] = w.seen >= window && !w.extrema.empty()
+                     ? w.extrema.front().second
+                     : kNaN;
+      }
+      break;
+    }
+    }
+  }
+
+  // ---- First rule that holds sets the target ----
+  const auto &rules = program_.rules();
+  for (size_t k = 0; k < n; ++k) {
+    for (const Rule &rule : rules) {
+      const double value = out_[rule.target][k];
+      if (truthy(out_[rule.condition][k]) && !std::isnan(value)) {
+        target_ = value;
+        break;
+      }
+    }
+    targets[k] = target_;
+  }
+}
+
+std::vector<double> evaluate_rules(const RuleProgram &program,
+                                   const BarStore &bars) {
+  std::vector<double> targets(bars.size());
+  RuleEvaluator(program).run(bars, 0, bars.size(), targets);
+  return targets;
+}
+
+std::vector<std::vector<double>>
+evaluate_rules(const RuleProgram &program,
+               std::span<const BarStore *const> stores, unsigned threads) {
+  std::vector<std::vector<double>> out(stores.size());
+  parallel_for(stores.size(), threads, [&](size_t s, unsigned) {
+    out[s] = evaluate_rules(program, *stores[s]);
+  });
+  return out;
+}
+
+// ---- Strategy ----
+
+RuleStrategy::RuleStrategy(RuleProgram program, size_t n_assets)
+    : program_(std::move(program)), n_assets_(n_assets) {
+  if (n_assets_ == 0) {
+    throw std::invalid_argument("RuleStrategy: n_assets must be positive");
+  }
+  init();
+}
+
+void RuleStrategy::init() {
+  evaluators_.clear();
+  evaluators_.reserve(n_assets_);
+  for (size_t i = 0; i < n_assets_; ++i) {
+    evaluators_.emplace_back(program_, 1);
+  }
+  weights_.assign(n_assets_, 0.0);
+}
+
+void RuleStrategy::on_bar(const MarketState &market, ExecutionContext &ctx) {
+  if (market.asset_id < 0 ||
+      static_cast<size_t>(market.asset_id) >= n_assets_) {
+    throw std::out_of_range("RuleStrategy: asset_id outside the universe");
+  }
+  const auto asset = static_cast<size_t>(market.asset_id);
+  const double target = evaluators_[asset].step(market);
+  if (target != weights_[asset]) {
+    weights_[asset] = target;
+    ctx.set_target_weights(weights_);
+  }
+}
+
+} // namespace ctrade
@@ -0,0 +1,278 @@
+#include "ctrade/snapshot.hpp"
+#include "ctrade/fnv.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x314e535443; // "CTSN1"
+
+struct Stored {
+  int64_t start_ts;
+  int64_t end_ts;
+  BacktestResult result;
+  std::vector<uint8_t> state;
+};
+
+// File layout: magic, key id, start_ts, end_ts, the four result series,
+// the state blob, then an FNV-1a checksum of everything before it.
+std::optional<Stored> read_snapshot(const std::string &path, uint64_t id) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+  if (bytes.size() < 8) {
+    return std::nullopt;
+  }
+
+  uint64_t h = kFnvOffset;
+  fnv_bytes(h, bytes.data(), bytes.size() - 8);
+  SnapshotReader tail(std::span<const uint8_t>(bytes).last(8));
+  if (tail.u64() != h) {
+    return std::nullopt;
+  }
+
+  try {
+    SnapshotReader r(std::span<const uint8_t>(bytes).first(bytes.size() - 8));
+    if (r.u64() != kMagic || r.u64() != id) {
+      return std::nullopt;
+    }
+    Stored s;
+    s.start_ts = r.i64();
+    s.end_ts = r.i64();
+    s.result.timestamps = r.i64s();
+    s.result.equity = r.f64s();
+    s.result.pnl = r.f64s();
+    s.result.drawdown = r.f64s();
+    s.state = r.blob();
+    return s;
+  } catch (const std::runtime_error &) {
+    return std::nullopt;
+  }
+}
+
+template <typename T>
+void truncate_series(std::vector<T> &series, size_t n) {
+  if (series.size() > n) {
+    series.resize(n);
+  }
+}
+
+} // namespace
+
+// ---- SnapshotWriter / SnapshotReader ----
+
+void SnapshotWriter::u64(uint64_t v) {
+  for (int i = 0; i < 8; ++i) {
+    bytes_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+}
+
+void SnapshotWriter::f64(double v) { u64(std::bit_cast<uint64_t>(v)); }
+
+void SnapshotWriter::str(const std::string &s) {
+  u64(s.size());
+  bytes_.insert(bytes_.end(), s.begin(), s.end());
+}
+
+void SnapshotWriter::f64s(std::span<const double> values) {
+  u64(values.size());
+  for (double v : values) {
+    f64(v);
+  }
+}
+
+void SnapshotWriter::i64s(std::span<const int64_t> values) {
+  u64(values.size());
+  for (int64_t v : values) {
+    i64(v);
+  }
+}
+
+void SnapshotWriter::blob(std::span<const uint8_t> data) {
+  u64(data.size());
+  bytes_.insert(bytes_.end(), data.begin(), data.end());
+}
+
+void SnapshotReader::need(size_t n) const {
+  if (bytes_.size() - pos_ < n) {
+    throw std::runtime_error("SnapshotReader: truncated snapshot");
+  }
+}
+
+uint64_t SnapshotReader::u64() {
+  need(8);
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) {
+    v |= static_cast<uint64_t>(bytes_[pos_++]) << (8 * i);
+  }
+  return v;
+}
+
+double SnapshotReader::f64() { return std::bit_cast<double>(u64()); }
+
+std::string SnapshotReader::str() {
+  const uint64_t n = u64();
+  need(n);
+  std::string s(reinterpret_cast<const char *>(bytes_.data() + pos_), n);
+  pos_ += n;
+  return s;
+}
+
+std::vector<double> SnapshotReader::f64s() {
+  const uint64_t n = u64();
+  need(n <= (bytes_.size() - pos_) / 8 ? n * 8 : bytes_.size() - pos_ + 1);
+  std::vector<double> values(n);
+  for (auto &v : values) {
+    v = f64();
+  }
+  return values;
+}
+
+std::vector<int64_t> SnapshotReader::i64s() {
+  const uint64_t n = u64();
+  need(n <= (bytes_.size() - pos_) / 8 ? n * 8 : bytes_.size() - pos_ + 1);
+  std::vector<int64_t> values(n);
+  for (auto &v : values) {
+    v = i64();
+  }
+  return values;
+}
+
+std::vector<uint8_t> SnapshotReader::blob() {
+  const uint64_t n = u64();
+  need(n);
+  std::vector<uint8_t> data(bytes_.begin() + pos_, bytes_.begin() + pos_ + n);
+  pos_ += n;
+  return data;
+}
+
+// ---- SnapshotStore ----
+
+uint64_t snapshot_id(const SnapshotKey &key) {
+  uint64_t h = kFnvOffset;
+  fnv_bytes(h, reinterpret_cast<const uint8_t *>(key.strategy.data()),
+            key.strategy.size());
+  fnv_word(h, key.strategy.size());
+  for (double p : key.params) {
+    fnv_word(h, std::bit_cast<uint64_t>(p));
+  }
+  fnv_word(h, key.params.size());
+  fnv_bytes(h, reinterpret_cast<const uint8_t *>(key.data_version.data()),
+            key.data_version.size());
+  fnv_word(h, key.data_version.size());
+  return h;
+}
+
+SnapshotStore::SnapshotStore(std::string directory)
+    : directory_(std::move(directory)) {
+  std::filesystem::create_directories(directory_);
+}
+
+std::string SnapshotStore::path(const SnapshotKey &key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.snap",
+                static_cast<unsigned long long>(snapshot_id(key)));
+  return (std::filesystem::path(directory_) / name).string();
+}
+
+int64_t SnapshotStore::end_ts(const SnapshotKey &key) const {
+  auto stored = read_snapshot(path(key), snapshot_id(key));
+  return stored ? stored->end_ts : std::numeric_limits<int64_t>::min();
+}
+
+void SnapshotStore::erase(const SnapshotKey &key) {
+  std::filesystem::remove(path(key));
+}
+
+BacktestResult SnapshotStore::extend(const SnapshotKey &key,
+                                     ResumableBacktest &backtest,
+                                     int64_t start_ts, int64_t end_ts) {
+  if (end_ts < start_ts) {
+    throw std::invalid_argument("SnapshotStore::extend: end before start");
+  }
+  const uint64_t id = snapshot_id(key);
+  const std::string file = path(key);
+  auto stored = read_snapshot(file, id);
+  if (stored && stored->start_ts != start_ts) {
+    stored.reset();
+  }
+
+  BacktestResult result;
+  if (stored && end_ts <= stored->end_ts) {
+    result = std::move(stored->result);
+    const auto &ts = result.timestamps;
+    const size_t n = static_cast<size_t>(
+        std::lower_bound(ts.begin(), ts.end(), end_ts) - ts.begin());
+    truncate_series(result.timestamps, n);
+    truncate_series(result.equity, n);
+    truncate_series(result.pnl, n);
+    truncate_series(result.drawdown, n);
+    return result;
+  }
+
+  // A state the backtest no longer understands (e.g. after a change to
+  // its save format) counts as no snapshot.
+  int64_t begin_ts = start_ts;
+  bool loaded = false;
+  if (stored) {
+    try {
+      SnapshotReader state(stored->state);
+      backtest.load(state);
+      loaded = true;
+    } catch (const std::exception &) {
+    }
+  }
+  if (loaded) {
+    result = std::move(stored->result);
+    begin_ts = stored->end_ts;
+  } else {
+    backtest.reset();
+  }
+  backtest.run(begin_ts, end_ts, result);
+
+  SnapshotWriter state;
+  backtest.save(state);
+  SnapshotWriter out;
+  out.u64(kMagic);
+  out.u64(id);
+  out.i64(start_ts);
+  out.i64(end_ts);
+  out.i64s(result.timestamps);
+  out.f64s(result.equity);
+  out.f64s(result.pnl);
+  out.f64s(result.drawdown);
+  out.blob(state.bytes());
+  uint64_t h = kFnvOffset;
+  fnv_bytes(h, out.bytes().data(), out.bytes().size());
+  out.u64(h);
+
+  // Write then rename, so readers never see a partial file.
+  const std::string tmp = file + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char *>(out.bytes().data()),
+            static_cast<std::streamsize>(out.bytes().size()));
+    // close() flushes, so a full disk shows up here rather than after
+    // the rename.
+    f.close();
+    if (!f) {
+      throw std::runtime_error("SnapshotStore: cannot write " + tmp);
+    }
+  }
+  std::filesystem::rename(tmp, file);
+  return result;
+}
+
+} // namespace ctrade
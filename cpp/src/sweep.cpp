@@ -0,0 +1,113 @@
+#include "ctrade/sweep.hpp"
+#include "ctrade/parallel.hpp"
+#include <cmath>
+#include <mutex>
+
+namespace ctrade {
+
+RunSummary summarize(const BacktestResult &result) {
+  RunSummary s{};
+  const auto &equity = result.equity;
+  s.n_bars = static_cast<int64_t>(equity.size());
+  if (equity.empty()) {
+    return s;
+  }
+
+  s.final_equity = equity.back();
+  s.total_return = equity.front() != 0.0
+                       ? equity.back() / equity.front() - 1.0
+                       : 0.0;
+
+  // Sequential, left-to-right accumulation: the same inputs always produce
+  // the same bits.
+  double peak = equity.front();
+  double mean = 0.0;
+  double m2 = 0.0;
+  size_t n_returns = 0;
+  for (size_t i = 0; i < equity.size(); ++i) {
+    if (equity[i] > peak) {
+      peak = equity[i];
+    }
+    if (peak > 0.0) {
+      const double dd = (peak - equity[i]) / peak;
+      if (dd > s.max_drawdown) {
+        s.max_drawdown = dd;
+      }
+    }
+    if (i > 0 && equity[i - 1] != 0.0) {
+      const double r = equity[i] / equity[i - 1] - 1.0;
+      ++n_returns;
+      const double delta = r - mean;
+      mean += delta / static_cast<double>(n_returns);
+      m2 += delta * (r - mean);
+    }
+  }
+
+  if (n_returns > 1) {
+    const double var = m2 / static_cast<double>(n_returns - 1);
+    s.sharpe = var > 0.0 ? mean / std::sqrt(var) : 0.0;
+  }
+  return s;
+}
+
+void SweepStats::add(size_t index, const RunSummary &run) {
+  ++n_runs;
+  const double n = static_cast<double>(n_runs);
+  mean_return += (run.total_return - mean_return) / n;
+  mean_sharpe += (run.sharpe - mean_sharpe) / n;
+
+  if (n_runs == 1 || run.sharpe > best_sharpe ||
+      (run.sharpe == best_sharpe && index < best_index)) {
+    best_sharpe = run.sharpe;
+    best_index = index;
+  }
+  if (run.max_drawdown > worst_drawdown) {
+    worst_drawdown = run.max_drawdown;
+  }
+}
+
+SweepResult run_sweep(const std::vector<ParamSet> &params, const RunFn &run,
+                      const SweepConfig &config) {
+  SweepResult result;
+  result.runs.resize(params.size());
+
+  if (config.deterministic) {
+    parallel_for(params.size(), config.threads, [&](size_t i, unsigned) {
+      CounterRng rng(config.seed, i);
+      result.runs[i] = summarize(run(params[i], rng));
+    });
+    for (size_t i = 0; i < result.runs.size(); ++i) {
+      result.stats.add(i, result.runs[i]);
+    }
+    return result;
+  }
+
+  const unsigned threads = resolve_threads(config.threads);
+  std::vector<CounterRng> worker_rngs;
+  worker_rngs.reserve(threads);
+  for (unsigned w = 0; w < threads; ++w) {
+    worker_rngs.emplace_back(config.seed, w);
+  }
+
+  std::mutex stats_mutex;
+  parallel_for(params.size(), threads, [&](size_t i, unsigned worker) {
+    result.runs[i] = summarize(run(params[i], worker_rngs[worker]));
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    result.stats.add(i, result.runs[i]);
+  });
+  return result;
+}
+
+uint64_t hash_summaries(const std::vector<RunSummary> &runs) {
+  BacktestResult flat;
+  for (const auto &run : runs) {
+    flat.timestamps.push_back(run.n_bars);
+    flat.equity.push_back(run.final_equity);
+    flat.pnl.push_back(run.total_return);
+    flat.drawdown.push_back(run.max_drawdown);
+    flat.drawdown.push_back(run.sharpe);
+  }
+  return hash_result(flat);
+}
+
+} // namespace ctrade
@@ -0,0 +1,661 @@
+#include "ctrade/sweep_cluster.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <poll.h>
+#include <span>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ctrade {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x57535443; // "CTSW"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMaxFrame = 1u << 24;
+
+// Malformed input from a peer, as opposed to a local failure.
+struct ProtocolError : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+enum class MessageType : uint8_t {
+  Hello = 1,    // worker -> coordinator: magic, version; ready for a job
+  Job = 2,      // coordinator -> worker: index, seed, params
+  Result = 3,   // worker -> coordinator: index, summary; ready for a job
+  Failed = 4,   // worker -> coordinator: index, message
+  Shutdown = 5, // coordinator -> worker
+};
+
+// ---- Wire encoding ----
+
+class FrameWriter {
+public:
+  explicit FrameWriter(MessageType type) : buf_(4, 0) {
+    buf_.push_back(static_cast<uint8_t>(type));
+  }
+
+  void u32(uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+      buf_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+  }
+  void u64(uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+      buf_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+  }
+  void f64(double v) { u64(std::bit_cast<uint64_t>(v)); }
+  void str(const std::string &s) {
+    u32(static_cast<uint32_t>(s.size()));
+    buf_.insert(buf_.end(), s.begin(), s.end());
+  }
+
+  // Length prefix covers the type byte and body.
+  const std::vector<uint8_t> &finish() {
+    const auto n = static_cast<uint32_t>(buf_.size() - 4);
+    for (int i = 0; i < 4; ++i) {
+      buf_[i] = static_cast<uint8_t>(n >> (8 * i));
+    }
+    return buf_;
+  }
+
+private:
+  std::vector<uint8_t> buf_;
+};
+
+class FrameReader {
+public:
+  explicit FrameReader(std::span<const uint8_t> body) : body_(body) {}
+
+  uint32_t u32() {
+    need(4);
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+      v |= static_cast<uint32_t>(body_[pos_++]) << (8 * i);
+    }
+    return v;
+  }
+  uint64_t u64() {
+    need(8);
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+      v |= static_cast<uint64_t>(body_[pos_++]) << (8 * i);
+    }
+    return v;
+  }
+  double f64() { return std::bit_cast<double>(u64()); }
+  std::string str() {
+    const uint32_t n = u32();
+    need(n);
+    std::string s(reinterpret_cast<const char *>(body_.data() + pos_), n);
+    pos_ += n;
+    return s;
+  }
+
+private:
+  void need(size_t n) const {
+    if (body_.size() - pos_ < n) {
+      throw ProtocolError("sweep cluster: truncated message");
+    }
+  }
+
+  std::span<const uint8_t> body_;
+  size_t pos_ = 0;
+};
+
+struct Frame {
+  MessageType type;
+  std::vector<uint8_t> body;
+};
+
+// Pops one complete frame off the front of `buf`, if there is one.
+std::optional<Frame> take_frame(std::vector<uint8_t> &buf) {
+  if (buf.size() < 4) {
+    return std::nullopt;
+  }
+  uint32_t n = 0;
+  for (int i = 0; i < 4; ++i) {
+    n |= static_cast<uint32_t>(buf[i]) << (8 * i);
+  }
+  if (n == 0 || n > kMaxFrame) {
+    throw ProtocolError("sweep cluster: bad frame length");
+  }
+  if (buf.size() < 4 + static_cast<size_t>(n)) {
+    return std::nullopt;
+  }
+  Frame frame{static_cast<MessageType>(buf[4]),
+              std::vector<uint8_t>(buf.begin() + 5, buf.begin() + 4 + n)};
+  buf.erase(buf.begin(), buf.begin() + 4 + n);
+  return frame;
+}
+
+bool send_all(int fd, const std::vector<uint8_t> &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t n =
+        ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Appends whatever is available; false on EOF or error.
+bool read_some(int fd, std::vector<uint8_t> &buf) {
+  uint8_t chunk[4096];
+  ssize_t n;
+  do {
+    n = ::recv(fd, chunk, sizeof(chunk), 0);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+  buf.insert(buf.end(), chunk, chunk + n);
+  return true;
+}
+
+// Blocks for the next frame; nullopt on EOF.
+std::optional<Frame> read_frame(int fd, std::vector<uint8_t> &buf) {
+  while (true) {
+    if (auto frame = take_frame(buf)) {
+      return frame;
+    }
+    if (!read_some(fd, buf)) {
+      return std::nullopt;
+    }
+  }
+}
+
+// ---- Endpoints ----
+
+struct Endpoint {
+  bool is_unix;
+  std::string path; // unix
+  std::string host; // tcp
+  std::string port;
+};
+
+Endpoint parse_endpoint(const std::string &endpoint) {
+  if (endpoint.rfind("unix:", 0) == 0 && endpoint.size() > 5) {
+    return {true, endpoint.substr(5), "", ""};
+  }
+  if (endpoint.rfind("tcp:", 0) == 0) {
+    const auto colon = endpoint.rfind(':');
+    if (colon > 4 && colon + 1 < endpoint.size()) {
+      return {false, "", endpoint.substr(4, colon - 4),
+              endpoint.substr(colon + 1)};
+    }
+  }
+  throw std::invalid_argument("sweep cluster: endpoint must be "
+                              "unix:<path> or tcp:<host>:<port>");
+}
+
+sockaddr_un unix_address(const std::string &path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::invalid_argument("sweep cluster: unix socket path too long");
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+struct AddrInfo {
+  addrinfo *head = nullptr;
+  ~AddrInfo() {
+    if (head != nullptr) {
+      freeaddrinfo(head);
+    }
+  }
+};
+
+void resolve(const Endpoint &ep, bool passive, AddrInfo &out) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+  const int rc =
+      getaddrinfo(ep.host.c_str(), ep.port.c_str(), &hints, &out.head);
+  if (rc != 0) {
+    throw std::runtime_error(std::string("sweep cluster: cannot resolve ") +
+                             ep.host + ": " + gai_strerror(rc));
+  }
+}
+
+void set_nodelay(int fd) {
+  int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// Returns a connected socket, or -1 if nothing is listening yet.
+int try_connect(const Endpoint &ep) {
+  if (ep.is_unix) {
+    const auto addr = unix_address(ep.path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      throw std::runtime_error("sweep cluster: socket() failed");
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                  sizeof(addr)) == 0) {
+      return fd;
+    }
+    ::close(fd);
+    return -1;
+  }
+
+  AddrInfo info;
+  resolve(ep, false, info);
+  for (addrinfo *ai = info.head; ai != nullptr; ai = ai->ai_next) {
+    const int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      set_nodelay(fd);
+      return fd;
+    }
+    ::close(fd);
+  }
+  return -1;
+}
+
+struct Connection {
+  int fd;
+  std::vector<uint8_t> in;
+  bool ready = false; // waiting for a job
+  int64_t job = -1;
+};
+
+// Closes every worker connection when run() returns or throws, which tells
+// the workers to exit.
+struct ConnectionSet {
+  std::vector<Connection> conns;
+  ~ConnectionSet() {
+    for (auto &c : conns) {
+      ::close(c.fd);
+    }
+  }
+};
+
+// ---- Worker ----
+
+void worker_loop(const Endpoint &ep, const RunFn &run,
+                 int connect_timeout_ms) {
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(connect_timeout_ms);
+  int fd = try_connect(ep);
+  while (fd < 0) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      throw std::runtime_error("run_sweep_worker: cannot connect");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    fd = try_connect(ep);
+  }
+
+  FrameWriter hello(MessageType::Hello);
+  hello.u32(kMagic);
+  hello.u32(kVersion);
+  std::vector<uint8_t> buf;
+  bool open = send_all(fd, hello.finish());
+  while (open) {
+    auto frame = read_frame(fd, buf);
+    if (!frame || frame->type != MessageType::Job) {
+      break; // shutdown, or the coordinator is gone
+    }
+    FrameReader in(frame->body);
+    const uint64_t index = in.u64();
+    const uint64_t seed = in.u64();
+    ParamSet params(in.u32());
+    for (auto &p : params) {
+      p = in.f64();
+    }
+
+    CounterRng rng(seed, index);
+    try {
+      const RunSummary s = summarize(run(params, rng));
+      FrameWriter out(MessageType::Result);
+      out.u64(index);
+      out.f64(s.final_equity);
+      out.f64(s.total_return);
+      out.f64(s.max_drawdown);
+      out.f64(s.sharpe);
+      out.u64(static_cast<uint64_t>(s.n_bars));
+      open = send_all(fd, out.finish());
+    } catch (const std::exception &e) {
+      FrameWriter out(MessageType::Failed);
+      out.u64(index);
+      out.str(e.what());
+      open = send_all(fd, out.finish());
+    }
+  }
+  ::close(fd);
+}
+
+} // namespace
+
+// ---- SweepCoordinator ----
+
+SweepCoordinator::SweepCoordinator(const std::string &endpoint,
+                                   ClusterConfig config)
+    : config_(config) {
+  const Endpoint ep = parse_endpoint(endpoint);
+
+  if (ep.is_unix) {
+    const auto addr = unix_address(ep.path);
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // Clear a stale socket from an earlier run, but never another file.
+    struct stat st {};
+    if (::lstat(ep.path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+      ::unlink(ep.path.c_str());
+    }
+    if (listen_fd_ < 0 ||
+        ::bind(listen_fd_, reinterpret_cast<const sockaddr *>(&addr),
+               sizeof(addr)) != 0) {
+      if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+      }
+      throw std::runtime_error("SweepCoordinator: cannot bind " + endpoint);
+    }
+    unix_path_ = ep.path;
+    endpoint_ = endpoint;
+  } else {
+    AddrInfo info;
+    resolve(ep, true, info);
+    for (addrinfo *ai = info.head; ai != nullptr; ai = ai->ai_next) {
+      const int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      int one = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        listen_fd_ = fd;
+        break;
+      }
+      ::close(fd);
+    }
+    if (listen_fd_ < 0) {
+      throw std::runtime_error("SweepCoordinator: cannot bind " + endpoint);
+    }
+    sockaddr_storage bound{};
+    socklen_t len = sizeof(bound);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&bound), &len);
+    const uint16_t port =
+        bound.ss_family == AF_INET6
+            ? ntohs(reinterpret_cast<sockaddr_in6 *>(&bound)->sin6_port)
+            : ntohs(reinterpret_cast<sockaddr_in *>(&bound)->sin_port);
+    endpoint_ = "tcp:" + ep.host + ":" + std::to_string(port);
+  }
+
+  if (::listen(listen_fd_, 128) != 0) {
+    ::close(listen_fd_);
+    throw std::runtime_error("SweepCoordinator: listen() failed");
+  }
+}
+
+SweepCoordinator::~SweepCoordinator() {
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+  }
+  if (!unix_path_.empty()) {
+    ::unlink(unix_path_.c_str());
+  }
+}
+
+SweepResult SweepCoordinator::run(const std::vector<ParamSet> &params,
+                                  uint64_t seed, SweepJournal *journal) {
+  const size_t n = params.size();
+  SweepResult result;
+  result.runs.resize(n);
+
+  std::vector<bool> done(n, false);
+  std::vector<unsigned> in_flight(n, 0);
+  std::vector<unsigned> failures(n, 0);
+  std::deque<size_t> queue;
+  size_t completed = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (journal != nullptr) {
+      if (auto prior = journal->find(run_key(params[i], seed, i))) {
+        result.runs[i] = *prior;
+        done[i] = true;
+        ++completed;
+        continue;
+      }
+    }
+    queue.push_back(i);
+  }
+
+  ConnectionSet set;
+  auto &conns = set.conns;
+
+  // Next job for an idle worker: queued work first, then a duplicate of the
+  // unfinished job with the fewest copies in flight.
+  auto next_job = [&]() -> int64_t {
+    while (!queue.empty()) {
+      const size_t j = queue.front();
+      queue.pop_front();
+      if (!done[j]) {
+        return static_cast<int64_t>(j);
+      }
+    }
+    int64_t best = -1;
+    for (size_t j = 0; j < n; ++j) {
+      if (!done[j] && in_flight[j] < 2 &&
+          (best < 0 || in_flight[j] < in_flight[static_cast<size_t>(best)])) {
+        best = static_cast<int64_t>(j);
+      }
+    }
+    return best;
+  };
+
+  auto dispatch = [&](Connection &c) {
+    const int64_t j = next_job();
+    if (j < 0) {
+      c.ready = true;
+      return;
+    }
+    const auto &p = params[static_cast<size_t>(j)];
+    FrameWriter out(MessageType::Job);
+    out.u64(static_cast<uint64_t>(j));
+    out.u64(seed);
+    out.u32(static_cast<uint32_t>(p.size()));
+    for (double v : p) {
+      out.f64(v);
+    }
+    c.ready = false;
+    c.job = j;
+    ++in_flight[static_cast<size_t>(j)];
+    // A failed send surfaces as EOF on the next poll.
+    send_all(c.fd, out.finish());
+  };
+
+  // Requeues the job of a worker that went away or misbehaved; `reason`
+  // ends up in the error if the job runs out of retries.
+  auto drop = [&](size_t k, const std::string &reason = "") {
+    const int64_t j = conns[k].job;
+    ::close(conns[k].fd);
+    conns.erase(conns.begin() + static_cast<std::ptrdiff_t>(k));
+    if (j < 0) {
+      return;
+    }
+    const auto job = static_cast<size_t>(j);
+    --in_flight[job];
+    if (done[job]) {
+      return;
+    }
+    if (++failures[job] > config_.max_retries) {
+      throw std::runtime_error("SweepCoordinator: job " + std::to_string(job) +
+                               " lost too many workers" +
+                               (reason.empty() ? "" : ": " + reason));
+    }
+    if (in_flight[job] == 0) {
+      queue.push_front(job);
+    }
+  };
+
+  auto last_progress = std::chrono::steady_clock::now();
+
+  // Acts on one message from `c`; returns why the worker must be dropped,
+  // or an empty string.
+  auto handle = [&](Connection &c, MessageType type,
+                    FrameReader &in) -> std::string {
+    switch (type) {
+    case MessageType::Hello:
+      if (in.u32() != kMagic || in.u32() != kVersion) {
+        return "bad handshake";
+      }
+      dispatch(c);
+      return "";
+    case MessageType::Result: {
+      const uint64_t j = in.u64();
+      if (j >= n || static_cast<int64_t>(j) != c.job) {
+        return "unexpected result";
+      }
+      RunSummary s{};
+      s.final_equity = in.f64();
+      s.total_return = in.f64();
+      s.max_drawdown = in.f64();
+      s.sharpe = in.f64();
+      s.n_bars = static_cast<int64_t>(in.u64());
+      --in_flight[j];
+      c.job = -1;
+      if (!done[j]) {
+        done[j] = true;
+        result.runs[j] = s;
+        ++completed;
+        if (journal != nullptr) {
+          journal->append(run_key(params[j], seed, j), s);
+        }
+        last_progress = std::chrono::steady_clock::now();
+      }
+      if (completed < n) {
+        dispatch(c);
+      }
+      return "";
+    }
+    case MessageType::Failed: {
+      const uint64_t j = in.u64();
+      return "job " + std::to_string(j) + " failed: " + in.str();
+    }
+    default:
+      return "unexpected message";
+    }
+  };
+
+  std::vector<pollfd> fds;
+  while (completed < n) {
+    // Idle workers may have work again after a requeue.
+    for (auto &c : conns) {
+      if (c.ready) {
+        dispatch(c);
+      }
+    }
+
+    fds.clear();
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const auto &c : conns) {
+      fds.push_back({c.fd, POLLIN, 0});
+    }
+    int timeout = -1;
+    if (config_.idle_timeout_ms > 0) {
+      const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - last_progress)
+                              .count();
+      timeout = static_cast<int>(
+          std::max<int64_t>(0, config_.idle_timeout_ms - waited));
+    }
+    const int rc = ::poll(fds.data(), fds.size(), timeout);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      throw std::runtime_error("SweepCoordinator: poll() failed");
+    }
+    if (rc == 0) {
+      throw std::runtime_error("SweepCoordinator: no progress within timeout");
+    }
+
+    // Walk back to front so drops do not shift unvisited entries.
+    for (size_t k = conns.size(); k-- > 0;) {
+      const short revents = fds[k + 1].revents;
+      if (revents == 0) {
+        continue;
+      }
+      auto &c = conns[k];
+      if (!read_some(c.fd, c.in)) {
+        drop(k);
+        continue;
+      }
+      // A worker that fails its job or breaks the protocol is dropped like
+      // one that disconnects, so its job goes to another worker.
+      std::string fault;
+      try {
+        while (fault.empty()) {
+          auto frame = take_frame(c.in);
+          if (!frame) {
+            break;
+          }
+          FrameReader in(frame->body);
+          fault = handle(c, frame->type, in);
+        }
+      } catch (const ProtocolError &e) {
+        fault = e.what();
+      }
+      if (!fault.empty()) {
+        drop(k, fault);
+      }
+    }
+
+    if (fds[0].revents & POLLIN) {
+      const int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        set_nodelay(fd); // fails harmlessly on unix sockets
+        conns.push_back({fd, {}});
+      }
+    }
+  }
+
+  // Workers still holding duplicates see EOF when the set closes.
+  FrameWriter shutdown(MessageType::Shutdown);
+  for (const auto &c : conns) {
+    send_all(c.fd, shutdown.finish());
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    result.stats.add(i, result.runs[i]);
+  }
+  return result;
+}
+
+// ---- Worker ----
+
+void run_sweep_worker(const std::string &endpoint, const RunFn &run,
+                      unsigned threads, int connect_timeout_ms) {
+  const Endpoint ep = parse_endpoint(endpoint);
+  const unsigned loops = resolve_threads(threads);
+  parallel_for(loops, loops, [&](size_t, unsigned) {
+    worker_loop(ep, run, connect_timeout_ms);
+  });
+}
+
+} // namespace ctrade
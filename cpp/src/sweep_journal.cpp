@@ -0,0 +1,232 @@
+#include "ctrade/sweep_journal.hpp"
+#include "ctrade/fnv.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ctrade {
+
+namespace {
+
+// Magic and version, then the hash of the sweep id.
+constexpr std::array<uint8_t, 8> kMagic = {'C', 'T', 'S', 'J', 2, 0, 0, 0};
+constexpr size_t kHeaderBytes = kMagic.size() + 8;
+
+// key, final_equity, total_return, max_drawdown, sharpe, n_bars, checksum
+constexpr size_t kWords = 7;
+constexpr size_t kRecordBytes = kWords * 8;
+
+uint64_t checksum(const std::array<uint64_t, kWords> &words) {
+  uint64_t h = kFnvOffset;
+  for (size_t i = 0; i + 1 < kWords; ++i) {
+    fnv_word(h, words[i]);
+  }
+  return h;
+}
+
+// Little-endian on disk regardless of host order.
+void store(uint8_t *out, uint64_t word) {
+  for (int i = 0; i < 8; ++i) {
+    out[i] = static_cast<uint8_t>(word >> (8 * i));
+  }
+}
+
+uint64_t load(const uint8_t *in) {
+  uint64_t word = 0;
+  for (int i = 0; i < 8; ++i) {
+    word |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  return word;
+}
+
+uint64_t sweep_hash(const std::string &sweep_id) {
+  uint64_t h = kFnvOffset;
+  fnv_bytes(h, reinterpret_cast<const uint8_t *>(sweep_id.data()),
+            sweep_id.size());
+  return h;
+}
+
+bool write_all(int fd, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::write(fd, data, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+} // namespace
+
+uint64_t run_key(const ParamSet &params, uint64_t seed, size_t index) {
+  uint64_t h = kFnvOffset;
+  fnv_word(h, seed);
+  fnv_word(h, static_cast<uint64_t>(index));
+  for (double p : params) {
+    fnv_word(h, std::bit_cast<uint64_t>(p));
+  }
+  fnv_word(h, static_cast<uint64_t>(params.size()));
+  return h;
+}
+
+// ---- SweepJournal ----
+
+SweepJournal::SweepJournal(const std::string &path,
+                           const std::string &sweep_id, bool durable)
+    : durable_(durable) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("SweepJournal: cannot open " + path);
+  }
+
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[65536];
+  ssize_t n;
+  while ((n = ::read(fd_, chunk, sizeof(chunk))) != 0) {
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      ::close(fd_);
+      throw std::runtime_error("SweepJournal: cannot read " + path);
+    }
+    bytes.insert(bytes.end(), chunk, chunk + n);
+  }
+
+  const uint64_t id = sweep_hash(sweep_id);
+  if (bytes.empty()) {
+    std::array<uint8_t, kHeaderBytes> header;
+    std::copy(kMagic.begin(), kMagic.end(), header.begin());
+    store(header.data() + kMagic.size(), id);
+    if (!write_all(fd_, header.data(), header.size())) {
+      ::close(fd_);
+      throw std::runtime_error("SweepJournal: cannot write " + path);
+    }
+    return;
+  }
+  if (bytes.size() < kHeaderBytes ||
+      !std::equal(kMagic.begin(), kMagic.end(), bytes.begin())) {
+    ::close(fd_);
+    throw std::runtime_error("SweepJournal: not a sweep journal: " + path);
+  }
+  if (load(bytes.data() + kMagic.size()) != id) {
+    ::close(fd_);
+    throw std::invalid_argument("SweepJournal: " + path +
+                                " belongs to another sweep than " + sweep_id);
+  }
+
+  // Keep records up to the first torn or corrupt one.
+  size_t good = kHeaderBytes;
+  while (good + kRecordBytes <= bytes.size()) {
+    std::array<uint64_t, kWords> words;
+    for (size_t i = 0; i < kWords; ++i) {
+      words[i] = load(bytes.data() + good + 8 * i);
+    }
+    if (words[kWords - 1] != checksum(words)) {
+      break;
+    }
+    RunSummary s{};
+    s.final_equity = std::bit_cast<double>(words[1]);
+    s.total_return = std::bit_cast<double>(words[2]);
+    s.max_drawdown = std::bit_cast<double>(words[3]);
+    s.sharpe = std::bit_cast<double>(words[4]);
+    s.n_bars = static_cast<int64_t>(words[5]);
+    done_[words[0]] = s;
+    good += kRecordBytes;
+  }
+  if (good != bytes.size() &&
+      ::ftruncate(fd_, static_cast<off_t>(good)) != 0) {
+    ::close(fd_);
+    throw std::runtime_error("SweepJournal: cannot truncate " + path);
+  }
+  ::lseek(fd_, static_cast<off_t>(good), SEEK_SET);
+}
+
+SweepJournal::~SweepJournal() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+std::optional<RunSummary> SweepJournal::find(uint64_t key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = done_.find(key);
+  if (it == done_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void SweepJournal::append(uint64_t key, const RunSummary &summary) {
+  std::array<uint64_t, kWords> words = {
+      key,
+      std::bit_cast<uint64_t>(summary.final_equity),
+      std::bit_cast<uint64_t>(summary.total_return),
+      std::bit_cast<uint64_t>(summary.max_drawdown),
+      std::bit_cast<uint64_t>(summary.sharpe),
+      static_cast<uint64_t>(summary.n_bars),
+      0};
+  words[kWords - 1] = checksum(words);
+  std::array<uint8_t, kRecordBytes> record;
+  for (size_t i = 0; i < kWords; ++i) {
+    store(record.data() + 8 * i, words[i]);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!write_all(fd_, record.data(), record.size()) ||
+      (durable_ && ::fdatasync(fd_) != 0)) {
+    throw std::runtime_error("SweepJournal: append failed");
+  }
+  done_[key] = summary;
+}
+
+size_t SweepJournal::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return done_.size();
+}
+
+// ---- Resumable sweep ----
+
+SweepResult run_sweep(const std::vector<ParamSet> &params, const RunFn &run,
+                      const SweepConfig &config, SweepJournal &journal) {
+  if (!config.deterministic) {
+    throw std::invalid_argument(
+        "run_sweep: a journal requires deterministic mode");
+  }
+
+  SweepResult result;
+  result.runs.resize(params.size());
+  std::vector<size_t> todo;
+  for (size_t i = 0; i < params.size(); ++i) {
+    if (auto done = journal.find(run_key(params[i], config.seed, i))) {
+      result.runs[i] = *done;
+    } else {
+      todo.push_back(i);
+    }
+  }
+
+  parallel_for(todo.size(), config.threads, [&](size_t t, unsigned) {
+    const size_t i = todo[t];
+    CounterRng rng(config.seed, i);
+    result.runs[i] = summarize(run(params[i], rng));
+    journal.append(run_key(params[i], config.seed, i), result.runs[i]);
+  });
+
+  for (size_t i = 0; i < result.runs.size(); ++i) {
+    result.stats.add(i, result.runs[i]);
+  }
+  return result;
+}
+
+} // namespace ctrade
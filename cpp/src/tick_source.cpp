@@ -0,0 +1,42 @@
+#include "ctrade/tick_source.hpp"
+#include <functional>
+#include <stdexcept>
+
+namespace ctrade {
+
+size_t TickCache::KeyHash::operator()(const Key &k) const {
+  size_t h = std::hash<int64_t>{}(k.from_ts);
+  h ^= std::hash<int64_t>{}(k.to_ts) + 0x9e3779b97f4a7c15ULL + (h << 6);
+  h ^= std::hash<int>{}(k.asset_id) + 0x9e3779b97f4a7c15ULL + (h << 6);
+  return h;
+}
+
+TickCache::TickCache(TickSource &source, size_t capacity)
+    : source_(source), capacity_(capacity) {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("TickCache: capacity must be positive");
+  }
+}
+
+std::span<const Tick> TickCache::get(int asset_id, int64_t from_ts,
+                                     int64_t to_ts) {
+  const Key key{asset_id, from_ts, to_ts};
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return lru_.front().second;
+  }
+
+  ++loads_;
+  lru_.emplace_front(key, source_.load(asset_id, from_ts, to_ts));
+  index_[key] = lru_.begin();
+
+  if (lru_.size() > capacity_) {
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  return lru_.front().second;
+}
+
+} // namespace ctrade
@@ -0,0 +1,118 @@
+#include "ctrade/time_parallel.hpp"
+#include "ctrade/parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+struct Segment {
+  std::vector<uint8_t> start_state; // assumed at the boundary
+  std::vector<uint8_t> end_state;
+  BacktestResult rows;
+};
+
+std::vector<uint8_t> state_of(const ResumableBacktest &backtest) {
+  SnapshotWriter out;
+  backtest.save(out);
+  return out.bytes();
+}
+
+std::vector<int64_t> segment_boundaries(int64_t start_ts, int64_t end_ts,
+                                        size_t segments, int64_t align) {
+  // Count in whole alignment units so the products cannot overflow.
+  const int64_t units = (end_ts - start_ts) / align;
+  const auto n = static_cast<int64_t>(segments);
+  std::vector<int64_t> b{start_ts};
+  for (int64_t k = 1; k < n; ++k) {
+    const int64_t unit = units / n * k + units % n * k / n;
+    const int64_t at = start_ts + unit * align;
+    if (at > b.back()) {
+      b.push_back(at);
+    }
+  }
+  b.push_back(end_ts);
+  return b;
+}
+
+// Rebuilds equity and drawdown from pnl, left to right.
+void rebuild_equity(BacktestResult &result, double initial_equity) {
+  const size_t n = result.timestamps.size();
+  result.pnl.resize(n, 0.0);
+  result.equity.resize(n);
+  result.drawdown.resize(n);
+  double equity = initial_equity;
+  double peak = initial_equity;
+  for (size_t i = 0; i < n; ++i) {
+    equity += result.pnl[i];
+    peak = std::max(peak, equity);
+    result.equity[i] = equity;
+    result.drawdown[i] = peak > 0.0 ? (peak - equity) / peak : 0.0;
+  }
+}
+
+} // namespace
+
+TimeParallelResult run_time_parallel(const BacktestFactory &make,
+                                     int64_t start_ts, int64_t end_ts,
+                                     const TimeParallelConfig &config) {
+  if (end_ts < start_ts) {
+    throw std::invalid_argument("run_time_parallel: end before start");
+  }
+  if (config.align <= 0 || config.warmup < 0) {
+    throw std::invalid_argument(
+        "run_time_parallel: align must be positive and warmup non-negative");
+  }
+
+  TimeParallelResult out;
+  const size_t requested = config.segments > 0
+                               ? config.segments
+                               : resolve_threads(config.threads);
+  out.boundaries =
+      segment_boundaries(start_ts, end_ts, requested, config.align);
+  const size_t n = out.boundaries.size() - 1;
+  const auto &b = out.boundaries;
+
+  // ---- Speculate ----
+  std::vector<Segment> segments(n);
+  parallel_for(n, config.threads, [&](size_t k, unsigned) {
+    auto backtest = make();
+    if (k > 0) {
+      BacktestResult discarded;
+      backtest->run(std::max(start_ts, b[k] - config.warmup), b[k],
+                    discarded);
+    }
+    segments[k].start_state = state_of(*backtest);
+    backtest->run(b[k], b[k + 1], segments[k].rows);
+    segments[k].end_state = state_of(*backtest);
+  });
+
+  // ---- Verify and repair ----
+  for (size_t k = 1; k < n; ++k) {
+    if (segments[k].start_state == segments[k - 1].end_state) {
+      continue;
+    }
+    auto backtest = make();
+    SnapshotReader state(segments[k - 1].end_state);
+    backtest->load(state);
+    segments[k].rows = BacktestResult{};
+    backtest->run(b[k], b[k + 1], segments[k].rows);
+    segments[k].end_state = state_of(*backtest);
+    ++out.reruns;
+  }
+
+  // ---- Stitch ----
+  for (auto &segment : segments) {
+    auto &rows = segment.rows;
+    rows.pnl.resize(rows.timestamps.size(), 0.0);
+    auto &all = out.result;
+    all.timestamps.insert(all.timestamps.end(), rows.timestamps.begin(),
+                          rows.timestamps.end());
+    all.pnl.insert(all.pnl.end(), rows.pnl.begin(), rows.pnl.end());
+  }
+  rebuild_equity(out.result, config.initial_equity);
+  return out;
+}
+
+} // namespace ctrade
@@ -0,0 +1,397 @@
+#include "ctrade/tree_model.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+// Rows descending a tree together in predict(rows, out).
+constexpr size_t kBlock = 16;
+
+// LightGBM's kZeroThreshold.
+constexpr double kZero = 1e-35;
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// XGBoost goes left when float(x) < split. float(x) rounds to nearest, ties
+// to even, so that holds exactly for the doubles up to the midpoint between
+// split and the float below it; returns the largest of them.
+double xgboost_threshold(double value) {
+  const auto split = static_cast<float>(value);
+  const float below =
+      std::nextafter(split, -std::numeric_limits<float>::infinity());
+  if (std::isinf(below)) {
+    return std::nextafter(static_cast<double>(split), -kInf);
+  }
+  const double mid =
+      0.5 * (static_cast<double>(below) + static_cast<double>(split));
+  const bool tie_rounds_down = (std::bit_cast<uint32_t>(below) & 1) == 0;
+  return tie_rounds_down ? mid : std::nextafter(mid, -kInf);
+}
+
+std::vector<std::string> split_fields(const std::string &value) {
+  std::vector<std::string> fields;
+  std::istringstream in(value);
+  std::string field;
+  while (in >> field) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+template <typename T>
+std::vector<T> parse_list(const std::map<std::string, std::string> &block,
+                          const std::string &key, size_t expected) {
+  std::vector<T> values;
+  auto it = block.find(key);
+  if (it != block.end()) {
+    for (const auto &field : split_fields(it->second)) {
+      values.push_back(static_cast<T>(std::stod(field)));
+    }
+  }
+  if (values.size() != expected) {
+    throw std::runtime_error("parse_lightgbm_model: bad " + key);
+  }
+  return values;
+}
+
+Tree lightgbm_tree(const std::map<std::string, std::string> &block) {
+  auto num_leaves = block.find("num_leaves");
+  if (num_leaves == block.end()) {
+    throw std::runtime_error("parse_lightgbm_model: tree without num_leaves");
+  }
+  auto num_cat = block.find("num_cat");
+  if (num_cat != block.end() && std::stoi(num_cat->second) != 0) {
+    throw std::runtime_error(
+        "parse_lightgbm_model: categorical splits are not supported");
+  }
+
+  const size_t n_leaves = std::stoul(num_leaves->second);
+  if (n_leaves == 0) {
+    throw std::runtime_error("parse_lightgbm_model: tree without leaves");
+  }
+  const size_t n_nodes = n_leaves - 1;
+  Tree tree;
+  tree.leaves = parse_list<double>(block, "leaf_value", n_leaves);
+  if (n_nodes == 0) {
+    return tree;
+  }
+
+  auto features = parse_list<int>(block, "split_feature", n_nodes);
+  auto thresholds = parse_list<double>(block, "threshold", n_nodes);
+  auto decisions = parse_list<int>(block, "decision_type", n_nodes);
+  auto lefts = parse_list<int>(block, "left_child", n_nodes);
+  auto rights = parse_list<int>(block, "right_child", n_nodes);
+  for (size_t i = 0; i < n_nodes; ++i) {
+    const int decision = decisions[i];
+    if (decision & 1) {
+      throw std::runtime_error(
+          "parse_lightgbm_model: categorical splits are not supported");
+    }
+    const int missing = (decision >> 2) & 3; // 0 none, 1 zero, 2 NaN
+    tree.nodes.push_back({features[i], thresholds[i], lefts[i], rights[i],
+                          (decision & 2) != 0, missing == 2, missing == 1});
+  }
+  return tree;
+}
+
+} // namespace
+
+// ---- TreeEnsemble ----
+
+TreeEnsemble::TreeEnsemble(const std::vector<Tree> &trees, double base_score,
+                           TreeOutput output, double sigmoid_scale)
+    : base_score_(base_score), output_(output),
+      sigmoid_scale_(sigmoid_scale) {
+  for (const auto &tree : trees) {
+    const auto node_base = static_cast<int32_t>(splits_.size());
+    const auto leaf_base = static_cast<int32_t>(leaves_.size());
+    const auto n_nodes = static_cast<int32_t>(tree.nodes.size());
+    const auto n_leaves = static_cast<int32_t>(tree.leaves.size());
+    if (n_leaves == 0 || n_leaves != n_nodes + 1) {
+      throw std::invalid_argument(
+          "TreeEnsemble: a tree needs one more leaf than splits");
+    }
+
+    auto child = [&](int c) {
+      if (c >= n_nodes || c < -n_leaves || c == 0) {
+        throw std::invalid_argument("TreeEnsemble: child out of range");
+      }
+      return c > 0 ? node_base + c : ~(leaf_base + ~c);
+    };
+    for (const auto &node : tree.nodes) {
+      if (node.feature < 0) {
+        throw std::invalid_argument("TreeEnsemble: negative feature index");
+      }
+      // Without nan_missing, NaN reads as 0 and follows the comparison.
+      const bool nan_left =
+          node.nan_missing || node.zero_missing ? node.default_left
+                                                : 0.0 <= node.threshold;
+      splits_.push_back({node.threshold,
+                         node.feature,
+                         {child(node.left), child(node.right)},
+                         static_cast<uint8_t>(nan_left ? 0 : 1),
+                         node.zero_missing});
+      zero_missing_ |= node.zero_missing;
+      n_features_ =
+          std::max(n_features_, static_cast<size_t>(node.feature) + 1);
+    }
+    leaves_.insert(leaves_.end(), tree.leaves.begin(), tree.leaves.end());
+    roots_.push_back(n_nodes > 0 ? node_base : ~leaf_base);
+
+    // Longest root-to-leaf path; also rejects cycles.
+    int32_t depth = 0;
+    std::vector<std::pair<int32_t, int32_t>> stack;
+    if (n_nodes > 0) {
+      stack.emplace_back(0, 1);
+    }
+    while (!stack.empty()) {
+      const auto [at, level] = stack.back();
+      stack.pop_back();
+      if (level > n_nodes) {
+        throw std::invalid_argument("TreeEnsemble: tree has a cycle");
+      }
+      depth = std::max(depth, level);
+      for (int c : {tree.nodes[at].left, tree.nodes[at].right}) {
+        if (c > 0) {
+          stack.emplace_back(c, level + 1);
+        }
+      }
+    }
+    depth_.push_back(depth);
+  }
+}
+
+// LightGBM's numerical decision rule; the selects compile to conditional
+// moves.
+int32_t TreeEnsemble::step(const Split &split, double x) const {
+  if (zero_missing_ && split.zero_missing && std::fabs(x) <= kZero) {
+    return split.child[split.nan_child];
+  }
+  return split.child[std::isnan(x) ? split.nan_child : !(x <= split.threshold)];
+}
+
+double TreeEnsemble::finish(double raw) const {
+  if (output_ == TreeOutput::Sigmoid) {
+    return 1.0 / (1.0 + std::exp(-sigmoid_scale_ * raw));
+  }
+  return raw;
+}
+
+double TreeEnsemble::predict(std::span<const double> row) const {
+  if (row.size() < n_features_) {
+    throw std::invalid_argument("TreeEnsemble::predict: row too short");
+  }
+  double raw = base_score_;
+  for (int32_t node : roots_) {
+    while (node >= 0) {
+      const Split &split = splits_[node];
+      node = step(split, row[split.feature]);
+    }
+    raw += leaves_[~node];
+  }
+  return finish(raw);
+}
+
+void TreeEnsemble::predict(std::span<const double> rows,
+                           std::span<double> out) const {
+  const size_t n = out.size();
+  const size_t stride = n > 0 ? rows.size() / n : 0;
+  if (n > 0 && (rows.size() % n != 0 || stride < n_features_)) {
+    throw std::invalid_argument(
+        "TreeEnsemble::predict: rows must be n x n_features row-major");
+  }
+
+  std::fill(out.begin(), out.end(), base_score_);
+  int32_t node[kBlock];
+  for (size_t begin = 0; begin < n; begin += kBlock) {
+    const size_t count = std::min(kBlock, n - begin);
+    const double *block = rows.data() + begin * stride;
+    for (size_t t = 0; t < roots_.size(); ++t) {
+      std::fill(node, node + count, roots_[t]);
+      // Rows that reach a leaf early idle on split 0 and keep their leaf.
+      for (int32_t level = 0; level < depth_[t]; ++level) {
+        for (size_t r = 0; r < count; ++r) {
+          const int32_t at = node[r];
+          const Split &split = splits_[std::max(at, 0)];
+          const int32_t next = step(split, block[r * stride + split.feature]);
+          node[r] = at >= 0 ? next : at;
+        }
+      }
+      for (size_t r = 0; r < count; ++r) {
+        out[begin + r] += leaves_[~node[r]];
+      }
+    }
+    for (size_t r = 0; r < count; ++r) {
+      out[begin + r] = finish(out[begin + r]);
+    }
+  }
+}
+
+// ---- Parsers ----
+
+TreeEnsemble parse_lightgbm_model(const std::string &text) {
+  std::istringstream in(text);
+  std::string line;
+  std::map<std::string, std::string> header;
+  std::vector<std::map<std::string, std::string>> blocks;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line == "end of trees") {
+      break;
+    }
+    const auto eq = line.find('=');
+    if (eq == std::string::npos) {
+      continue;
+    }
+    const std::string key = line.substr(0, eq);
+    if (key == "Tree") {
+      blocks.emplace_back();
+      continue;
+    }
+    auto &target = blocks.empty() ? header : blocks.back();
+    target.emplace(key, line.substr(eq + 1));
+  }
+  if (blocks.empty()) {
+    throw std::runtime_error("parse_lightgbm_model: no trees");
+  }
+
+  auto num_class = header.find("num_class");
+  if (num_class != header.end() && std::stoi(num_class->second) != 1) {
+    throw std::runtime_error(
+        "parse_lightgbm_model: multiclass models are not supported");
+  }
+
+  TreeOutput output = TreeOutput::Raw;
+  double scale = 1.0;
+  auto objective = header.find("objective");
+  if (objective != header.end()) {
+    auto fields = split_fields(objective->second);
+    if (!fields.empty() && (fields[0] == "binary" ||
+                            fields[0] == "cross_entropy")) {
+      output = TreeOutput::Sigmoid;
+      for (const auto &field : fields) {
+        if (field.rfind("sigmoid:", 0) == 0) {
+          scale = std::stod(field.substr(8));
+        }
+      }
+    }
+  }
+
+  std::vector<Tree> trees;
+  for (const auto &block : blocks) {
+    trees.push_back(lightgbm_tree(block));
+  }
+  return TreeEnsemble(trees, 0.0, output, scale);
+}
+
+TreeEnsemble parse_xgboost_dump(const std::string &text, double base_score,
+                                TreeOutput output) {
+  struct Entry {
+    bool leaf;
+    double value; // leaf value or split condition
+    int feature;
+    int yes, no, missing;
+  };
+  std::vector<std::map<int, Entry>> dumps;
+
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto start = line.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+      continue;
+    }
+    line = line.substr(start);
+    if (line.rfind("booster[", 0) == 0) {
+      dumps.emplace_back();
+      continue;
+    }
+    if (dumps.empty()) {
+      throw std::runtime_error("parse_xgboost_dump: node before booster");
+    }
+
+    const auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      throw std::runtime_error("parse_xgboost_dump: bad line: " + line);
+    }
+    const int id = std::stoi(line.substr(0, colon));
+    Entry entry{};
+    const std::string rest = line.substr(colon + 1);
+    if (rest.rfind("leaf=", 0) == 0) {
+      entry.leaf = true;
+      entry.value = std::stod(rest.substr(5));
+    } else {
+      const auto lt = rest.find('<');
+      const auto close = rest.find(']');
+      if (rest.empty() || rest[0] != '[' || rest[1] != 'f' ||
+          lt == std::string::npos || close == std::string::npos) {
+        throw std::runtime_error("parse_xgboost_dump: bad split: " + line);
+      }
+      entry.feature = std::stoi(rest.substr(2, lt - 2));
+      entry.value = std::stod(rest.substr(lt + 1, close - lt - 1));
+      auto field = [&](const std::string &name) {
+        const auto at = rest.find(name + "=");
+        if (at == std::string::npos) {
+          throw std::runtime_error("parse_xgboost_dump: missing " + name);
+        }
+        return std::stoi(rest.substr(at + name.size() + 1));
+      };
+      entry.yes = field("yes");
+      entry.no = field("no");
+      entry.missing = field("missing");
+    }
+    dumps.back()[id] = entry;
+  }
+  if (dumps.empty()) {
+    throw std::runtime_error("parse_xgboost_dump: no trees");
+  }
+
+  std::vector<Tree> trees;
+  for (const auto &dump : dumps) {
+    // Number splits and leaves depth-first from the root, so the root is
+    // node 0.
+    Tree tree;
+    std::set<int> seen;
+    std::function<int(int)> add = [&](int id) -> int {
+      auto it = dump.find(id);
+      if (it == dump.end()) {
+        throw std::runtime_error("parse_xgboost_dump: missing node " +
+                                 std::to_string(id));
+      }
+      // A node reached twice means a cycle or a shared subtree.
+      if (!seen.insert(id).second) {
+        throw std::runtime_error("parse_xgboost_dump: node " +
+                                 std::to_string(id) + " reached twice");
+      }
+      const Entry &entry = it->second;
+      if (entry.leaf) {
+        tree.leaves.push_back(entry.value);
+        return ~static_cast<int>(tree.leaves.size() - 1);
+      }
+      const int index = static_cast<int>(tree.nodes.size());
+      tree.nodes.push_back({entry.feature, xgboost_threshold(entry.value), 0,
+                            0, entry.missing == entry.yes, true, false});
+      const int left = add(entry.yes);
+      const int right = add(entry.no);
+      tree.nodes[index].left = left;
+      tree.nodes[index].right = right;
+      return index;
+    };
+    add(0);
+    trees.push_back(std::move(tree));
+  }
+  return TreeEnsemble(trees, base_score, output);
+}
+
+} // namespace ctrade
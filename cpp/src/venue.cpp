@@ -0,0 +1,223 @@
+#include "ctrade/venue.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace ctrade {
+
+namespace {
+
+bool is_perp(const VenueSpec &venue) {
+  return venue.kind == VenueKind::UsdtPerp;
+}
+
+} // namespace
+
+// ---- VenueAccounts ----
+
+VenueAccounts::VenueAccounts(std::vector<VenueSpec> venues, size_t n_assets)
+    : venues_(std::move(venues)), n_assets_(n_assets),
+      position_(venues_.size() * n_assets, 0.0),
+      entry_(venues_.size() * n_assets, 0.0),
+      mark_(venues_.size() * n_assets, 0.0),
+      books_(venues_.size() * n_assets) {
+  for (const auto &venue : venues_) {
+    if (is_perp(venue) && venue.leverage <= 0.0) {
+      throw std::invalid_argument("VenueAccounts: leverage must be positive");
+    }
+    balance_.push_back(venue.initial_balance);
+  }
+}
+
+size_t VenueAccounts::index(int venue_id, int asset_id) const {
+  if (venue_id < 0 || static_cast<size_t>(venue_id) >= venues_.size() ||
+      asset_id < 0 || static_cast<size_t>(asset_id) >= n_assets_) {
+    throw std::out_of_range("VenueAccounts: venue or asset out of range");
+  }
+  return static_cast<size_t>(venue_id) * n_assets_ +
+         static_cast<size_t>(asset_id);
+}
+
+const VenueSpec &VenueAccounts::venue(int venue_id) const {
+  return venues_.at(static_cast<size_t>(venue_id));
+}
+
+bool VenueAccounts::can_fill(const Order &order, double price) const {
+  const size_t i = index(order.venue_id, order.asset_id);
+  const auto &venue = venues_[order.venue_id];
+  const bool buy = order.side == Side::Buy;
+
+  if (!is_perp(venue)) {
+    if (buy) {
+      const double cost = order.size * price * (1.0 + venue.fees.taker);
+      return balance_[order.venue_id] >= cost;
+    }
+    return position_[i] >= order.size;
+  }
+
+  const double after = position_[i] + (buy ? order.size : -order.size);
+  const double added = std::abs(after) - std::abs(position_[i]);
+  if (added <= 0.0) {
+    return true;
+  }
+  const double required = added * price / venue.leverage +
+                          order.size * price * venue.fees.taker;
+  return free_margin(order.venue_id) >= required;
+}
+
+void VenueAccounts::apply_fill(const Fill &fill, Side side) {
+  const size_t i = index(fill.venue_id, fill.asset_id);
+  const auto &venue = venues_[fill.venue_id];
+  double &balance = balance_[fill.venue_id];
+  double &position = position_[i];
+  double &entry = entry_[i];
+  const double signed_size = side == Side::Buy ? fill.size : -fill.size;
+
+  balance -= fill.fee;
+
+  if (!is_perp(venue)) {
+    if (position + signed_size < -1e-12) {
+      throw std::runtime_error("VenueAccounts: spot position cannot go short");
+    }
+    balance -= signed_size * fill.price;
+    if (signed_size > 0.0) {
+      entry = (position * entry + signed_size * fill.price) /
+              (position + signed_size);
+    }
+    position += signed_size;
+    if (position <= 0.0) {
+      entry = 0.0;
+    }
+    return;
+  }
+
+  const bool adds = position == 0.0 || (position > 0.0) == (signed_size > 0.0);
+  if (adds) {
+    const double total = std::abs(position) + fill.size;
+    entry = (std::abs(position) * entry + fill.size * fill.price) / total;
+    position += signed_size;
+    return;
+  }
+
+  const double closed = std::min(fill.size, std::abs(position));
+  const double direction = position > 0.0 ? 1.0 : -1.0;
+  balance += closed * (fill.price - entry) * direction;
+  position += signed_size;
+  if (std::abs(position) <= 1e-12) {
+    position = 0.0;
+    entry = 0.0;
+  } else if ((position > 0.0) != (direction > 0.0)) {
+    entry = fill.price; // flipped: the remainder opened at this fill
+  }
+}
+
+void VenueAccounts::mark(const MarketState &market) {
+  const size_t i = index(market.venue_id, market.asset_id);
+  mark_[i] = market.mark_price > 0.0 ? market.mark_price : market.close;
+}
+
+void VenueAccounts::apply_funding(const FundingEvent &event) {
+  const size_t i = index(event.venue_id, event.asset_id);
+  if (!is_perp(venues_[event.venue_id])) {
+    return;
+  }
+  balance_[event.venue_id] -= position_[i] * event.mark_price * event.rate;
+}
+
+double VenueAccounts::position(int venue_id, int asset_id) const {
+  return position_[index(venue_id, asset_id)];
+}
+
+double VenueAccounts::entry_price(int venue_id, int asset_id) const {
+  return entry_[index(venue_id, asset_id)];
+}
+
+double VenueAccounts::equity(int venue_id) const {
+  const size_t base = index(venue_id, 0);
+  const bool perp = is_perp(venues_[venue_id]);
+  double equity = balance_[venue_id];
+  for (size_t a = 0; a < n_assets_; ++a) {
+    const size_t i = base + a;
+    equity += perp ? position_[i] * (mark_[i] - entry_[i])
+                   : position_[i] * mark_[i];
+  }
+  return equity;
+}
+
+double VenueAccounts::total_equity() const {
+  double total = 0.0;
+  for (size_t v = 0; v < venues_.size(); ++v) {
+    total += equity(static_cast<int>(v));
+  }
+  return total;
+}
+
+double VenueAccounts::initial_margin(int venue_id) const {
+  const auto &venue = venues_.at(venue_id);
+  if (!is_perp(venue)) {
+    return 0.0;
+  }
+  const size_t base = index(venue_id, 0);
+  double notional = 0.0;
+  for (size_t a = 0; a < n_assets_; ++a) {
+    notional += std::abs(position_[base + a]) * mark_[base + a];
+  }
+  return notional / venue.leverage;
+}
+
+double VenueAccounts::maintenance_margin(int venue_id) const {
+  const auto &venue = venues_.at(venue_id);
+  if (!is_perp(venue)) {
+    return 0.0;
+  }
+  const size_t base = index(venue_id, 0);
+  double notional = 0.0;
+  for (size_t a = 0; a < n_assets_; ++a) {
+    notional += std::abs(position_[base + a]) * mark_[base + a];
+  }
+  return notional * venue.maintenance_margin;
+}
+
+double VenueAccounts::free_margin(int venue_id) const {
+  if (!is_perp(venues_.at(venue_id))) {
+    return balance_[venue_id];
+  }
+  return equity(venue_id) - initial_margin(venue_id);
+}
+
+OrderBook &VenueAccounts::book(int venue_id, int asset_id) {
+  return books_[index(venue_id, asset_id)];
+}
+
+// ---- MultiVenueExecutionEngine ----
+
+MultiVenueExecutionEngine::MultiVenueExecutionEngine(
+    std::vector<ExecutionEngine *> venues)
+    : venues_(std::move(venues)) {}
+
+std::vector<Fill>
+MultiVenueExecutionEngine::execute(const std::vector<Order> &orders,
+                                   const MarketState &market) {
+  if (market.venue_id < 0 ||
+      static_cast<size_t>(market.venue_id) >= venues_.size()) {
+    throw std::out_of_range("MultiVenueExecutionEngine: unknown venue");
+  }
+
+  routed_.clear();
+  for (const auto &order : orders) {
+    if (order.venue_id == market.venue_id &&
+        order.asset_id == market.asset_id) {
+      routed_.push_back(order);
+    }
+  }
+  if (routed_.empty()) {
+    return {};
+  }
+
+  auto fills = venues_[market.venue_id]->execute(routed_, market);
+  for (auto &fill : fills) {
+    fill.venue_id = market.venue_id;
+  }
+  return fills;
+}
+
+} // namespace ctrade
@@ -0,0 +1,68 @@
+#pragma once
+// Test data shared by several test executables. Everything here is
+// deterministic in its arguments, so tests can compare runs across
+// processes and thread counts.
+#include "ctrade/bar_store.hpp"
+#include "ctrade/rng.hpp"
+#include "ctrade/sweep.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Random-walk equity curve whose drift is the first parameter
+inline ctrade::BacktestResult random_walk(const ctrade::ParamSet& params, ctrade::CounterRng& rng) {
+    ctrade::BacktestResult result;
+    double equity = 10000.0;
+    for (int i = 0; i < 300; ++i) {
+        equity *= 1.0 + params[0] + 0.01 * rng.normal();
+        result.timestamps.push_back(i);
+        result.equity.push_back(equity);
+    }
+    return result;
+}
+
+// Forty drifts from -0.2% to +0.19% per bar
+inline std::vector<ctrade::ParamSet> drift_grid() {
+    std::vector<ctrade::ParamSet> params;
+    for (int i = 0; i < 40; ++i) {
+        params.push_back({0.0001 * (i - 20)});
+    }
+    return params;
+}
+
+// One-minute bars for asset `stream`, alternating calm and volatile regimes
+// every 5000 bars so some windows skip whole chunks. Volume straddles 1 and
+// funding straddles 1e-4, for rules that filter on either.
+inline ctrade::BarStore random_bars(size_t n, uint64_t stream) {
+    ctrade::CounterRng rng(11, stream);
+    ctrade::BarStore store(static_cast<int>(stream));
+    double close = 100.0;
+    for (size_t i = 0; i < n; ++i) {
+        ctrade::MarketState bar{};
+        bar.asset_id = static_cast<int>(stream);
+        bar.timestamp = static_cast<int64_t>(i) * 60;
+        bar.open = close;
+        const double vol = (i / 5000) % 2 == 0 ? 0.0002 : 0.003;
+        close *= std::exp(vol * rng.normal());
+        bar.close = close;
+        bar.high = std::max(bar.open, close) * (1.0 + vol * rng.uniform());
+        bar.low = std::min(bar.open, close) * (1.0 - vol * rng.uniform());
+        bar.volume = 10.0 * rng.uniform();
+        bar.funding_rate = 2e-4 * rng.normal();
+        store.append(bar);
+    }
+    return store;
+}
+
+// Fresh, empty directory path for an on-disk store, unique per process
+inline std::string store_dir(const char* name) {
+    auto dir = std::filesystem::temp_directory_path() /
+               ("ctrade-test-" + std::to_string(::getpid()) + "-" + name);
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
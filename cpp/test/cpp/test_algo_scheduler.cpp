@@ -0,0 +1,305 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/algo_scheduler.hpp"
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+struct SentOrder {
+    int64_t id;
+    bool buy;
+    double size;
+    double price; // 0 for market orders
+};
+
+// Records child orders and hands out sequential ids
+class MockExecutionContext : public ctrade::ExecutionContext {
+public:
+    int64_t market_buy(double size) override { return record(true, size, 0.0); }
+    int64_t market_sell(double size) override { return record(false, size, 0.0); }
+    int64_t limit_buy(double size, double price) override { return record(true, size, price); }
+    int64_t limit_sell(double size, double price) override { return record(false, size, price); }
+    int64_t stop_buy(double, double) override { return 0; }
+    int64_t stop_sell(double, double) override { return 0; }
+    int64_t stop_limit_buy(double, double, double) override { return 0; }
+    int64_t stop_limit_sell(double, double, double) override { return 0; }
+    void close_position() override {}
+    void close_long() override {}
+    void close_short() override {}
+    void close_amount(double) override {}
+    void set_target_weights(std::span<const double>) override {}
+    void set_target_positions(std::span<const double>) override {}
+    void cancel_order(int64_t order_id) override { cancelled.push_back(order_id); }
+    void cancel_all() override {}
+    void amend_order(int64_t, double, double) override {}
+    int64_t submit_parent_order(const ctrade::ParentOrder&) override { return 0; }
+    void cancel_parent_order(int64_t) override {}
+    int64_t schedule_timer(int64_t) override { return 0; }
+    void set_leverage(int) override {}
+    void set_cross_mode() override {}
+    void set_isolated_mode() override {}
+
+    std::vector<SentOrder> sent;
+    std::vector<int64_t> cancelled;
+
+private:
+    int64_t record(bool buy, double size, double price) {
+        sent.push_back({next_id_, buy, size, price});
+        return next_id_++;
+    }
+
+    int64_t next_id_ = 100;
+};
+
+static ctrade::MarketState bar(int64_t timestamp, double volume = 0.0) {
+    ctrade::MarketState m{};
+    m.timestamp = timestamp;
+    m.volume = volume;
+    return m;
+}
+
+static ctrade::Fill fill_of(int64_t order_id, double size, int64_t timestamp = 0) {
+    ctrade::Fill f{};
+    f.order_id = order_id;
+    f.size = size;
+    f.timestamp = timestamp;
+    return f;
+}
+
+TEST_CASE("TWAP sends equal slices at slice boundaries", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder twap;
+    twap.side = ctrade::Side::Sell;
+    twap.size = 8.0;
+    twap.start_ts = 0;
+    twap.end_ts = 240;
+    twap.slices = 4;
+    int64_t id = algos.submit(twap);
+
+    for (int64_t ts = 0; ts < 300; ts += 30) {
+        algos.on_bar(bar(ts));
+    }
+
+    REQUIRE(ctx.sent.size() == 4);
+    for (const auto& order : ctx.sent) {
+        REQUIRE_FALSE(order.buy);
+        REQUIRE(order.size == Approx(2.0));
+        REQUIRE(order.price == 0.0);
+    }
+    REQUIRE(algos.status(id).sent == Approx(8.0));
+    REQUIRE(algos.next_wake(0) == std::numeric_limits<int64_t>::max());
+}
+
+TEST_CASE("VWAP follows the volume profile and catches up", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder vwap;
+    vwap.algo = ctrade::ParentAlgo::VWAP;
+    vwap.size = 10.0;
+    vwap.start_ts = 0;
+    vwap.end_ts = 300;
+    vwap.slices = 3;
+    vwap.volume_profile = {1.0, 3.0, 1.0};
+    algos.submit(vwap);
+
+    algos.on_bar(bar(0));
+    REQUIRE(algos.next_wake(0) == 100);
+
+    // No bar in the second slice: the next bar sends both remaining slices
+    algos.on_bar(bar(250));
+
+    REQUIRE(ctx.sent.size() == 2);
+    REQUIRE(ctx.sent[0].size == Approx(2.0));
+    REQUIRE(ctx.sent[1].size == Approx(8.0));
+}
+
+TEST_CASE("Unfilled limit children count toward the schedule", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder twap;
+    twap.size = 4.0;
+    twap.limit_price = 99.0;
+    twap.start_ts = 0;
+    twap.end_ts = 200;
+    twap.slices = 2;
+    int64_t id = algos.submit(twap);
+
+    algos.on_bar(bar(0));
+    ctrade::TriggerLevels levels;
+    algos.trigger_levels(0, levels);
+    REQUIRE(levels.falling == std::vector<double>{99.0});
+    REQUIRE(levels.rising.empty());
+
+    algos.on_bar(bar(100));
+    REQUIRE(ctx.sent.size() == 2);
+    REQUIRE(ctx.sent[1].size == Approx(2.0));
+    REQUIRE(ctx.sent[1].price == Approx(99.0));
+
+    REQUIRE(algos.on_fill(fill_of(ctx.sent[0].id, 2.0)));
+    REQUIRE(algos.on_fill(fill_of(ctx.sent[1].id, 2.0)));
+    REQUIRE(algos.status(id).done);
+    REQUIRE_FALSE(algos.on_fill(fill_of(7, 1.0)));
+}
+
+TEST_CASE("POV sizes children from bar volume", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder pov;
+    pov.algo = ctrade::ParentAlgo::POV;
+    pov.size = 5.0;
+    pov.participation = 0.1;
+    pov.start_ts = 60;
+    algos.submit(pov);
+    REQUIRE(algos.needs_every_bar(0));
+    REQUIRE_FALSE(algos.needs_every_bar(1));
+
+    algos.on_bar(bar(0, 100.0)); // before start
+    algos.on_bar(bar(60, 20.0));
+    algos.on_bar(bar(120, 40.0)); // capped by the remaining size
+    algos.on_bar(bar(180, 100.0));
+
+    REQUIRE(ctx.sent.size() == 2);
+    REQUIRE(ctx.sent[0].size == Approx(2.0));
+    REQUIRE(ctx.sent[1].size == Approx(3.0));
+}
+
+TEST_CASE("Iceberg replenishes its display on fills", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder iceberg;
+    iceberg.algo = ctrade::ParentAlgo::Iceberg;
+    iceberg.size = 5.0;
+    iceberg.limit_price = 101.0;
+    iceberg.display_size = 2.0;
+    int64_t id = algos.submit(iceberg);
+
+    algos.on_bar(bar(0));
+    algos.on_bar(bar(60)); // display still working: nothing new
+    REQUIRE(ctx.sent.size() == 1);
+
+    algos.on_fill(fill_of(ctx.sent[0].id, 1.5));
+    REQUIRE(ctx.sent.size() == 1);
+    algos.on_fill(fill_of(ctx.sent[0].id, 0.5));
+    REQUIRE(ctx.sent.size() == 2);
+    algos.on_fill(fill_of(ctx.sent[1].id, 2.0));
+    REQUIRE(ctx.sent.size() == 3);
+    REQUIRE(ctx.sent[2].size == Approx(1.0));
+    REQUIRE(ctx.sent[2].price == Approx(101.0));
+
+    algos.on_fill(fill_of(ctx.sent[2].id, 1.0));
+    REQUIRE(algos.status(id).done);
+    REQUIRE(algos.status(id).filled == Approx(5.0));
+}
+
+TEST_CASE("Cancelling a parent cancels its working children", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder iceberg;
+    iceberg.algo = ctrade::ParentAlgo::Iceberg;
+    iceberg.size = 5.0;
+    iceberg.limit_price = 101.0;
+    iceberg.display_size = 2.0;
+    int64_t id = algos.submit(iceberg);
+    algos.on_bar(bar(0));
+
+    algos.cancel(id);
+    REQUIRE(ctx.cancelled == std::vector<int64_t>{ctx.sent[0].id});
+    REQUIRE(algos.status(id).done);
+
+    algos.on_bar(bar(60));
+    REQUIRE(ctx.sent.size() == 1);
+}
+
+// Routes orders by asset and venue, as a multi-asset engine does
+class RoutingExecutionContext : public MockExecutionContext {
+public:
+    int64_t submit_order(const ctrade::Order& order) override {
+        assets.push_back(order.asset_id);
+        venues.push_back(order.venue_id);
+        ctrade::Order local = order;
+        local.asset_id = 0;
+        local.venue_id = 0;
+        return MockExecutionContext::submit_order(local);
+    }
+
+    std::vector<int> assets;
+    std::vector<int> venues;
+};
+
+TEST_CASE("Children go to their parent's asset and venue", "[algo]") {
+    RoutingExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder first;
+    first.algo = ctrade::ParentAlgo::POV;
+    first.asset_id = 0;
+    first.size = 10.0;
+    first.participation = 0.5;
+    ctrade::ParentOrder second = first;
+    second.asset_id = 1;
+    second.venue_id = 2;
+    second.side = ctrade::Side::Sell;
+    second.limit_price = 50.0;
+    algos.submit(first);
+    algos.submit(second);
+
+    auto b = bar(0, 4.0);
+    algos.on_bar(b);
+    b.asset_id = 1;
+    algos.on_bar(b);
+
+    REQUIRE(ctx.assets == std::vector<int>{0, 1});
+    REQUIRE(ctx.venues == std::vector<int>{0, 2});
+    REQUIRE(ctx.sent.size() == 2);
+    REQUIRE(ctx.sent[0].buy);
+    REQUIRE(ctx.sent[0].price == 0.0);
+    REQUIRE_FALSE(ctx.sent[1].buy);
+    REQUIRE(ctx.sent[1].price == Approx(50.0));
+
+    // A single-asset context refuses children it cannot route
+    MockExecutionContext single;
+    ctrade::AlgoScheduler single_algos(single);
+    single_algos.submit(second);
+    REQUIRE_THROWS_AS(single_algos.on_bar(b), std::invalid_argument);
+    REQUIRE(single.sent.empty());
+}
+
+TEST_CASE("Invalid parents are rejected", "[algo]") {
+    MockExecutionContext ctx;
+    ctrade::AlgoScheduler algos(ctx);
+
+    ctrade::ParentOrder iceberg;
+    iceberg.algo = ctrade::ParentAlgo::Iceberg;
+    iceberg.size = 1.0;
+    REQUIRE_THROWS(algos.submit(iceberg));
+
+    ctrade::ParentOrder vwap;
+    vwap.algo = ctrade::ParentAlgo::VWAP;
+    vwap.size = 1.0;
+    vwap.end_ts = 100;
+    vwap.slices = 2;
+    vwap.volume_profile = {1.0};
+    REQUIRE_THROWS(algos.submit(vwap));
+}
+
+TEST_CASE("Intraday volume profile buckets by time of period", "[algo]") {
+    std::vector<ctrade::MarketState> history;
+    for (int day = 0; day < 2; ++day) {
+        history.push_back(bar(day * 1000 + 100, 30.0));
+        history.push_back(bar(day * 1000 + 600, 10.0));
+    }
+
+    auto profile = ctrade::intraday_volume_profile(history, 1000, 2);
+    REQUIRE(profile.size() == 2);
+    REQUIRE(profile[0] == Approx(0.75));
+    REQUIRE(profile[1] == Approx(0.25));
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/bar_store.hpp"
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+// Flat market around `mid` with one spike bar
+static ctrade::BarStore make_store(size_t n, size_t spike, double mid = 100.0) {
+    ctrade::BarStore store(0, 16);
+    for (size_t i = 0; i < n; ++i) {
+        ctrade::MarketState s{};
+        s.timestamp = static_cast<int64_t>(i) * 60;
+        s.open = mid;
+        s.close = mid;
+        s.low = mid - 1.0;
+        s.high = i == spike ? mid + 10.0 : mid + 1.0;
+        s.volume = 1.0;
+        store.append(s);
+    }
+    return store;
+}
+
+TEST_CASE("BarStore keeps per-block zone maps", "[bar_store]") {
+    auto store = make_store(40, 20);
+
+    REQUIRE(store.size() == 40);
+    REQUIRE(store.n_blocks() == 3);
+    REQUIRE(store.block_high(0) == Approx(101.0));
+    REQUIRE(store.block_high(1) == Approx(110.0));
+    REQUIRE(store.block_low(2) == Approx(99.0));
+}
+
+TEST_CASE("BarStore rejects out-of-order bars", "[bar_store]") {
+    auto store = make_store(2, 99);
+
+    ctrade::MarketState s{};
+    s.timestamp = 0;
+    REQUIRE_THROWS_AS(store.append(s), std::invalid_argument);
+}
+
+TEST_CASE("next_touch finds the first bar crossing a level", "[bar_store]") {
+    auto store = make_store(40, 20);
+    std::vector<double> levels = {105.0};
+
+    REQUIRE(store.next_touch(0, store.size(), levels) == 20);
+    REQUIRE(store.next_touch(21, store.size(), levels) == store.size());
+
+    std::vector<double> inside = {50.0, 100.5};
+    REQUIRE(store.next_touch(3, store.size(), inside) == 3);
+
+    std::vector<double> none;
+    REQUIRE(store.next_touch(0, 10, none) == 10);
+}
+
+TEST_CASE("next_touch sees levels jumped over by a gap", "[bar_store]") {
+    // Bars around 100, then from bar 20 a gap down to 97-98
+    ctrade::BarStore store(0, 16);
+    for (size_t i = 0; i < 40; ++i) {
+        ctrade::MarketState s{};
+        s.timestamp = static_cast<int64_t>(i) * 60;
+        s.low = i >= 20 ? 97.0 : 99.5;
+        s.high = i >= 20 ? 98.0 : 100.5;
+        s.close = i >= 20 ? 97.5 : 100.0;
+        store.append(s);
+    }
+    std::vector<double> levels = {99.0};
+
+    REQUIRE(store.block_low(1) == Approx(97.0));
+    REQUIRE(store.block_high(1) == Approx(100.5));
+    REQUIRE(store.next_touch(0, store.size(), levels) == 20);
+    REQUIRE(store.next_touch(21, store.size(), levels) == store.size());
+}
+
+TEST_CASE("BarStoreMarketData skips quiet bars up to a deadline", "[bar_store]") {
+    auto store = make_store(40, 20);
+    ctrade::BarStoreMarketData data(store);
+    std::vector<double> levels = {105.0};
+
+    REQUIRE(data.next());
+    data.skip_quiet(levels, 1000000);
+    REQUIRE(data.next());
+    REQUIRE(data.current().timestamp == 20 * 60);
+    REQUIRE(data.current().high == Approx(110.0));
+
+    // A wake-up at bar 30 stops the skip even though nothing is touched
+    data.skip_quiet(levels, 30 * 60);
+    REQUIRE(data.next());
+    REQUIRE(data.current().timestamp == 30 * 60);
+}
@@ -0,0 +1,226 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/coroutine_strategy.hpp"
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+// Mock execution context that records limit buys, cancels and timers
+class MockExecutionContext : public ctrade::ExecutionContext {
+public:
+    int64_t market_buy(double) override { return next_id_++; }
+    int64_t market_sell(double) override { return next_id_++; }
+    int64_t limit_buy(double, double price) override {
+        limit_prices.push_back(price);
+        return next_id_++;
+    }
+    int64_t limit_sell(double, double) override { return next_id_++; }
+    int64_t stop_buy(double, double) override { return next_id_++; }
+    int64_t stop_sell(double, double) override { return next_id_++; }
+    int64_t stop_limit_buy(double, double, double) override { return next_id_++; }
+    int64_t stop_limit_sell(double, double, double) override { return next_id_++; }
+    void close_position() override {}
+    void close_long() override {}
+    void close_short() override {}
+    void close_amount(double) override {}
+    void set_target_weights(std::span<const double>) override {}
+    void set_target_positions(std::span<const double>) override {}
+    void cancel_order(int64_t order_id) override { cancelled.push_back(order_id); }
+    void cancel_all() override {}
+    void amend_order(int64_t, double, double) override {}
+    int64_t submit_parent_order(const ctrade::ParentOrder&) override { return 0; }
+    void cancel_parent_order(int64_t) override {}
+    int64_t schedule_timer(int64_t timestamp) override {
+        timers.push_back(timestamp);
+        return static_cast<int64_t>(timers.size());
+    }
+    void set_leverage(int) override {}
+    void set_cross_mode() override {}
+    void set_isolated_mode() override {}
+
+    std::vector<double> limit_prices;
+    std::vector<int64_t> cancelled;
+    std::vector<int64_t> timers;
+
+private:
+    int64_t next_id_ = 1;
+};
+
+// Buys 1% below the close and cancels if not filled within 100 time units
+class DipBuyer : public ctrade::CoroutineStrategy {
+public:
+    void init() override {}
+
+    std::vector<double> fill_prices;
+    int bars_seen = 0;
+
+protected:
+    ctrade::StrategyTask run(ctrade::ExecutionContext& ctx) override {
+        for (;;) {
+            ctrade::MarketState bar = co_await next_bar();
+            bars_seen++;
+            int64_t id = ctx.limit_buy(1.0, bar.close * 0.99);
+            auto fill = co_await fill_of(id, 100);
+            if (fill) {
+                fill_prices.push_back(fill->price);
+                co_await timeout(50);
+            } else {
+                ctx.cancel_order(id);
+            }
+        }
+    }
+};
+
+static ctrade::MarketState bar_at(int64_t ts, double close) {
+    ctrade::MarketState s{};
+    s.timestamp = ts;
+    s.close = close;
+    return s;
+}
+
+static ctrade::Fill fill_for(int64_t order_id, int64_t ts, double price) {
+    ctrade::Fill f{};
+    f.order_id = order_id;
+    f.timestamp = ts;
+    f.price = price;
+    f.size = 1.0;
+    return f;
+}
+
+TEST_CASE("Coroutine strategy resumes on awaited fill", "[coroutine]") {
+    MockExecutionContext ctx;
+    DipBuyer strategy;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    REQUIRE(strategy.bars_seen == 1);
+    REQUIRE(ctx.limit_prices.size() == 1);
+    REQUIRE(ctx.limit_prices[0] == Approx(99.0));
+
+    // Waiting on the fill: bars do not resume the coroutine
+    strategy.on_bar(bar_at(10, 101.0), ctx);
+    REQUIRE(strategy.bars_seen == 1);
+
+    strategy.on_fill(fill_for(1, 15, 99.0), ctx);
+    REQUIRE(strategy.fill_prices.size() == 1);
+    REQUIRE(strategy.fill_prices[0] == Approx(99.0));
+
+    // Cooling down until t = 65
+    strategy.on_bar(bar_at(20, 102.0), ctx);
+    REQUIRE(strategy.bars_seen == 1);
+
+    strategy.on_bar(bar_at(70, 103.0), ctx);
+    REQUIRE(strategy.bars_seen == 2);
+    REQUIRE(ctx.cancelled.empty());
+}
+
+TEST_CASE("Coroutine fill wait times out", "[coroutine]") {
+    MockExecutionContext ctx;
+    DipBuyer strategy;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    strategy.on_bar(bar_at(50, 100.0), ctx);
+    REQUIRE(ctx.cancelled.empty());
+
+    // Timeout fires, order is cancelled, and the same bar is delivered
+    strategy.on_bar(bar_at(100, 100.0), ctx);
+    REQUIRE(ctx.cancelled.size() == 1);
+    REQUIRE(ctx.cancelled[0] == 1);
+    REQUIRE(strategy.bars_seen == 2);
+
+    // A late fill for the cancelled order is ignored
+    strategy.on_fill(fill_for(1, 101, 99.0), ctx);
+    REQUIRE(strategy.fill_prices.empty());
+}
+
+class FailingStrategy : public ctrade::CoroutineStrategy {
+public:
+    void init() override {}
+
+protected:
+    ctrade::StrategyTask run(ctrade::ExecutionContext&) override {
+        co_await next_bar();
+        co_await next_bar();
+        throw std::runtime_error("boom");
+    }
+};
+
+TEST_CASE("Coroutine exceptions propagate to the caller", "[coroutine]") {
+    MockExecutionContext ctx;
+    FailingStrategy strategy;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    REQUIRE_THROWS_AS(strategy.on_bar(bar_at(1, 100.0), ctx), std::runtime_error);
+
+    // The failed task is gone; it does not rethrow on every later callback
+    REQUIRE_NOTHROW(strategy.on_bar(bar_at(2, 100.0), ctx));
+    REQUIRE_NOTHROW(strategy.on_timer(ctrade::TimerEvent{1, 3}, ctx));
+}
+
+// Two tasks wait on the same order
+class SharedWait : public ctrade::CoroutineStrategy {
+public:
+    void init() override {}
+
+    std::vector<int> resumed;
+    bool first_throws = false;
+
+protected:
+    ctrade::StrategyTask watch(int who) {
+        auto fill = co_await fill_of(1);
+        if (who == 1 && first_throws) {
+            throw std::runtime_error("boom");
+        }
+        if (fill) {
+            resumed.push_back(who);
+        }
+    }
+
+    ctrade::StrategyTask run(ctrade::ExecutionContext& ctx) override {
+        ctx.limit_buy(1.0, 99.0);
+        spawn(watch(1));
+        spawn(watch(2));
+        co_return;
+    }
+};
+
+TEST_CASE("Every task awaiting an order sees its fill", "[coroutine]") {
+    MockExecutionContext ctx;
+    SharedWait strategy;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    REQUIRE(strategy.resumed.empty());
+    strategy.on_fill(fill_for(1, 5, 99.0), ctx);
+    REQUIRE(strategy.resumed == std::vector<int>{1, 2});
+}
+
+TEST_CASE("A failing waiter does not strand the others", "[coroutine]") {
+    MockExecutionContext ctx;
+    SharedWait strategy;
+    strategy.first_throws = true;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    REQUIRE_THROWS_AS(strategy.on_fill(fill_for(1, 5, 99.0), ctx), std::runtime_error);
+    REQUIRE(strategy.resumed == std::vector<int>{2});
+}
+
+TEST_CASE("Coroutine timeouts fire from timer events between bars", "[coroutine]") {
+    MockExecutionContext ctx;
+    DipBuyer strategy;
+
+    strategy.on_bar(bar_at(0, 100.0), ctx);
+    REQUIRE(ctx.timers.size() == 1);
+    REQUIRE(ctx.timers[0] == 100);
+
+    strategy.on_fill(fill_for(1, 15, 99.0), ctx);
+    REQUIRE(ctx.timers.size() == 2);
+    REQUIRE(ctx.timers[1] == 65);
+
+    ctrade::TimerEvent timer{2, 65};
+    strategy.on_timer(timer, ctx);
+    REQUIRE(strategy.bars_seen == 1);
+
+    // Cooldown over: the very next bar is delivered
+    strategy.on_bar(bar_at(66, 100.0), ctx);
+    REQUIRE(strategy.bars_seen == 2);
+}
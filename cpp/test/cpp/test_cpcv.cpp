@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/cpcv.hpp"
+#include <atomic>
+#include <vector>
+
+using Catch::Approx;
+
+// 600 bars in six groups. params = {edge, group}: the run earns `edge` per
+// bar inside `group` (or everywhere when group < 0) and loses 0.001 per bar
+// elsewhere, plus a little noise.
+static ctrade::BacktestResult regime(const ctrade::ParamSet& params, ctrade::CounterRng& rng) {
+    ctrade::BacktestResult result;
+    double equity = 10000.0;
+    for (int i = 0; i < 600; ++i) {
+        const bool on = params[1] < 0.0 || static_cast<int>(params[1]) == i / 100;
+        if (i > 0) {
+            equity *= 1.0 + (on ? params[0] : -0.001) + 0.0001 * rng.normal();
+        }
+        result.timestamps.push_back(i);
+        result.equity.push_back(equity);
+    }
+    return result;
+}
+
+TEST_CASE("Combinations enumerate every test set in order", "[cpcv]") {
+    auto splits = ctrade::combinations(6, 2);
+    REQUIRE(splits.size() == 15);
+    REQUIRE(splits.front() == std::vector<size_t>{0, 1});
+    REQUIRE(splits[5] == std::vector<size_t>{1, 2});
+    REQUIRE(splits.back() == std::vector<size_t>{4, 5});
+
+    REQUIRE(ctrade::combinations(5, 0).size() == 1);
+    REQUIRE(ctrade::combinations(3, 4).empty());
+}
+
+TEST_CASE("Training ranges are purged and embargoed around test groups", "[cpcv]") {
+    auto groups = ctrade::cpcv_groups(100, 5);
+    REQUIRE(groups[0] == ctrade::BarRange{0, 20});
+    REQUIRE(groups[4] == ctrade::BarRange{80, 100});
+
+    auto train = ctrade::cpcv_train_ranges(groups, {1, 3}, 3, 2);
+    std::vector<ctrade::BarRange> expected{{0, 17}, {42, 57}, {82, 100}};
+    REQUIRE(train == expected);
+
+    // Adjacent training groups merge into one range
+    train = ctrade::cpcv_train_ranges(groups, {4}, 5, 5);
+    REQUIRE(train == std::vector<ctrade::BarRange>{{0, 75}});
+}
+
+TEST_CASE("A robust parameter set is selected on every split", "[cpcv]") {
+    std::vector<ctrade::ParamSet> params{{0.0005, -1.0}, {0.002, -1.0}, {0.0, -1.0}};
+    std::atomic<int> calls{0};
+    auto counted = [&](const ctrade::ParamSet& p, ctrade::CounterRng& rng) {
+        calls++;
+        return regime(p, rng);
+    };
+
+    ctrade::SweepConfig config;
+    config.threads = 2;
+    auto result = ctrade::run_cpcv(params, counted, {}, config);
+
+    // One run per parameter set, however many splits
+    REQUIRE(calls == 3);
+    REQUIRE(result.n_runs == 3);
+    REQUIRE(result.splits.size() == 15);
+    REQUIRE(result.path_sharpe.size() == 5);
+    for (const auto& split : result.splits) {
+        REQUIRE(split.selected == 1);
+        REQUIRE(split.test_rank == Approx(0.75));
+    }
+    REQUIRE(result.pbo == 0.0);
+    for (double sharpe : result.path_sharpe) {
+        REQUIRE(sharpe > 10.0);
+    }
+}
+
+TEST_CASE("Regime-fitted parameter sets show overfitting", "[cpcv]") {
+    // Six sets that each shine in one group, four steady mediocre ones
+    std::vector<ctrade::ParamSet> params;
+    for (int g = 0; g < 6; ++g) {
+        params.push_back({0.01, static_cast<double>(g)});
+    }
+    for (int i = 0; i < 4; ++i) {
+        params.push_back({-0.0005, -1.0});
+    }
+
+    ctrade::SweepConfig config;
+    config.seed = 3;
+    auto result = ctrade::run_cpcv(params, regime, {}, config);
+
+    REQUIRE(result.pbo == 1.0);
+    REQUIRE(result.mean_test_sharpe < result.mean_train_sharpe);
+}
+
+TEST_CASE("CPCV results do not depend on the thread count", "[cpcv][determinism]") {
+    std::vector<ctrade::ParamSet> params;
+    for (int g = -1; g < 6; ++g) {
+        params.push_back({0.001, static_cast<double>(g)});
+    }
+    ctrade::CpcvConfig cpcv;
+    cpcv.purge = 5;
+    cpcv.embargo = 5;
+
+    ctrade::SweepConfig serial;
+    serial.threads = 1;
+    ctrade::SweepConfig threaded;
+    threaded.threads = 4;
+    auto a = ctrade::run_cpcv(params, regime, cpcv, serial);
+    auto b = ctrade::run_cpcv(params, regime, cpcv, threaded);
+
+    REQUIRE(a.path_sharpe == b.path_sharpe);
+    for (size_t s = 0; s < a.splits.size(); ++s) {
+        REQUIRE(a.splits[s].selected == b.splits[s].selected);
+        REQUIRE(a.splits[s].test_sharpe == b.splits[s].test_sharpe);
+    }
+
+    cpcv.n_test_groups = cpcv.n_groups;
+    REQUIRE_THROWS(ctrade::run_cpcv(params, regime, cpcv, serial));
+}
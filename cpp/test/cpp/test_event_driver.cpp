@@ -0,0 +1,391 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/bar_store.hpp"
+#include "ctrade/event_driver.hpp"
+#include "ctrade/event_queue.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using Catch::Approx;
+
+// Cursor-style mock source: next() must be called before current()
+class MockMarketData : public ctrade::MarketData {
+public:
+    MockMarketData(int asset_id, std::vector<int64_t> timestamps) {
+        for (int64_t ts : timestamps) {
+            ctrade::MarketState s{};
+            s.asset_id = asset_id;
+            s.timestamp = ts;
+            s.close = 100.0 + asset_id;
+            states_.push_back(s);
+        }
+    }
+
+    bool next() override { return ++index_ < states_.size(); }
+
+    const ctrade::MarketState& current() const override { return states_[index_]; }
+
+private:
+    std::vector<ctrade::MarketState> states_;
+    size_t index_ = static_cast<size_t>(-1);
+};
+
+class MockExecutionContext : public ctrade::ExecutionContext {
+public:
+    int64_t market_buy(double) override { return 0; }
+    int64_t market_sell(double) override { return 0; }
+    int64_t limit_buy(double, double) override { return 0; }
+    int64_t limit_sell(double, double) override { return 0; }
+    int64_t stop_buy(double, double) override { return 0; }
+    int64_t stop_sell(double, double) override { return 0; }
+    int64_t stop_limit_buy(double, double, double) override { return 0; }
+    int64_t stop_limit_sell(double, double, double) override { return 0; }
+    void close_position() override {}
+    void close_long() override {}
+    void close_short() override {}
+    void close_amount(double) override {}
+    void set_target_weights(std::span<const double>) override {}
+    void set_target_positions(std::span<const double>) override {}
+    void cancel_order(int64_t) override {}
+    void cancel_all() override {}
+    void amend_order(int64_t, double, double) override {}
+    int64_t submit_parent_order(const ctrade::ParentOrder&) override { return 0; }
+    void cancel_parent_order(int64_t) override {}
+    int64_t schedule_timer(int64_t) override { return 0; }
+    void set_leverage(int) override {}
+    void set_cross_mode() override {}
+    void set_isolated_mode() override {}
+};
+
+// Records every callback as "<kind>@<timestamp>"
+class RecordingStrategy : public ctrade::Strategy {
+public:
+    void init() override {}
+
+    ctrade::WakePolicy wake_policy() const override { return policy; }
+
+    void on_bar(const ctrade::MarketState& m, ctrade::ExecutionContext&) override {
+        log.push_back("bar" + std::to_string(m.asset_id) + "@" + std::to_string(m.timestamp));
+    }
+    void on_slice(const ctrade::AssetSlice& s, ctrade::ExecutionContext&) override {
+        log.push_back("slice@" + std::to_string(s.timestamp));
+        last_slice_close = std::vector<double>(s.close.begin(), s.close.end());
+    }
+    void on_fill(const ctrade::Fill& f, ctrade::ExecutionContext&) override {
+        log.push_back("fill@" + std::to_string(f.timestamp));
+    }
+    void on_tick(const ctrade::Tick& t, ctrade::ExecutionContext&) override {
+        log.push_back("tick@" + std::to_string(t.timestamp));
+    }
+    void on_timer(const ctrade::TimerEvent& t, ctrade::ExecutionContext&) override {
+        log.push_back("timer@" + std::to_string(t.timestamp));
+    }
+    void on_funding(const ctrade::FundingEvent& e, ctrade::ExecutionContext&) override {
+        log.push_back("funding@" + std::to_string(e.timestamp));
+    }
+
+    ctrade::WakePolicy policy;
+    std::vector<std::string> log;
+    std::vector<double> last_slice_close;
+};
+
+TEST_CASE("EventQueue pops in timestamp then type order", "[events]") {
+    ctrade::EventQueue queue;
+
+    for (int64_t ts : {50, 10, 40, 20, 30, 10, 60, 0, 70}) {
+        queue.push(ctrade::Event{ctrade::EventType::Bar, ts, 0, {}});
+    }
+    queue.push(ctrade::Event{ctrade::EventType::Fill, 10, 0, {}});
+    queue.push(ctrade::Event{ctrade::EventType::Timer, 10, 0, {}});
+
+    std::vector<int64_t> timestamps;
+    std::vector<ctrade::EventType> types;
+    while (!queue.empty()) {
+        auto e = queue.pop();
+        timestamps.push_back(e.timestamp);
+        types.push_back(e.type);
+    }
+
+    REQUIRE(timestamps == std::vector<int64_t>{0, 10, 10, 10, 10, 20, 30, 40, 50, 60, 70});
+    REQUIRE(types[1] == ctrade::EventType::Fill);
+    REQUIRE(types[2] == ctrade::EventType::Timer);
+    REQUIRE(types[3] == ctrade::EventType::Bar);
+}
+
+TEST_CASE("EventDriver merges sources and events in time order", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    MockMarketData btc(0, {0, 60, 120});
+    MockMarketData eth(1, {30, 90});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.add_market_data(btc);
+    driver.add_market_data(eth);
+    driver.schedule_timer(60);
+
+    ctrade::Fill fill{};
+    fill.timestamp = 60;
+    driver.push_fill(fill);
+
+    ctrade::Tick tick{};
+    tick.timestamp = 45;
+    driver.push_tick(tick);
+
+    ctrade::FundingEvent funding{};
+    funding.timestamp = 100;
+    driver.push_funding(funding);
+
+    driver.run();
+
+    REQUIRE(strategy.log == std::vector<std::string>{
+        "bar0@0", "bar1@30", "tick@45", "fill@60", "timer@60",
+        "bar0@60", "bar1@90", "funding@100", "bar0@120"});
+}
+
+TEST_CASE("EventDriver stops at end_ts", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    MockMarketData btc(0, {0, 60, 120});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.add_market_data(btc);
+    driver.run(60);
+
+    REQUIRE(strategy.log.size() == 2);
+    REQUIRE(driver.now() == 60);
+
+    driver.run();
+    REQUIRE(strategy.log.size() == 3);
+}
+
+TEST_CASE("EventDriver delivers one slice per timestamp", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    MockMarketData btc(0, {0, 60});
+    MockMarketData eth(1, {0, 60});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.enable_slices(2);
+    driver.add_market_data(btc);
+    driver.add_market_data(eth);
+    driver.run();
+
+    REQUIRE(strategy.log == std::vector<std::string>{
+        "bar0@0", "bar1@0", "slice@0", "bar0@60", "bar1@60", "slice@60"});
+    REQUIRE(strategy.last_slice_close[0] == Approx(100.0));
+    REQUIRE(strategy.last_slice_close[1] == Approx(101.0));
+}
+
+TEST_CASE("EventDriver can deliver slices without per-bar callbacks", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    strategy.policy.bar_callbacks = false;
+    MockMarketData btc(0, {0, 60});
+    MockMarketData eth(1, {0, 60});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.enable_slices(2);
+    driver.add_market_data(btc);
+    driver.add_market_data(eth);
+    driver.run();
+
+    REQUIRE(strategy.log == std::vector<std::string>{"slice@0", "slice@60"});
+    REQUIRE(strategy.last_slice_close[1] == Approx(101.0));
+}
+
+// Fills its first order at once, as an engine does for a market order
+class FillingStrategy : public RecordingStrategy {
+public:
+    explicit FillingStrategy(ctrade::EventDriver*& driver) : driver_(driver) {}
+
+    void on_bar(const ctrade::MarketState& m, ctrade::ExecutionContext& ctx) override {
+        RecordingStrategy::on_bar(m, ctx);
+        if (m.asset_id == 0 && m.timestamp == 0) {
+            ctrade::Fill fill{};
+            fill.timestamp = m.timestamp;
+            driver_->push_fill(fill);
+        }
+    }
+
+private:
+    ctrade::EventDriver*& driver_;
+};
+
+TEST_CASE("EventDriver waits for same-timestamp fills before the slice", "[events]") {
+    MockExecutionContext ctx;
+    ctrade::EventDriver* handle = nullptr;
+    FillingStrategy strategy(handle);
+    MockMarketData btc(0, {0, 60});
+    MockMarketData eth(1, {0, 60});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    handle = &driver;
+    driver.enable_slices(2);
+    driver.enable_risk(0.94);
+    driver.add_market_data(btc);
+    driver.add_market_data(eth);
+    driver.run(0);
+
+    // The fill sorts ahead of eth's bar, but the slice still waits for it
+    REQUIRE(strategy.log == std::vector<std::string>{
+        "bar0@0", "fill@0", "bar1@0", "slice@0"});
+    REQUIRE(strategy.last_slice_close[1] == Approx(101.0));
+    driver.run();
+    REQUIRE(strategy.log.back() == "slice@60");
+    REQUIRE(driver.risk()->observations() == 1);
+}
+
+TEST_CASE("EventDriver updates risk from each slice", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    MockMarketData btc(0, {0, 60, 120});
+    MockMarketData eth(1, {0, 60, 120});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    REQUIRE_THROWS(driver.enable_risk(0.94));
+    driver.enable_slices(2);
+    driver.enable_risk(0.94);
+    driver.add_market_data(btc);
+    driver.add_market_data(eth);
+    driver.run();
+
+    // The first slice only sets reference prices
+    REQUIRE(driver.risk()->observations() == 2);
+    REQUIRE(driver.risk()->covariance(0, 1) == 0.0);
+}
+
+TEST_CASE("EventDriver dispatches late events at the current time", "[events]") {
+    MockExecutionContext ctx;
+    RecordingStrategy strategy;
+    MockMarketData btc(0, {0, 60});
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.add_market_data(btc);
+    driver.run(0);
+
+    driver.schedule_timer(-10);
+    driver.run();
+
+    REQUIRE(strategy.log == std::vector<std::string>{"bar0@0", "timer@0", "bar0@60"});
+}
+
+// Grid strategy that only cares about bars crossing its resting levels
+class TriggerStrategy : public RecordingStrategy {
+public:
+    ctrade::WakePolicy wake_policy() const override {
+        return {ctrade::WakeMode::TriggersOnly, 600};
+    }
+};
+
+TEST_CASE("EventDriver jumps over bars that touch no resting level", "[events]") {
+    ctrade::BarStore store(0, 8);
+    for (int i = 0; i < 100; ++i) {
+        ctrade::MarketState s{};
+        s.timestamp = i * 60;
+        s.low = 99.0;
+        s.high = i == 42 ? 106.0 : 101.0;
+        s.close = 100.0;
+        store.append(s);
+    }
+    ctrade::BarStoreMarketData data(store);
+
+    MockExecutionContext ctx;
+    TriggerStrategy strategy;
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.set_trigger_levels([](int, ctrade::TriggerLevels& levels) {
+        levels.rising.push_back(105.0);
+        return true;
+    });
+    driver.add_market_data(data);
+    driver.run();
+
+    // First bar, then each 600s timer wakes the strategy for one bar,
+    // plus the bar that crosses 105
+    std::vector<std::string> bars;
+    for (const auto& entry : strategy.log) {
+        if (entry.rfind("bar", 0) == 0) bars.push_back(entry);
+    }
+    REQUIRE(bars.size() == 11);
+    REQUIRE(bars[0] == "bar0@0");
+    REQUIRE(bars[1] == "bar0@600");
+    REQUIRE(std::find(bars.begin(), bars.end(), "bar0@2520") != bars.end());
+}
+
+class SleepingStrategy : public RecordingStrategy {
+public:
+    ctrade::WakePolicy wake_policy() const override {
+        return {ctrade::WakeMode::TriggersOnly, 0};
+    }
+};
+
+TEST_CASE("EventDriver stops for gaps and marketable levels", "[events]") {
+    // Quiet around 100, then bar 50 gaps down to 97-98 without trading 99
+    ctrade::BarStore store(0, 8);
+    for (int i = 0; i < 100; ++i) {
+        ctrade::MarketState s{};
+        s.timestamp = i * 60;
+        s.low = i >= 50 ? 97.0 : 99.5;
+        s.high = i >= 50 ? 98.0 : 100.5;
+        s.close = i >= 50 ? 97.5 : 100.0;
+        store.append(s);
+    }
+    auto bars_seen = [&](double falling) {
+        ctrade::BarStoreMarketData data(store);
+        MockExecutionContext ctx;
+        SleepingStrategy strategy;
+        ctrade::EventDriver driver(strategy, ctx);
+        driver.set_trigger_levels([falling](int, ctrade::TriggerLevels& levels) {
+            levels.falling.push_back(falling);
+            return true;
+        });
+        driver.add_market_data(data);
+        driver.run();
+        return strategy.log;
+    };
+
+    // A buy limit at 99 is reached by the gap bar
+    auto gap = bars_seen(99.0);
+    REQUIRE(gap.size() >= 2);
+    REQUIRE(gap[1] == "bar0@3000");
+
+    // A buy limit above the market is never skipped past
+    REQUIRE(bars_seen(101.0).size() == 100);
+}
+
+TEST_CASE("EventDriver wakes for parent order slices", "[events]") {
+    ctrade::BarStore store(0, 8);
+    for (int i = 0; i < 100; ++i) {
+        ctrade::MarketState s{};
+        s.timestamp = i * 60;
+        s.low = 99.0;
+        s.high = 101.0;
+        s.close = 100.0;
+        store.append(s);
+    }
+    ctrade::BarStoreMarketData data(store);
+
+    MockExecutionContext ctx;
+    SleepingStrategy strategy;
+    ctrade::AlgoScheduler algos(ctx);
+    ctrade::ParentOrder twap;
+    twap.size = 5.0;
+    twap.start_ts = 0;
+    twap.end_ts = 3000;
+    twap.slices = 5;
+    algos.submit(twap);
+
+    ctrade::EventDriver driver(strategy, ctx);
+    driver.set_trigger_levels([](int, ctrade::TriggerLevels& levels) {
+        levels.rising.push_back(105.0);
+        return true;
+    });
+    driver.set_algo_scheduler(algos);
+    driver.add_market_data(data);
+    driver.run();
+
+    // Only the slice starts are delivered; the rest of the data is skipped
+    REQUIRE(strategy.log == std::vector<std::string>{
+        "bar0@0", "bar0@600", "bar0@1200", "bar0@1800", "bar0@2400"});
+    REQUIRE(algos.status(0).sent == Approx(5.0));
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/event_study.hpp"
+#include "ctrade/rng.hpp"
+#include "fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bars that close more than 2% above their open
+static bool jump(const ctrade::BarStore& bars, size_t i) {
+    return bars.close()[i] > bars.open()[i] * 1.02;
+}
+
+TEST_CASE("Events across stores line up with their windows", "[event_study]") {
+    auto a = random_bars(150000, 0);
+    auto b = random_bars(500, 1);
+    std::vector<const ctrade::BarStore*> stores{&a, &b};
+
+    ctrade::EventStudyConfig config;
+    config.before = 3;
+    config.after = 5;
+    config.threads = 4;
+    auto panel = ctrade::event_study(stores, ctrade::EventPredicate(jump), config);
+
+    // Same events as a serial scan, in store and bar order
+    size_t expected = 0;
+    for (size_t s = 0; s < stores.size(); ++s) {
+        for (size_t i = 0; i < stores[s]->size(); ++i) {
+            if (!jump(*stores[s], i)) {
+                continue;
+            }
+            REQUIRE(panel.store[expected] == s);
+            REQUIRE(panel.bar[expected] == i);
+            REQUIRE(panel.timestamp[expected] == static_cast<int64_t>(i) * 60);
+            ++expected;
+        }
+    }
+    REQUIRE(panel.n_events() == expected);
+    REQUIRE(panel.width() == 9);
+    REQUIRE(panel.returns.size() == expected * 9);
+
+    for (size_t e = 0; e < panel.n_events(); ++e) {
+        const auto& bars = *stores[panel.store[e]];
+        const size_t i = panel.bar[e];
+        const double* row = &panel.returns[e * 9];
+        REQUIRE(row[3] == 0.0);
+        if (i >= 3 && i + 5 < bars.size()) {
+            REQUIRE(row[0] == bars.close()[i - 3] / bars.close()[i] - 1.0);
+            REQUIRE(row[8] == bars.close()[i + 5] / bars.close()[i] - 1.0);
+            REQUIRE(panel.volume[e * 9 + 8] == bars.volume()[i + 5]);
+            REQUIRE(panel.funding_rate[e * 9] == bars.funding_rate()[i - 3]);
+        }
+    }
+
+    // Thread count does not change anything
+    config.threads = 1;
+    auto serial = ctrade::event_study(stores, ctrade::EventPredicate(jump), config);
+    REQUIRE(serial.bar == panel.bar);
+    REQUIRE(serial.returns.size() == panel.returns.size());
+}
+
+TEST_CASE("Cooldown, edges and precomputed masks", "[event_study]") {
+    auto a = random_bars(20, 0);
+    auto b = random_bars(4, 1);
+    std::vector<const ctrade::BarStore*> stores{&a, &b};
+    std::vector<uint8_t> mask_a(20, 0);
+    std::vector<uint8_t> mask_b{1, 0, 0, 1};
+    for (size_t i : {0u, 1u, 2u, 5u, 18u, 19u}) {
+        mask_a[i] = 1;
+    }
+    std::vector<std::span<const uint8_t>> masks{mask_a, mask_b};
+
+    ctrade::EventStudyConfig config;
+    config.before = 2;
+    config.after = 2;
+    config.cooldown = 2;
+    auto panel = ctrade::event_study(stores, masks, config);
+
+    // 1 and 2 fall inside the cooldown of 0, 19 inside that of 18; the
+    // cooldown does not carry over into the next store
+    REQUIRE(panel.bar == std::vector<uint32_t>{0, 5, 18, 0, 3});
+    REQUIRE(panel.store == std::vector<uint32_t>{0, 0, 0, 1, 1});
+
+    // Bar 0 has no history and bar 18 of 20 is one bar short
+    REQUIRE(std::isnan(panel.returns[0]));
+    REQUIRE(std::isnan(panel.volume[1]));
+    REQUIRE(panel.returns[2] == 0.0);
+    REQUIRE(panel.volume[4] == a.volume()[2]);
+    REQUIRE(panel.volume[2 * 5 + 3] == a.volume()[19]);
+    REQUIRE(std::isnan(panel.funding_rate[2 * 5 + 4]));
+
+    std::vector<uint8_t> short_mask(3, 0);
+    masks.back() = short_mask;
+    REQUIRE_THROWS(ctrade::event_study(stores, masks, config));
+    masks.pop_back();
+    REQUIRE_THROWS(ctrade::event_study(stores, masks, config));
+}
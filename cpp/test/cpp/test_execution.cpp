@@ -4,6 +4,9 @@
 #include "ctrade/market_state.hpp"
 #include "ctrade/order.hpp"
 #include "ctrade/fill.hpp"
+#include "ctrade/hybrid_execution.hpp"
+#include "ctrade/tick_source.hpp"
+#include <utility>
 #include <vector>
 
 using Catch::Approx;
@@ -128,3 +131,158 @@ TEST_CASE("Multiple orders produce multiple fills", "[execution]") {
     REQUIRE(fills.size() == 2);
 }
 
+// Tick source serving a fixed trade sequence for every window
+class MockTickSource : public ctrade::TickSource {
+public:
+    explicit MockTickSource(std::vector<double> prices) : prices_(std::move(prices)) {}
+
+    std::vector<ctrade::Tick> load(int asset_id, int64_t from_ts, int64_t) override {
+        loads++;
+        std::vector<ctrade::Tick> ticks;
+        for (size_t i = 0; i < prices_.size(); ++i) {
+            ctrade::Tick t{};
+            t.asset_id = asset_id;
+            t.timestamp = from_ts + static_cast<int64_t>(i);
+            t.price = prices_[i];
+            t.size = 1.0;
+            ticks.push_back(t);
+        }
+        return ticks;
+    }
+
+    int loads = 0;
+
+private:
+    std::vector<double> prices_;
+};
+
+static ctrade::MarketState bar(double open, double high, double low, double close) {
+    ctrade::MarketState m{};
+    m.timestamp = 6000;
+    m.open = open;
+    m.high = high;
+    m.low = low;
+    m.close = close;
+    m.bid = close;
+    m.ask = close;
+    return m;
+}
+
+static ctrade::Order resting(int64_t id, ctrade::Side side, ctrade::OrderType type,
+                             double price, double stop_price = 0.0) {
+    ctrade::Order o{};
+    o.id = id;
+    o.side = side;
+    o.type = type;
+    o.price = price;
+    o.stop_price = stop_price;
+    o.size = 1.0;
+    return o;
+}
+
+TEST_CASE("Hybrid engine skips tick loads for untouched bars", "[execution]") {
+    MockTickSource source({100.0, 99.0, 101.0});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0002, 0.0005}, 60);
+
+    auto order = resting(1, ctrade::Side::Buy, ctrade::OrderType::Limit, 95.0);
+    auto fills = engine.execute({order}, bar(100.0, 102.0, 98.0, 101.0));
+
+    REQUIRE(fills.empty());
+    REQUIRE(source.loads == 0);
+}
+
+TEST_CASE("Hybrid engine fills limits only on trade-through", "[execution]") {
+    MockTickSource source({100.0, 99.0, 98.0, 99.5});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0002, 0.0005}, 60);
+
+    auto at_low = resting(1, ctrade::Side::Buy, ctrade::OrderType::Limit, 98.0);
+    auto inside = resting(2, ctrade::Side::Buy, ctrade::OrderType::Limit, 99.2);
+    auto fills = engine.execute({at_low, inside}, bar(100.0, 100.0, 97.9, 99.5));
+
+    // 98.0 is only touched, never traded through
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].order_id == 2);
+    REQUIRE(fills[0].price == Approx(99.2));
+    REQUIRE(fills[0].timestamp == 6001);
+    REQUIRE(fills[0].fee == Approx(99.2 * 0.0002));
+
+    // Both orders share one cached tick window
+    REQUIRE(source.loads == 1);
+}
+
+TEST_CASE("Hybrid engine fills new marketable limits as taker", "[execution]") {
+    MockTickSource source({100.0, 99.0, 98.0, 99.5});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0002, 0.0005}, 60);
+
+    // A buy limit at 105 sent in this bar takes the first print at 100
+    auto order = resting(1, ctrade::Side::Buy, ctrade::OrderType::Limit, 105.0);
+    order.timestamp = 6000;
+    auto fills = engine.execute({order}, bar(100.0, 100.0, 97.9, 99.5));
+
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(100.0));
+    REQUIRE(fills[0].timestamp == 6000);
+    REQUIRE(fills[0].fee == Approx(100.0 * 0.0005));
+    REQUIRE_FALSE(fills[0].maker);
+
+    // Resting since an earlier bar, the market gaps through it: the limit
+    // fills at its own price as maker
+    order.timestamp = 5940;
+    fills = engine.execute({order}, bar(100.0, 100.0, 97.9, 99.5));
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(105.0));
+    REQUIRE(fills[0].fee == Approx(105.0 * 0.0002));
+    REQUIRE(fills[0].maker);
+}
+
+TEST_CASE("Hybrid engine orders stop and target by trade time", "[execution]") {
+    MockTickSource source({100.0, 103.0, 104.5, 97.0, 95.5});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0, 0.001}, 60);
+
+    auto stop = resting(1, ctrade::Side::Sell, ctrade::OrderType::Stop, 0.0, 96.0);
+    auto target = resting(2, ctrade::Side::Sell, ctrade::OrderType::Limit, 104.0);
+    auto fills = engine.execute({stop, target}, bar(100.0, 104.5, 95.5, 96.0));
+
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].order_id == 2);
+    REQUIRE(fills[1].order_id == 1);
+    REQUIRE(fills[1].price == Approx(95.5));
+}
+
+TEST_CASE("Hybrid engine falls back to OHLC without ticks", "[execution]") {
+    MockTickSource source({});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0, 0.0}, 60);
+
+    auto stop = resting(1, ctrade::Side::Buy, ctrade::OrderType::Stop, 0.0, 101.0);
+    auto fills = engine.execute({stop}, bar(102.0, 103.0, 101.5, 102.5));
+
+    // Gapped over the trigger: filled at the open
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(102.0));
+}
+
+TEST_CASE("Hybrid engine resolves tickless bars on its path model", "[execution]") {
+    MockTickSource source({});
+    ctrade::TickCache cache(source, 4);
+    ctrade::HybridExecutionEngine engine(cache, {0.0, 0.0}, 60, ctrade::PathModel::OLHC);
+
+    std::vector<ctrade::AmbiguousBar> ambiguous;
+    engine.record_ambiguous(&ambiguous);
+
+    auto stop = resting(1, ctrade::Side::Sell, ctrade::OrderType::Stop, 0.0, 97.0);
+    auto target = resting(2, ctrade::Side::Sell, ctrade::OrderType::Limit, 103.0);
+    auto fills = engine.execute({target, stop}, bar(100.0, 104.0, 96.0, 100.0));
+
+    // Low visited first: the stop fills before the target
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].order_id == 1);
+    REQUIRE(fills[1].order_id == 2);
+
+    REQUIRE(ambiguous.size() == 1);
+    REQUIRE(ambiguous[0].orders.size() == 2);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/feature_store.hpp"
+#include "ctrade/parallel.hpp"
+#include "fixtures.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static ctrade::BarStore ramp_bars(size_t n) {
+    ctrade::BarStore store(0);
+    for (size_t i = 0; i < n; ++i) {
+        ctrade::MarketState bar{};
+        bar.timestamp = static_cast<int64_t>(i) * 60;
+        bar.close = 100.0 + std::sin(0.1 * static_cast<double>(i));
+        bar.open = bar.high = bar.low = bar.close;
+        store.append(bar);
+    }
+    return store;
+}
+
+// Simple moving average of the close over params[0] bars; NaN until full
+static ctrade::FeatureFn moving_average(std::atomic<int>& calls, double window) {
+    return [&calls, window](const ctrade::BarStore& bars, std::span<double> out) {
+        calls++;
+        const auto n = static_cast<size_t>(window);
+        double sum = 0.0;
+        for (size_t i = 0; i < bars.size(); ++i) {
+            sum += bars.close()[i];
+            if (i >= n) {
+                sum -= bars.close()[i - n];
+            }
+            if (i + 1 >= n) {
+                out[i] = sum / window;
+            }
+        }
+    };
+}
+
+TEST_CASE("Features are computed once and mapped afterwards", "[features]") {
+    const auto dir = store_dir("once");
+    auto bars = ramp_bars(500);
+    const ctrade::FeatureKey sma{"sma", {10.0}};
+    std::atomic<int> calls{0};
+
+    ctrade::FeatureStore store(dir);
+    REQUIRE(store.find(sma, bars) == nullptr);
+    auto column = store.get(sma, bars, moving_average(calls, 10.0));
+    REQUIRE(calls == 1);
+    REQUIRE(column->size() == 500);
+    REQUIRE(std::isnan((*column)[8]));
+    double first = 0.0;
+    for (size_t i = 0; i < 10; ++i) {
+        first += bars.close()[i];
+    }
+    REQUIRE(std::abs((*column)[9] - first / 10.0) < 1e-12);
+
+    // Same process: the same mapping is handed out
+    REQUIRE(store.get(sma, bars, moving_average(calls, 10.0)) == column);
+
+    // A new process maps the file without recomputing
+    ctrade::FeatureStore reopened(dir);
+    auto mapped = reopened.get(sma, bars, moving_average(calls, 10.0));
+    REQUIRE(calls == 1);
+    REQUIRE(reopened.computed() == 0);
+    REQUIRE(std::equal(mapped->values().begin() + 9, mapped->values().end(),
+                       column->values().begin() + 9));
+    REQUIRE(reopened.find(sma, bars) == mapped);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Concurrent readers wait for one computation", "[features]") {
+    const auto dir = store_dir("concurrent");
+    auto bars = ramp_bars(2000);
+    ctrade::FeatureStore store(dir);
+    std::atomic<int> calls{0};
+
+    std::vector<ctrade::FeatureHandle> handles(64);
+    ctrade::parallel_for(handles.size(), 8, [&](size_t i, unsigned) {
+        handles[i] = store.get({"sma", {20.0}}, bars, moving_average(calls, 20.0));
+    });
+    REQUIRE(calls == 1);
+    REQUIRE(store.computed() == 1);
+    for (const auto& handle : handles) {
+        REQUIRE(handle == handles[0]);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("New definitions, new bars and damaged files recompute", "[features]") {
+    const auto dir = store_dir("keys");
+    auto bars = ramp_bars(300);
+    std::atomic<int> calls{0};
+    {
+        ctrade::FeatureStore store(dir);
+        store.get({"sma", {10.0}}, bars, moving_average(calls, 10.0));
+        store.get({"sma", {20.0}}, bars, moving_average(calls, 20.0));
+        store.get({"sma", {10.0}, 2}, bars, moving_average(calls, 10.0));
+        REQUIRE(calls == 3);
+
+        // Appending a bar changes the fingerprint
+        auto longer = ramp_bars(301);
+        REQUIRE(ctrade::bars_fingerprint(longer) != ctrade::bars_fingerprint(bars));
+        REQUIRE(ctrade::bars_fingerprint(ramp_bars(300)) == ctrade::bars_fingerprint(bars));
+
+        // So does revising one
+        ctrade::BarStore revised(0);
+        for (size_t i = 0; i < bars.size(); ++i) {
+            auto bar = bars.at(i);
+            bar.close += i == 150 ? 0.01 : 0.0;
+            revised.append(bar);
+        }
+        REQUIRE(ctrade::bars_fingerprint(revised) != ctrade::bars_fingerprint(bars));
+        auto column = store.get({"sma", {10.0}}, longer, moving_average(calls, 10.0));
+        REQUIRE(calls == 4);
+        REQUIRE(column->size() == 301);
+    }
+
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::app) << "junk";
+    }
+    ctrade::FeatureStore store(dir);
+    REQUIRE(store.find({"sma", {10.0}}, bars) == nullptr);
+    store.get({"sma", {10.0}}, bars, moving_average(calls, 10.0));
+    REQUIRE(calls == 5);
+
+    // A failed computation is not cached
+    auto failing = [](const ctrade::BarStore&, std::span<double>) {
+        throw std::runtime_error("bad feature");
+    };
+    REQUIRE_THROWS(store.get({"broken", {}}, bars, failing));
+    REQUIRE(store.get({"broken", {}}, bars, moving_average(calls, 5.0))->size() == 300);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,166 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/impact.hpp"
+#include <cmath>
+#include <vector>
+
+using Catch::Approx;
+
+// Fills every order at the ask (buys) or bid (sells), fee-free, flagged
+// as maker when `maker` is set
+class MockExecutionEngine : public ctrade::ExecutionEngine {
+public:
+    bool maker = false;
+
+    std::vector<ctrade::Fill> execute(
+        const std::vector<ctrade::Order>& orders,
+        const ctrade::MarketState& market
+    ) override {
+        std::vector<ctrade::Fill> fills;
+        for (const auto& order : orders) {
+            ctrade::Fill fill{};
+            fill.order_id = order.id;
+            fill.asset_id = order.asset_id;
+            fill.size = order.size;
+            fill.price = order.side == ctrade::Side::Buy ? market.ask : market.bid;
+            fill.timestamp = market.timestamp;
+            fill.maker = maker;
+            fills.push_back(fill);
+        }
+        return fills;
+    }
+};
+
+static ctrade::MarketState quote(int64_t timestamp, double price) {
+    ctrade::MarketState m{};
+    m.timestamp = timestamp;
+    m.open = m.high = m.low = m.close = price;
+    m.bid = m.ask = m.mid = price;
+    return m;
+}
+
+static ctrade::Order market_order(int64_t id, ctrade::Side side, double size) {
+    ctrade::Order o{};
+    o.id = id;
+    o.side = side;
+    o.type = ctrade::OrderType::Market;
+    o.size = size;
+    return o;
+}
+
+TEST_CASE("Impact follows the square-root law", "[impact]") {
+    ctrade::ImpactConfig config;
+    config.coefficient = 0.01;
+    config.volume_scale = 100.0;
+    ctrade::ImpactModel model(config);
+
+    REQUIRE(model.instantaneous(100.0) == Approx(0.01));
+    REQUIRE(model.instantaneous(400.0) == Approx(0.02));
+    REQUIRE(model.instantaneous(-25.0) == Approx(-0.005));
+    REQUIRE(model.instantaneous(0.0) == 0.0);
+}
+
+TEST_CASE("Exponential pressure halves every timescale", "[impact]") {
+    ctrade::ImpactConfig config;
+    config.coefficient = 0.01;
+    config.volume_scale = 100.0;
+    config.timescale = 60.0;
+    ctrade::ImpactModel model(config);
+
+    model.add(0, 0, 100.0);
+    REQUIRE(model.pressure(0, 0) == Approx(0.01));
+    REQUIRE(model.pressure(0, 60) == Approx(0.005));
+    REQUIRE(model.pressure(0, 120) == Approx(0.0025));
+
+    // Other assets are unaffected
+    REQUIRE(model.pressure(3, 120) == 0.0);
+
+    // Opposite trading offsets the remaining pressure
+    model.add(0, 120, -25.0);
+    REQUIRE(model.pressure(0, 120) == Approx(-0.0025));
+}
+
+TEST_CASE("Power-law kernel tracks its closed form", "[impact]") {
+    for (double beta : {0.5, 1.0, 1.5}) {
+        ctrade::ImpactConfig config;
+        config.decay = ctrade::ImpactDecay::PowerLaw;
+        config.timescale = 10.0;
+        config.decay_exponent = beta;
+        ctrade::ImpactModel model(config);
+
+        REQUIRE(model.kernel(0) == Approx(1.0));
+        for (int64_t t : {1, 10, 100, 1000, 10000}) {
+            double exact = std::pow(1.0 + static_cast<double>(t) / 10.0, -beta);
+            REQUIRE(model.kernel(t) == Approx(exact).epsilon(0.06));
+        }
+    }
+}
+
+TEST_CASE("Incremental pressure equals the sum over fill history", "[impact]") {
+    ctrade::ImpactConfig config;
+    config.coefficient = 0.02;
+    config.volume_scale = 50.0;
+    config.decay = ctrade::ImpactDecay::PowerLaw;
+    config.timescale = 5.0;
+    ctrade::ImpactModel model(config);
+
+    std::vector<std::pair<int64_t, double>> history{
+        {0, 10.0}, {3, -4.0}, {7, 25.0}, {20, 1.0}, {21, -30.0}};
+    for (auto [t, q] : history) {
+        model.add(1, t, q);
+    }
+
+    double naive = 0.0;
+    for (auto [t, q] : history) {
+        naive += model.instantaneous(q) * model.kernel(40 - t);
+    }
+    REQUIRE(model.pressure(1, 40) == Approx(naive));
+}
+
+TEST_CASE("Our buys raise later fill prices until they decay", "[impact]") {
+    MockExecutionEngine inner;
+    ctrade::ImpactConfig config;
+    config.coefficient = 0.01;
+    config.volume_scale = 100.0;
+    config.timescale = 60.0;
+    ctrade::ImpactExecutionEngine engine(inner, config);
+
+    // First buy pays its own impact
+    auto fills = engine.execute({market_order(1, ctrade::Side::Buy, 100.0)},
+                                quote(0, 1000.0));
+    REQUIRE(fills[0].price == Approx(1010.0));
+
+    // One timescale later half the pressure is left; a small sell fills
+    // above the undisturbed price
+    fills = engine.execute({market_order(2, ctrade::Side::Sell, 1.0)},
+                           quote(60, 1000.0));
+    REQUIRE(fills[0].price == Approx(1000.0 * 1.005 * (1.0 - 0.001)));
+
+    // Long after, the market is back to its own price
+    fills = engine.execute({market_order(3, ctrade::Side::Sell, 1.0)},
+                           quote(6000, 1000.0));
+    REQUIRE(fills[0].price == Approx(1000.0 * (1.0 - 0.001)).epsilon(1e-6));
+}
+
+TEST_CASE("Only taker fills pay their own impact", "[impact]") {
+    MockExecutionEngine inner;
+    ctrade::ImpactConfig config;
+    config.coefficient = 0.01;
+    config.volume_scale = 100.0;
+    config.timescale = 60.0;
+    ctrade::ImpactExecutionEngine engine(inner, config);
+
+    // A limit the inner engine filled by crossing pays like a market order
+    auto order = market_order(1, ctrade::Side::Buy, 100.0);
+    order.type = ctrade::OrderType::Limit;
+    auto fills = engine.execute({order}, quote(0, 1000.0));
+    REQUIRE(fills[0].price == Approx(1010.0));
+
+    // A resting fill keeps its price but still adds pressure
+    engine.model().reset();
+    inner.maker = true;
+    order.type = ctrade::OrderType::Market;
+    fills = engine.execute({order}, quote(0, 1000.0));
+    REQUIRE(fills[0].price == Approx(1000.0));
+    REQUIRE(engine.model().pressure(0, 0) == Approx(0.01));
+}
@@ -0,0 +1,167 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/intrabar_path.hpp"
+#include <vector>
+
+using Catch::Approx;
+
+static ctrade::MarketState bar(double open, double high, double low, double close) {
+    ctrade::MarketState m{};
+    m.timestamp = 6000;
+    m.open = open;
+    m.high = high;
+    m.low = low;
+    m.close = close;
+    return m;
+}
+
+static ctrade::Order resting(int64_t id, ctrade::Side side, ctrade::OrderType type,
+                             double price, double stop_price = 0.0) {
+    ctrade::Order o{};
+    o.id = id;
+    o.side = side;
+    o.type = type;
+    o.price = price;
+    o.stop_price = stop_price;
+    o.size = 1.0;
+    return o;
+}
+
+TEST_CASE("Path models order the extremes", "[intrabar]") {
+    // High is 2 away from the open, low is 5 away
+    auto b = bar(100.0, 102.0, 95.0, 101.0);
+
+    REQUIRE(ctrade::intrabar_path(b, ctrade::PathModel::OHLC) ==
+            std::vector<double>{100.0, 102.0, 95.0, 101.0});
+    REQUIRE(ctrade::intrabar_path(b, ctrade::PathModel::OLHC) ==
+            std::vector<double>{100.0, 95.0, 102.0, 101.0});
+    REQUIRE(ctrade::intrabar_path(b, ctrade::PathModel::NearestFirst) ==
+            std::vector<double>{100.0, 102.0, 95.0, 101.0});
+
+    REQUIRE_THROWS(ctrade::intrabar_path(b, ctrade::PathModel::BrownianBridge));
+}
+
+TEST_CASE("Take-profit and stop-loss resolve by path model", "[intrabar]") {
+    auto b = bar(100.0, 104.0, 96.0, 100.0);
+    std::vector<ctrade::Order> orders{
+        resting(1, ctrade::Side::Sell, ctrade::OrderType::Limit, 103.0),
+        resting(2, ctrade::Side::Sell, ctrade::OrderType::Stop, 0.0, 97.0),
+    };
+
+    auto high_first = ctrade::intrabar_path(b, ctrade::PathModel::OHLC);
+    auto fills = ctrade::resolve_on_path(orders, high_first, b, 60, {0.0, 0.0});
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].order_id == 1);
+    REQUIRE(fills[0].price == Approx(103.0));
+    REQUIRE(fills[1].order_id == 2);
+    REQUIRE(fills[1].price == Approx(97.0));
+    REQUIRE(fills[0].timestamp < fills[1].timestamp);
+    REQUIRE(fills[1].timestamp < 6060);
+
+    auto low_first = ctrade::intrabar_path(b, ctrade::PathModel::OLHC);
+    fills = ctrade::resolve_on_path(orders, low_first, b, 60, {0.0, 0.0});
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].order_id == 2);
+    REQUIRE(fills[1].order_id == 1);
+}
+
+TEST_CASE("Stop-limit waits for its limit after triggering", "[intrabar]") {
+    auto b = bar(100.0, 103.0, 95.0, 99.0);
+    auto order = resting(1, ctrade::Side::Buy, ctrade::OrderType::StopLimit, 96.0, 102.0);
+    std::vector<ctrade::Order> orders{order};
+
+    // Triggered on the way up, then filled at the limit on the way down
+    auto up_first = ctrade::intrabar_path(b, ctrade::PathModel::OHLC);
+    auto fills = ctrade::resolve_on_path(orders, up_first, b, 60, {0.001, 0.002});
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(96.0));
+    REQUIRE(fills[0].fee == Approx(96.0 * 0.001));
+
+    // Down leg comes before the trigger: no fill
+    auto down_first = ctrade::intrabar_path(b, ctrade::PathModel::OLHC);
+    REQUIRE(ctrade::resolve_on_path(orders, down_first, b, 60, {0.0, 0.0}).empty());
+}
+
+TEST_CASE("Limits need a trade-through unless marketable", "[intrabar]") {
+    auto b = bar(100.0, 104.0, 96.0, 100.0);
+    auto path = ctrade::intrabar_path(b, ctrade::PathModel::OHLC);
+    ctrade::FeeSchedule fees{0.001, 0.002};
+
+    // Touching the high exactly is not a fill
+    auto touch = resting(1, ctrade::Side::Sell, ctrade::OrderType::Limit, 104.0);
+    REQUIRE(ctrade::resolve_on_path(std::vector<ctrade::Order>{touch}, path, b, 60, fees)
+                .empty());
+
+    // A buy limit sent in this bar above the open takes liquidity there
+    auto through = resting(2, ctrade::Side::Buy, ctrade::OrderType::Limit, 101.0);
+    through.timestamp = 6000;
+    auto fills =
+        ctrade::resolve_on_path(std::vector<ctrade::Order>{through}, path, b, 60, fees);
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(100.0));
+    REQUIRE(fills[0].timestamp == 6000);
+    REQUIRE(fills[0].fee == Approx(100.0 * 0.002));
+}
+
+TEST_CASE("Resting limits fill at their price on a gap bar", "[intrabar]") {
+    // Gap open at 100 through a buy limit resting at 101 since earlier bars
+    auto b = bar(100.0, 104.0, 96.0, 100.0);
+    auto path = ctrade::intrabar_path(b, ctrade::PathModel::OHLC);
+    auto order = resting(1, ctrade::Side::Buy, ctrade::OrderType::Limit, 101.0);
+    order.timestamp = 5940;
+
+    auto fills = ctrade::resolve_on_path(std::vector<ctrade::Order>{order}, path, b, 60,
+                                         {0.001, 0.002});
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].price == Approx(101.0));
+    REQUIRE(fills[0].timestamp == 6000);
+    REQUIRE(fills[0].fee == Approx(101.0 * 0.001));
+    REQUIRE(fills[0].maker);
+}
+
+TEST_CASE("Ambiguous bars straddle the open", "[intrabar]") {
+    auto b = bar(100.0, 104.0, 96.0, 100.0);
+    auto above = resting(1, ctrade::Side::Sell, ctrade::OrderType::Limit, 103.0);
+    auto below = resting(2, ctrade::Side::Sell, ctrade::OrderType::Stop, 0.0, 97.0);
+
+    REQUIRE(ctrade::is_ambiguous(std::vector<ctrade::Order>{above, below}, b));
+    REQUIRE_FALSE(ctrade::is_ambiguous(std::vector<ctrade::Order>{above}, b));
+}
+
+TEST_CASE("Path sampling is independent of thread count", "[intrabar]") {
+    std::vector<ctrade::AmbiguousBar> bars;
+    for (int i = 0; i < 5; ++i) {
+        auto b = bar(100.0, 104.0 + i, 96.0 - i, 100.0 + 0.5 * i);
+        bars.push_back({b, {
+            resting(1, ctrade::Side::Sell, ctrade::OrderType::Limit, 103.0),
+            resting(2, ctrade::Side::Sell, ctrade::OrderType::Stop, 0.0, 97.0),
+        }});
+    }
+
+    // +1 per bar where the target fills before the stop
+    auto evaluate = [](std::span<const std::vector<ctrade::Fill>> fills) {
+        double wins = 0.0;
+        for (const auto &bar_fills : fills) {
+            if (!bar_fills.empty() && bar_fills.front().order_id == 1) {
+                wins += 1.0;
+            }
+        }
+        return wins;
+    };
+
+    ctrade::SweepConfig single{1, 7, true};
+    ctrade::SweepConfig many{8, 7, true};
+    auto a = ctrade::sample_ambiguous_paths(bars, 64, evaluate, 60, {0.0, 0.0}, single);
+    auto b = ctrade::sample_ambiguous_paths(bars, 64, evaluate, 60, {0.0, 0.0}, many);
+    REQUIRE(a == b);
+
+    // Both orderings occur across samples
+    bool saw_win = false;
+    bool saw_loss = false;
+    for (double v : a) {
+        saw_win = saw_win || v > 0.0;
+        saw_loss = saw_loss || v < 5.0;
+    }
+    REQUIRE(saw_win);
+    REQUIRE(saw_loss);
+}
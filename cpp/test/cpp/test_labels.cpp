@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/labels.hpp"
+#include "ctrade/rng.hpp"
+#include "fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bar-by-bar reference
+static void naive_label(const ctrade::BarStore& bars, size_t i, const ctrade::TripleBarrierConfig& config,
+                        double scale, int& label, double& ret, size_t& exit) {
+    const double entry = bars.close()[i];
+    const double upper = entry * (1.0 + config.take_profit * scale);
+    const double lower = entry * (1.0 - config.stop_loss * scale);
+    for (size_t j = i + 1; j <= i + config.max_holding && j < bars.size(); ++j) {
+        if (bars.low()[j] <= lower) {
+            label = -1;
+            ret = lower / entry - 1.0;
+            exit = j;
+            return;
+        }
+        if (bars.high()[j] >= upper) {
+            label = 1;
+            ret = upper / entry - 1.0;
+            exit = j;
+            return;
+        }
+    }
+    label = 0;
+    const size_t last = i + config.max_holding;
+    exit = last < bars.size() ? last : bars.size();
+    ret = last < bars.size() ? bars.close()[last] / entry - 1.0 : std::nan("");
+}
+
+TEST_CASE("Triple-barrier labels match a bar-by-bar scan", "[labels]") {
+    auto bars = random_bars(150000, 0);
+    std::vector<double> scale(bars.size());
+    for (size_t i = 0; i < scale.size(); ++i) {
+        scale[i] = 1.0 + 0.5 * std::sin(0.001 * static_cast<double>(i));
+    }
+    ctrade::TripleBarrierConfig config;
+    config.take_profit = 0.004;
+    config.stop_loss = 0.003;
+    config.max_holding = 500;
+
+    auto labels = ctrade::triple_barrier_labels(bars, config, scale, 4);
+    REQUIRE(labels.label.size() == bars.size());
+    size_t counts[3] = {0, 0, 0};
+    for (size_t i = 0; i < bars.size(); ++i) {
+        int label;
+        double ret;
+        size_t exit;
+        naive_label(bars, i, config, scale[i], label, ret, exit);
+        REQUIRE(labels.label[i] == label);
+        REQUIRE(labels.exit[i] == exit);
+        REQUIRE((labels.ret[i] == ret || (std::isnan(ret) && std::isnan(labels.ret[i]))));
+        counts[label + 1]++;
+    }
+    // Every outcome occurs
+    REQUIRE(counts[0] > 0);
+    REQUIRE(counts[1] > 0);
+    REQUIRE(counts[2] > 0);
+
+    // Thread count does not change anything
+    auto serial = ctrade::triple_barrier_labels(bars, config, scale, 1);
+    REQUIRE(serial.label == labels.label);
+    REQUIRE(serial.exit == labels.exit);
+}
+
+TEST_CASE("Barrier edge cases", "[labels]") {
+    ctrade::BarStore bars(0);
+    auto add = [&](double low, double high, double close) {
+        ctrade::MarketState bar{};
+        bar.timestamp = static_cast<int64_t>(bars.size());
+        bar.open = close;
+        bar.high = high;
+        bar.low = low;
+        bar.close = close;
+        bars.append(bar);
+    };
+    add(100.0, 100.0, 100.0);
+    add(98.0, 102.0, 100.0);  // touches both barriers of bar 0
+    add(100.0, 100.5, 100.0);
+    add(100.0, 100.2, 100.1);
+
+    ctrade::TripleBarrierConfig config;
+    config.take_profit = 0.01;
+    config.stop_loss = 0.01;
+    config.max_holding = 2;
+    auto labels = ctrade::triple_barrier_labels(bars, config);
+    REQUIRE(labels.label[0] == -1);
+    REQUIRE(labels.exit[0] == 1);
+    REQUIRE(std::abs(labels.ret[0] + 0.01) < 1e-12);
+    REQUIRE(labels.label[1] == 0);
+    REQUIRE(labels.exit[1] == 3);
+    REQUIRE(std::abs(labels.ret[1] - 0.001) < 1e-12);
+    REQUIRE(std::isnan(labels.ret[2]));
+    REQUIRE(labels.exit[3] == 4);
+
+    // Without a stop the touch at bar 1 is a take-profit
+    config.stop_loss = 0.0;
+    REQUIRE(ctrade::triple_barrier_labels(bars, config).label[0] == 1);
+
+    std::vector<double> short_scale{1.0};
+    REQUIRE_THROWS(ctrade::triple_barrier_labels(bars, config, short_scale));
+}
+
+TEST_CASE("Stores are labeled together and forward returns line up", "[labels]") {
+    auto a = random_bars(70000, 1);
+    auto b = random_bars(1000, 2);
+    ctrade::TripleBarrierConfig config;
+    config.max_holding = 120;
+    config.take_profit = 0.002;
+    config.stop_loss = 0.002;
+    std::vector<ctrade::LabelJob> jobs{{&a, {}}, {&b, {}}};
+    auto both = ctrade::triple_barrier_labels(jobs, config, 3);
+    REQUIRE(both.size() == 2);
+    REQUIRE(both[0].label == ctrade::triple_barrier_labels(a, config).label);
+    REQUIRE(both[1].ret.size() == 1000);
+
+    std::vector<size_t> horizons{1, 60, 0};
+    auto fwd = ctrade::forward_returns(a, horizons, 4);
+    REQUIRE(fwd.size() == 3);
+    REQUIRE(fwd[0][10] == a.close()[11] / a.close()[10] - 1.0);
+    REQUIRE(fwd[1][69000] == a.close()[69060] / a.close()[69000] - 1.0);
+    REQUIRE(std::isnan(fwd[1][69940]));
+    REQUIRE(!std::isnan(fwd[1][69939]));
+    REQUIRE(fwd[2][5] == 0.0);
+}
@@ -1,7 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include "ctrade/asset_slice.hpp"
 #include "ctrade/market_data.hpp"
 #include "ctrade/market_state.hpp"
+#include <stdexcept>
 #include <vector>
 
 using Catch::Approx;
@@ -98,3 +100,53 @@ TEST_CASE("MarketState includes funding rate", "[market_data]") {
     REQUIRE(state.funding_rate == Approx(0.0001));
 }
 
+TEST_CASE("AssetSliceBuffer lays out assets as columns", "[market_data]") {
+    ctrade::AssetSliceBuffer buffer(3);
+    buffer.begin(1000);
+
+    ctrade::MarketState btc{};
+    btc.asset_id = 0;
+    btc.close = 102.0;
+    btc.volume = 1000.0;
+    btc.funding_rate = 0.0001;
+    buffer.set(btc);
+
+    ctrade::MarketState eth{};
+    eth.asset_id = 2;
+    eth.close = 5.0;
+    eth.volume = 300.0;
+    eth.funding_rate = -0.0002;
+    buffer.set(eth);
+
+    auto slice = buffer.view();
+    REQUIRE(slice.timestamp == 1000);
+    REQUIRE(slice.size() == 3);
+    REQUIRE(slice.close[0] == Approx(102.0));
+    REQUIRE(slice.close[1] == Approx(0.0));
+    REQUIRE(slice.close[2] == Approx(5.0));
+    REQUIRE(slice.volume[2] == Approx(300.0));
+    REQUIRE(slice.funding_rate[2] == Approx(-0.0002));
+}
+
+TEST_CASE("AssetSliceBuffer carries forward assets without a new bar", "[market_data]") {
+    ctrade::AssetSliceBuffer buffer(2);
+
+    ctrade::MarketState s{};
+    s.asset_id = 1;
+    s.close = 50.0;
+    buffer.begin(1000);
+    buffer.set(s);
+
+    buffer.begin(2000);
+    auto slice = buffer.view();
+    REQUIRE(slice.timestamp == 2000);
+    REQUIRE(slice.close[1] == Approx(50.0));
+}
+
+TEST_CASE("AssetSliceBuffer rejects unknown asset_id", "[market_data]") {
+    ctrade::AssetSliceBuffer buffer(1);
+
+    ctrade::MarketState s{};
+    s.asset_id = 1;
+    REQUIRE_THROWS_AS(buffer.set(s), std::out_of_range);
+}
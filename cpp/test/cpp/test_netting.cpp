@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/execution_engine.hpp"
+#include "ctrade/netting.hpp"
+#include <vector>
+
+using Catch::Approx;
+
+// Fills every order at the close with a fixed taker fee rate
+class MockExecutionEngine : public ctrade::ExecutionEngine {
+public:
+    explicit MockExecutionEngine(double fee_rate) : fee_rate_(fee_rate) {}
+
+    std::vector<ctrade::Fill> execute(
+        const std::vector<ctrade::Order>& orders,
+        const ctrade::MarketState& market
+    ) override {
+        std::vector<ctrade::Fill> fills;
+        for (const auto& order : orders) {
+            ctrade::Fill fill{};
+            fill.order_id = order.id;
+            fill.asset_id = order.asset_id;
+            fill.venue_id = order.venue_id;
+            fill.price = market.close;
+            fill.size = order.size;
+            fill.fee = order.size * market.close * fee_rate_;
+            fill.timestamp = market.timestamp;
+            fills.push_back(fill);
+        }
+        return fills;
+    }
+
+private:
+    double fee_rate_;
+};
+
+static ctrade::Order market(int asset, ctrade::Side side, double size) {
+    ctrade::Order order{};
+    order.asset_id = asset;
+    order.side = side;
+    order.type = ctrade::OrderType::Market;
+    order.size = size;
+    return order;
+}
+
+TEST_CASE("Opposing orders cross internally and the rest is netted", "[netting]") {
+    ctrade::OrderNetter netter(3);
+    const auto a = netter.submit(0, market(0, ctrade::Side::Buy, 3.0));
+    const auto b = netter.submit(1, market(0, ctrade::Side::Sell, 1.0));
+    const auto c = netter.submit(2, market(0, ctrade::Side::Buy, 1.0));
+    netter.submit(2, market(1, ctrade::Side::Sell, 2.0));
+
+    std::vector<double> prices{100.0, 50.0};
+    std::vector<ctrade::StrategyFill> crossed;
+    auto orders = netter.net(prices, 60, crossed);
+
+    // Buys cross a quarter of their size against the one sell
+    REQUIRE(crossed.size() == 3);
+    REQUIRE(crossed[0].strategy == 0);
+    REQUIRE(crossed[0].fill.order_id == a);
+    REQUIRE(crossed[0].fill.size == Approx(0.75));
+    REQUIRE(crossed[1].fill.order_id == c);
+    REQUIRE(crossed[1].fill.size == Approx(0.25));
+    REQUIRE(crossed[2].fill.order_id == b);
+    REQUIRE(crossed[2].side == ctrade::Side::Sell);
+    REQUIRE(crossed[2].fill.size == 1.0);
+    REQUIRE(crossed[2].fill.price == 100.0);
+    REQUIRE(crossed[2].fill.fee == 0.0);
+
+    REQUIRE(orders.size() == 2);
+    REQUIRE(orders[0].asset_id == 0);
+    REQUIRE(orders[0].side == ctrade::Side::Buy);
+    REQUIRE(orders[0].size == Approx(3.0));
+    REQUIRE(orders[1].asset_id == 1);
+    REQUIRE(orders[1].size == 2.0);
+    REQUIRE(netter.stats().orders_in == 4);
+    REQUIRE(netter.stats().orders_out == 2);
+    REQUIRE(netter.stats().crossed_size == 1.0);
+
+    // The engine fill is split pro rata, fees included
+    MockExecutionEngine engine(0.001);
+    ctrade::MarketState bar{};
+    bar.close = 101.0;
+    auto attributed = netter.attribute(engine.execute({orders[0]}, bar));
+    REQUIRE(attributed.size() == 2);
+    REQUIRE(attributed[0].strategy == 0);
+    REQUIRE(attributed[0].fill.order_id == a);
+    REQUIRE(attributed[0].fill.size == Approx(2.25));
+    REQUIRE(attributed[0].fill.fee == Approx(2.25 * 101.0 * 0.001));
+    REQUIRE(attributed[1].strategy == 2);
+    REQUIRE(attributed[1].fill.size == Approx(0.75));
+}
+
+TEST_CASE("Netting saves fees against separate runs", "[netting]") {
+    const std::vector<double> cash{10000.0, 10000.0};
+    std::vector<double> prices{100.0};
+    MockExecutionEngine engine(0.001);
+    ctrade::MarketState bar{};
+
+    // Trend follower and mean reverter trading against each other
+    auto orders_for = [](size_t bar_index, size_t strategy) {
+        const bool up = bar_index % 3 != 0;
+        const bool buy = strategy == 0 ? up : !up;
+        return market(0, buy ? ctrade::Side::Buy : ctrade::Side::Sell, strategy == 0 ? 2.0 : 1.0);
+    };
+
+    ctrade::OrderNetter netter(2);
+    ctrade::StrategyBook netted(cash, 1);
+    ctrade::StrategyBook separate(cash, 1);
+    for (size_t i = 0; i < 30; ++i) {
+        prices[0] = bar.close = 100.0 + static_cast<double>(i % 5);
+        std::vector<ctrade::StrategyFill> fills;
+        for (size_t s = 0; s < 2; ++s) {
+            netter.submit(s, orders_for(i, s));
+
+            auto own = orders_for(i, s);
+            own.id = 1;
+            for (const auto& fill : engine.execute({own}, bar)) {
+                separate.apply({s, own.side, fill});
+            }
+        }
+        auto orders = netter.net(prices, bar.timestamp, fills);
+        for (const auto& fill : netter.attribute(engine.execute(orders, bar))) {
+            fills.push_back(fill);
+        }
+        for (const auto& fill : fills) {
+            netted.apply(fill);
+        }
+    }
+
+    // Same positions, a third of the fees
+    for (size_t s = 0; s < 2; ++s) {
+        REQUIRE(netted.position(s, 0) == Approx(separate.position(s, 0)));
+    }
+    const double fees = netted.fees(0) + netted.fees(1);
+    REQUIRE(fees == Approx((separate.fees(0) + separate.fees(1)) / 3.0));
+    REQUIRE(netted.total_equity(prices) == Approx(separate.total_equity(prices) + separate.fees(0) +
+                                                  separate.fees(1) - fees));
+    REQUIRE(netter.stats().orders_out == 30);
+}
+
+TEST_CASE("Other orders pass through and routing is released", "[netting]") {
+    ctrade::OrderNetter netter(2);
+    auto limit = market(0, ctrade::Side::Buy, 4.0);
+    limit.type = ctrade::OrderType::Limit;
+    limit.price = 99.0;
+    const auto id = netter.submit(1, limit);
+    netter.submit(0, market(0, ctrade::Side::Buy, 1.0));
+    netter.submit(1, market(0, ctrade::Side::Sell, 1.0));
+
+    std::vector<double> prices{100.0};
+    std::vector<ctrade::StrategyFill> crossed;
+    auto orders = netter.net(prices, 0, crossed);
+    REQUIRE(crossed.size() == 2);
+    REQUIRE(orders.size() == 1);
+    REQUIRE(orders[0].id == id);
+    REQUIRE(orders[0].type == ctrade::OrderType::Limit);
+
+    // Partial fills go to the owner until the order is done
+    ctrade::Fill fill{};
+    fill.order_id = id;
+    fill.price = 99.0;
+    fill.size = 1.5;
+    auto first = netter.attribute(std::vector<ctrade::Fill>{fill});
+    REQUIRE(first.size() == 1);
+    REQUIRE(first[0].strategy == 1);
+    REQUIRE(first[0].fill.size == 1.5);
+    fill.size = 2.5;
+    netter.attribute(std::vector<ctrade::Fill>{fill});
+    REQUIRE_THROWS(netter.attribute(std::vector<ctrade::Fill>{fill}));
+
+    REQUIRE_THROWS(netter.submit(2, market(0, ctrade::Side::Buy, 1.0)));
+    REQUIRE_THROWS(netter.submit(0, market(0, ctrade::Side::Buy, 0.0)));
+    netter.submit(0, market(3, ctrade::Side::Buy, 1.0));
+    REQUIRE_THROWS(netter.net(prices, 0, crossed));
+}
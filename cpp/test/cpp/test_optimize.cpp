@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/optimize.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+// Two-bar equity curve whose return peaks at (0.6, -1.2)
+static ctrade::BacktestResult bowl(const ctrade::ParamSet& params, ctrade::CounterRng&) {
+    const double dx = params[0] - 0.6;
+    const double dy = params[1] + 1.2;
+    ctrade::BacktestResult result;
+    result.timestamps = {0, 1};
+    result.equity = {1.0, std::exp(-(dx * dx + dy * dy))};
+    return result;
+}
+
+static std::vector<ctrade::ParamBound> square() {
+    return {{-2.0, 2.0}, {-2.0, 2.0}};
+}
+
+static double distance_to_peak(const ctrade::ParamSet& p) {
+    return std::hypot(p[0] - 0.6, p[1] + 1.2);
+}
+
+static ctrade::OptimizeResult run(ctrade::OptimizerKind kind, size_t budget, unsigned threads) {
+    ctrade::OptimizeConfig config;
+    config.kind = kind;
+    config.budget = budget;
+    config.sweep.threads = threads;
+    config.sweep.seed = 7;
+    return ctrade::optimize(square(), bowl,
+                            ctrade::make_objective(ctrade::ObjectiveKind::TotalReturn),
+                            config);
+}
+
+TEST_CASE("Sobol points stratify every dimension", "[optimize]") {
+    ctrade::SobolSequence sobol(ctrade::SobolSequence::kMaxDims);
+
+    auto first = sobol.next();
+    REQUIRE(first[0] == 0.5);
+    REQUIRE(first[1] == 0.5);
+    auto second = sobol.next();
+    REQUIRE(second[0] == 0.75);
+    REQUIRE(second[1] == 0.25);
+
+    // With the skipped origin, the first 2^k - 1 points leave exactly one
+    // empty cell of width 2^-k per dimension: the one holding zero.
+    std::vector<std::vector<double>> points{first, second};
+    for (int i = 2; i < 63; ++i) {
+        points.push_back(sobol.next());
+    }
+    for (size_t d = 0; d < ctrade::SobolSequence::kMaxDims; ++d) {
+        std::vector<int> cells(64, 0);
+        for (const auto& p : points) {
+            cells[static_cast<size_t>(p[d] * 64.0)]++;
+        }
+        REQUIRE(cells[0] == 0);
+        for (size_t c = 1; c < cells.size(); ++c) {
+            REQUIRE(cells[c] == 1);
+        }
+    }
+
+    REQUIRE_THROWS(ctrade::SobolSequence(ctrade::SobolSequence::kMaxDims + 1));
+}
+
+TEST_CASE("Optimization results do not depend on the thread count", "[optimize][determinism]") {
+    for (auto kind : {ctrade::OptimizerKind::Random, ctrade::OptimizerKind::CmaEs,
+                      ctrade::OptimizerKind::Tpe}) {
+        auto serial = run(kind, 60, 1);
+        auto threaded = run(kind, 60, 4);
+
+        REQUIRE(serial.trials.size() == 60);
+        REQUIRE(serial.best_index == threaded.best_index);
+        for (size_t i = 0; i < serial.trials.size(); ++i) {
+            REQUIRE(serial.trials[i].params == threaded.trials[i].params);
+            REQUIRE(serial.trials[i].score == threaded.trials[i].score);
+        }
+    }
+}
+
+TEST_CASE("Model-based optimizers beat random search", "[optimize]") {
+    auto random = run(ctrade::OptimizerKind::Random, 160, 2);
+    auto cma = run(ctrade::OptimizerKind::CmaEs, 160, 2);
+    auto tpe = run(ctrade::OptimizerKind::Tpe, 160, 2);
+    const double random_distance = distance_to_peak(random.trials[random.best_index].params);
+    const double cma_distance = distance_to_peak(cma.trials[cma.best_index].params);
+    const double tpe_distance = distance_to_peak(tpe.trials[tpe.best_index].params);
+
+    REQUIRE(cma_distance < 0.01);
+    REQUIRE(cma_distance < random_distance);
+    REQUIRE(tpe_distance < 0.05);
+    REQUIRE(tpe_distance < random_distance);
+}
+
+TEST_CASE("Best trial holds the highest score", "[optimize]") {
+    auto result = run(ctrade::OptimizerKind::Sobol, 32, 2);
+
+    for (const auto& trial : result.trials) {
+        REQUIRE(trial.score <= result.trials[result.best_index].score);
+        REQUIRE(trial.score == Approx(trial.summary.total_return));
+    }
+}
+
+TEST_CASE("Integer parameters are rounded inside their bounds", "[optimize]") {
+    std::vector<ctrade::ParamBound> bounds{{2.0, 30.0, true}, {0.5, 1.5}};
+    auto record = [](const ctrade::ParamSet& params, ctrade::CounterRng&) {
+        ctrade::BacktestResult result;
+        result.timestamps = {0, 1};
+        result.equity = {1.0, 1.0 + params[1] - std::abs(params[0] - 10.0) * 0.01};
+        return result;
+    };
+
+    ctrade::OptimizeConfig config;
+    config.kind = ctrade::OptimizerKind::Tpe;
+    config.budget = 40;
+    config.sweep.threads = 1;
+    auto result = ctrade::optimize(bounds, record,
+                                   ctrade::make_objective(ctrade::ObjectiveKind::TotalReturn),
+                                   config);
+
+    for (const auto& trial : result.trials) {
+        REQUIRE(trial.params[0] == std::round(trial.params[0]));
+        REQUIRE(trial.params[0] >= 2.0);
+        REQUIRE(trial.params[0] <= 30.0);
+        REQUIRE(trial.params[1] >= 0.5);
+        REQUIRE(trial.params[1] <= 1.5);
+    }
+
+    config.batch_size = 0;
+    REQUIRE_THROWS(ctrade::optimize(bounds, record,
+                                    ctrade::make_objective(ctrade::ObjectiveKind::Sharpe),
+                                    config));
+
+    // No trials means no best trial to report
+    config.batch_size = 8;
+    config.budget = 0;
+    REQUIRE_THROWS_AS(ctrade::optimize(bounds, record,
+                                       ctrade::make_objective(ctrade::ObjectiveKind::Sharpe),
+                                       config),
+                      std::invalid_argument);
+    config.budget = 40;
+
+    // No integer lies in [0.2, 0.8]
+    bounds[0] = ctrade::ParamBound{0.2, 0.8, true};
+    REQUIRE_THROWS_AS(ctrade::optimize(bounds, record,
+                                       ctrade::make_objective(ctrade::ObjectiveKind::Sharpe),
+                                       config),
+                      std::invalid_argument);
+}
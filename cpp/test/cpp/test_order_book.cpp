@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/order_book.hpp"
+#include <vector>
+
+using Catch::Approx;
+
+static ctrade::Order limit(int64_t id, ctrade::Side side, double price, double size) {
+    ctrade::Order o{};
+    o.id = id;
+    o.side = side;
+    o.type = ctrade::OrderType::Limit;
+    o.price = price;
+    o.size = size;
+    return o;
+}
+
+static std::vector<int64_t> ids(const ctrade::OrderBook& book) {
+    std::vector<int64_t> out;
+    for (const auto& o : book.resting()) {
+        out.push_back(o.id);
+    }
+    return out;
+}
+
+TEST_CASE("Order book keeps price-time priority", "[order_book]") {
+    ctrade::OrderBook book;
+    book.add(limit(1, ctrade::Side::Buy, 99.0, 1.0));
+    book.add(limit(2, ctrade::Side::Buy, 100.0, 1.0));
+    book.add(limit(3, ctrade::Side::Buy, 100.0, 2.0));
+    book.add(limit(4, ctrade::Side::Sell, 102.0, 1.0));
+    book.add(limit(5, ctrade::Side::Sell, 101.0, 1.0));
+
+    REQUIRE(ids(book) == std::vector<int64_t>{2, 3, 1, 5, 4});
+    REQUIRE(book.queue_ahead(3) == Approx(1.0));
+    REQUIRE(book.queue_ahead(2) == 0.0);
+
+    REQUIRE_THROWS(book.add(limit(1, ctrade::Side::Buy, 98.0, 1.0)));
+}
+
+TEST_CASE("Reducing size keeps queue priority", "[order_book]") {
+    ctrade::OrderBook book;
+    book.add(limit(1, ctrade::Side::Buy, 100.0, 3.0));
+    book.add(limit(2, ctrade::Side::Buy, 100.0, 1.0));
+
+    const ctrade::Order* before = book.find(1);
+    REQUIRE(book.amend(1, 2.0, 100.0));
+
+    // Amended in place: same storage, same position
+    REQUIRE(book.find(1) == before);
+    REQUIRE(book.find(1)->size == Approx(2.0));
+    REQUIRE(ids(book) == std::vector<int64_t>{1, 2});
+    REQUIRE(book.queue_ahead(2) == Approx(2.0));
+}
+
+TEST_CASE("Increasing size or moving price loses priority", "[order_book]") {
+    ctrade::OrderBook book;
+    book.add(limit(1, ctrade::Side::Sell, 101.0, 1.0));
+    book.add(limit(2, ctrade::Side::Sell, 101.0, 1.0));
+    book.add(limit(3, ctrade::Side::Sell, 102.0, 1.0));
+
+    REQUIRE(book.amend(1, 1.5, 101.0));
+    REQUIRE(ids(book) == std::vector<int64_t>{2, 1, 3});
+
+    const ctrade::Order* before = book.find(2);
+    REQUIRE(book.amend(2, 1.0, 102.0));
+    REQUIRE(book.find(2) == before);
+    REQUIRE(book.find(2)->price == Approx(102.0));
+    REQUIRE(ids(book) == std::vector<int64_t>{1, 3, 2});
+    REQUIRE(book.queue_ahead(2) == Approx(1.0));
+}
+
+TEST_CASE("Amends apply to the trigger of plain stops", "[order_book]") {
+    ctrade::OrderBook book;
+    ctrade::Order stop{};
+    stop.id = 7;
+    stop.side = ctrade::Side::Sell;
+    stop.type = ctrade::OrderType::Stop;
+    stop.stop_price = 95.0;
+    stop.size = 1.0;
+    book.add(stop);
+
+    REQUIRE(book.amend(7, 1.0, 96.0));
+    REQUIRE(book.find(7)->stop_price == Approx(96.0));
+}
+
+TEST_CASE("Cancels, zero-size amends and fills remove orders", "[order_book]") {
+    ctrade::OrderBook book(8);
+    book.add(limit(1, ctrade::Side::Buy, 100.0, 1.0));
+    book.add(limit(2, ctrade::Side::Buy, 100.0, 2.0));
+    book.add(limit(3, ctrade::Side::Buy, 99.0, 1.0));
+
+    REQUIRE(book.cancel(1));
+    REQUIRE_FALSE(book.cancel(1));
+    REQUIRE_FALSE(book.amend(1, 1.0, 100.0));
+
+    REQUIRE(book.amend(3, 0.0, 99.0));
+    REQUIRE(book.find(3) == nullptr);
+
+    ctrade::Fill partial{};
+    partial.order_id = 2;
+    partial.size = 0.5;
+    book.apply_fills(std::vector<ctrade::Fill>{partial});
+    REQUIRE(book.find(2)->size == Approx(1.5));
+
+    partial.size = 1.5;
+    book.apply_fills(std::vector<ctrade::Fill>{partial});
+    REQUIRE(book.empty());
+
+    // Freed slots are reused
+    book.add(limit(4, ctrade::Side::Sell, 101.0, 1.0));
+    REQUIRE(ids(book) == std::vector<int64_t>{4});
+}
+
+TEST_CASE("Stops wait outside the visible book", "[order_book]") {
+    ctrade::OrderBook book;
+    book.add(limit(1, ctrade::Side::Buy, 100.0, 1.0));
+    ctrade::Order stop{};
+    stop.id = 2;
+    stop.side = ctrade::Side::Buy;
+    stop.type = ctrade::OrderType::Stop;
+    stop.stop_price = 100.0;
+    stop.size = 5.0;
+    book.add(stop);
+    stop.id = 3;
+    stop.stop_price = 98.0;
+    book.add(stop);
+    stop.id = 4;
+    stop.side = ctrade::Side::Sell;
+    stop.type = ctrade::OrderType::StopLimit;
+    stop.stop_price = 95.0;
+    stop.price = 94.0;
+    book.add(stop);
+    book.add(limit(5, ctrade::Side::Buy, 100.0, 1.0));
+
+    // The buy stop at 100 neither shows as a bid nor queues ahead of 5
+    REQUIRE(ids(book) == std::vector<int64_t>{1, 5});
+    REQUIRE(book.queue_ahead(5) == Approx(1.0));
+    REQUIRE(book.queue_ahead(2) == 0.0);
+    std::vector<int64_t> stops;
+    for (const auto& o : book.stops()) {
+        stops.push_back(o.id);
+    }
+    REQUIRE(stops == std::vector<int64_t>{3, 2, 4});
+    REQUIRE(book.size() == 5);
+
+    REQUIRE(book.cancel(2));
+    REQUIRE(book.stops().size() == 2);
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/rebalancer.hpp"
+#include <vector>
+
+using Catch::Approx;
+
+TEST_CASE("Rebalance emits one order per changed asset", "[rebalancer]") {
+    std::vector<double> current = {1.0, 0.0, -2.0};
+    std::vector<double> target = {1.5, 0.0, -1.0};
+    std::vector<double> prices = {100.0, 50.0, 10.0};
+    std::vector<ctrade::InstrumentSpec> specs(3, {0.001, 5.0});
+
+    auto orders = ctrade::rebalance_orders(current, target, prices, specs);
+
+    REQUIRE(orders.size() == 2);
+    REQUIRE(orders[0].asset_id == 0);
+    REQUIRE(orders[0].side == ctrade::Side::Buy);
+    REQUIRE(orders[0].type == ctrade::OrderType::Market);
+    REQUIRE(orders[0].size == Approx(0.5));
+    REQUIRE(orders[1].asset_id == 2);
+    REQUIRE(orders[1].side == ctrade::Side::Buy);
+    REQUIRE(orders[1].size == Approx(1.0));
+}
+
+TEST_CASE("Rebalance rounds toward zero to the lot size", "[rebalancer]") {
+    std::vector<double> current = {0.0, 0.0};
+    std::vector<double> target = {0.37, -0.3};
+    std::vector<double> prices = {100.0, 100.0};
+    std::vector<ctrade::InstrumentSpec> specs(2, {0.1, 0.0});
+
+    auto orders = ctrade::rebalance_orders(current, target, prices, specs);
+
+    REQUIRE(orders.size() == 2);
+    REQUIRE(orders[0].size == Approx(0.3));
+    REQUIRE(orders[1].side == ctrade::Side::Sell);
+    REQUIRE(orders[1].size == Approx(0.3));
+}
+
+TEST_CASE("Rebalance drops changes below min notional", "[rebalancer]") {
+    std::vector<double> current = {1.0};
+    std::vector<double> target = {1.04};
+    std::vector<double> prices = {100.0};
+    std::vector<ctrade::InstrumentSpec> specs = {{0.01, 5.0}};
+
+    // 0.04 * 100 = 4 < 5
+    auto orders = ctrade::rebalance_orders(current, target, prices, specs);
+    REQUIRE(orders.empty());
+}
+
+TEST_CASE("Rebalance always flattens a closed position", "[rebalancer]") {
+    std::vector<double> current = {-0.013};
+    std::vector<double> target = {0.0};
+    std::vector<double> prices = {100.0};
+    std::vector<ctrade::InstrumentSpec> specs = {{0.01, 5.0}};
+
+    auto orders = ctrade::rebalance_orders(current, target, prices, specs);
+
+    REQUIRE(orders.size() == 1);
+    REQUIRE(orders[0].side == ctrade::Side::Buy);
+    REQUIRE(orders[0].size == Approx(0.013));
+}
+
+TEST_CASE("Weights convert to positions through equity", "[rebalancer]") {
+    std::vector<double> weights = {0.5, -0.25};
+    std::vector<double> prices = {100.0, 20.0};
+
+    auto positions = ctrade::weights_to_positions(weights, prices, 10000.0);
+
+    REQUIRE(positions[0] == Approx(50.0));
+    REQUIRE(positions[1] == Approx(-125.0));
+}
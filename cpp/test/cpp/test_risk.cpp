@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/risk.hpp"
+#include <cmath>
+#include <vector>
+
+using Catch::Approx;
+
+// Deterministic correlated returns for three assets
+static std::vector<std::vector<double>> sample_returns(int n) {
+    std::vector<std::vector<double>> out;
+    for (int t = 0; t < n; ++t) {
+        double common = 0.01 * std::sin(0.7 * t);
+        out.push_back({
+            common + 0.004 * std::cos(1.3 * t),
+            0.5 * common + 0.02 * std::sin(2.1 * t + 1.0),
+            -0.3 * common + 0.008 * std::cos(0.4 * t + 2.0),
+        });
+    }
+    return out;
+}
+
+TEST_CASE("EWMA covariance matches the weighted sum over history", "[risk]") {
+    const double lambda = 0.9;
+    auto returns = sample_returns(50);
+    ctrade::EwmaCovariance cov(3, lambda);
+    for (const auto& r : returns) {
+        cov.update(r);
+    }
+    REQUIRE(cov.observations() == 50);
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            double num = 0.0;
+            double den = 0.0;
+            for (size_t t = 0; t < returns.size(); ++t) {
+                double w = std::pow(lambda, static_cast<double>(returns.size() - 1 - t));
+                num += w * returns[t][i] * returns[t][j];
+                den += w;
+            }
+            REQUIRE(cov.covariance(i, j) == Approx(num / den));
+        }
+    }
+    auto m = cov.matrix();
+    REQUIRE(m[1] == Approx(cov.covariance(0, 1)));
+    REQUIRE(m[3] == Approx(m[1]));
+}
+
+TEST_CASE("Portfolio volatility and VaR", "[risk]") {
+    ctrade::EwmaCovariance cov(2, 0.5);
+    cov.update(std::vector<double>{0.02, 0.0});
+    cov.update(std::vector<double>{0.0, 0.01});
+
+    // Bias-corrected weights 1/3 and 2/3
+    REQUIRE(cov.covariance(0, 0) == Approx(0.0004 / 3.0));
+    REQUIRE(cov.covariance(1, 1) == Approx(0.0001 * 2.0 / 3.0));
+    REQUIRE(cov.covariance(0, 1) == 0.0);
+
+    std::vector<double> w{0.5, 0.5};
+    double var = 0.25 * 0.0004 / 3.0 + 0.25 * 0.0002 / 3.0;
+    REQUIRE(cov.variance(w) == Approx(var));
+    REQUIRE(cov.value_at_risk(w, 0.99) == Approx(2.3263478740 * std::sqrt(var)));
+
+    REQUIRE(ctrade::normal_quantile(0.975) == Approx(1.959963985));
+    REQUIRE(ctrade::normal_quantile(0.01) == Approx(-2.326347874));
+    REQUIRE(ctrade::normal_quantile(0.5) == Approx(0.0).margin(1e-12));
+}
+
+TEST_CASE("Risk parity equalizes risk contributions", "[risk]") {
+    ctrade::EwmaCovariance cov(3, 0.97);
+
+    // Equal weights until every asset has variance
+    auto w = cov.risk_parity_weights();
+    REQUIRE(w[0] == Approx(1.0 / 3.0));
+
+    for (const auto& r : sample_returns(200)) {
+        cov.update(r);
+    }
+    w = cov.risk_parity_weights();
+
+    double total = 0.0;
+    std::vector<double> contribution(3, 0.0);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            contribution[i] += w[i] * cov.covariance(i, j) * w[j];
+        }
+        total += w[i];
+        REQUIRE(w[i] > 0.0);
+    }
+    REQUIRE(total == Approx(1.0));
+    REQUIRE(contribution[0] == Approx(contribution[1]).epsilon(1e-6));
+    REQUIRE(contribution[1] == Approx(contribution[2]).epsilon(1e-6));
+
+    // Warm start: one more bar needs few sweeps to reach the same accuracy
+    cov.update(std::vector<double>{0.001, -0.002, 0.0005});
+    auto warm = cov.risk_parity_weights(3);
+    std::vector<double> warm_copy(warm.begin(), warm.end());
+    auto full = cov.risk_parity_weights(200);
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(warm_copy[i] == Approx(full[i]).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("Risk parity reduces to inverse volatility without correlation", "[risk]") {
+    ctrade::EwmaCovariance cov(2, 0.5);
+    cov.update(std::vector<double>{0.02, 0.0});
+    cov.update(std::vector<double>{0.0, 0.01});
+
+    auto w = cov.risk_parity_weights();
+    double inv0 = 1.0 / std::sqrt(cov.covariance(0, 0));
+    double inv1 = 1.0 / std::sqrt(cov.covariance(1, 1));
+    REQUIRE(w[0] == Approx(inv0 / (inv0 + inv1)));
+}
+
+TEST_CASE("Slices feed log returns", "[risk]") {
+    ctrade::EwmaCovariance cov(2, 0.5);
+    std::vector<double> none(2, 0.0);
+
+    std::vector<double> first{100.0, 0.0};
+    cov.update(ctrade::AssetSlice{0, none, none, none, first, none, none});
+    REQUIRE(cov.observations() == 0);
+
+    std::vector<double> second{110.0, 50.0};
+    cov.update(ctrade::AssetSlice{60, none, none, none, second, none, none});
+    REQUIRE(cov.observations() == 1);
+    double r = std::log(1.1);
+    REQUIRE(cov.covariance(0, 0) == Approx(r * r));
+    REQUIRE(cov.covariance(1, 1) == 0.0);
+}
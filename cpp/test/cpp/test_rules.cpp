@@ -0,0 +1,213 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/rng.hpp"
+#include "ctrade/rules.hpp"
+#include "fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Records every target weight vector sent
+class MockExecutionContext : public ctrade::ExecutionContext {
+public:
+    int64_t market_buy(double) override { return 0; }
+    int64_t market_sell(double) override { return 0; }
+    int64_t limit_buy(double, double) override { return 0; }
+    int64_t limit_sell(double, double) override { return 0; }
+    int64_t stop_buy(double, double) override { return 0; }
+    int64_t stop_sell(double, double) override { return 0; }
+    int64_t stop_limit_buy(double, double, double) override { return 0; }
+    int64_t stop_limit_sell(double, double, double) override { return 0; }
+    void close_position() override {}
+    void close_long() override {}
+    void close_short() override {}
+    void close_amount(double) override {}
+    void set_target_weights(std::span<const double> weights) override {
+        sent.emplace_back(weights.begin(), weights.end());
+    }
+    void set_target_positions(std::span<const double>) override {}
+    void cancel_order(int64_t) override {}
+    void cancel_all() override {}
+    void amend_order(int64_t, double, double) override {}
+    int64_t submit_parent_order(const ctrade::ParentOrder&) override { return 0; }
+    void cancel_parent_order(int64_t) override {}
+    int64_t schedule_timer(int64_t) override { return 0; }
+    void set_leverage(int) override {}
+    void set_cross_mode() override {}
+    void set_isolated_mode() override {}
+
+    std::vector<std::vector<double>> sent;
+};
+
+static std::vector<double> ema(const std::vector<double>& x, double n) {
+    std::vector<double> out(x.size());
+    const double alpha = 2.0 / (n + 1.0);
+    double v = x[0];
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (i > 0) {
+            v += alpha * (x[i] - v);
+        }
+        out[i] = v;
+    }
+    return out;
+}
+
+static const std::string kCrossover = R"(
+# EMA crossover, long only while funding is cheap
+cross(ema(close, 12), ema(close, 26)) & (funding < 0.0001) -> target(1.0)
+cross_under(ema(close, 12), ema(close, 26)) -> target(0)
+)";
+
+TEST_CASE("Crossover rules match a hand-written loop", "[rules]") {
+    auto bars = random_bars(5000, 0);
+    auto program = ctrade::compile_rules(kCrossover);
+    REQUIRE(program.rules().size() == 2);
+    // The second rule reuses both emas of the first
+    size_t emas = 0;
+    for (const auto& node : program.nodes()) {
+        emas += node.op == ctrade::RuleOp::Ema;
+    }
+    REQUIRE(emas == 2);
+
+    auto targets = ctrade::evaluate_rules(program, bars);
+
+    std::vector<double> close(bars.close().begin(), bars.close().end());
+    auto fast = ema(close, 12);
+    auto slow = ema(close, 26);
+    double target = 0.0;
+    size_t changes = 0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (i > 0 && fast[i] > slow[i] && fast[i - 1] <= slow[i - 1] &&
+            bars.funding_rate()[i] < 0.0001) {
+            target = 1.0;
+        } else if (i > 0 && fast[i] < slow[i] && fast[i - 1] >= slow[i - 1]) {
+            target = 0.0;
+        }
+        changes += i > 0 && target != targets[i - 1];
+        REQUIRE(targets[i] == target);
+    }
+    REQUIRE(changes > 4);
+}
+
+TEST_CASE("Streaming, batched and parallel evaluation agree", "[rules]") {
+    auto a = random_bars(3000, 0);
+    auto b = random_bars(2500, 1);
+    auto program = ctrade::compile_rules(
+        "close > highest(lag(high, 1), 20) -> target(min(1, 0.5 + abs(funding) * 1000))\n"
+        "close < lowest(lag(low, 1), 20) | close < sma(close, 50) * 0.995 -> target(-0.5)\n"
+        "!(volume > 1) -> target(0)");
+
+    auto batch = ctrade::evaluate_rules(program, a);
+
+    // Bar by bar through the strategy, and in uneven blocks
+    ctrade::RuleStrategy strategy(program, 1);
+    strategy.init();
+    MockExecutionContext ctx;
+    ctrade::RuleEvaluator blocks(program);
+    std::vector<double> split(a.size());
+    blocks.run(a, 0, 7, split);
+    blocks.run(a, 7, 2000, std::span<double>(split).subspan(7));
+    blocks.run(a, 2000, a.size(), std::span<double>(split).subspan(2000));
+    for (size_t i = 0; i < a.size(); ++i) {
+        strategy.on_bar(a.at(i), ctx);
+        REQUIRE(strategy.weights()[0] == batch[i]);
+        REQUIRE(split[i] == batch[i]);
+    }
+    REQUIRE(!ctx.sent.empty());
+    REQUIRE(blocks.target() == batch.back());
+
+    // Small buffers only change how many passes a run takes
+    ctrade::RuleEvaluator narrow(program, 5);
+    std::vector<double> narrow_targets(a.size());
+    narrow.run(a, 0, a.size(), narrow_targets);
+    REQUIRE(narrow_targets == batch);
+    REQUIRE_THROWS_AS(ctrade::RuleEvaluator(program, 0), std::invalid_argument);
+
+    std::vector<const ctrade::BarStore*> stores{&a, &b};
+    auto both = ctrade::evaluate_rules(program, stores, 2);
+    REQUIRE(both[0] == batch);
+    REQUIRE(both[1] == ctrade::evaluate_rules(program, b));
+}
+
+TEST_CASE("The strategy trades every asset of its universe", "[rules]") {
+    auto a = random_bars(2000, 0);
+    auto b = random_bars(2000, 1);
+    auto program = ctrade::compile_rules(kCrossover);
+    auto want_a = ctrade::evaluate_rules(program, a);
+    auto want_b = ctrade::evaluate_rules(program, b);
+
+    // Asset 2 never trades, yet every update spans all three assets
+    ctrade::RuleStrategy strategy(program, 3);
+    strategy.init();
+    MockExecutionContext ctx;
+    for (size_t i = 0; i < a.size(); ++i) {
+        strategy.on_bar(a.at(i), ctx);
+        strategy.on_bar(b.at(i), ctx);
+        REQUIRE(strategy.weights()[0] == want_a[i]);
+        REQUIRE(strategy.weights()[1] == want_b[i]);
+    }
+    REQUIRE(!ctx.sent.empty());
+    for (const auto& weights : ctx.sent) {
+        REQUIRE(weights.size() == 3);
+        REQUIRE(weights[2] == 0.0);
+    }
+
+    auto outside = a.at(0);
+    outside.asset_id = -1;
+    REQUIRE_THROWS_AS(strategy.on_bar(outside, ctx), std::out_of_range);
+    outside.asset_id = 3;
+    REQUIRE_THROWS_AS(strategy.on_bar(outside, ctx), std::out_of_range);
+    REQUIRE_THROWS_AS(ctrade::RuleStrategy(program, 0), std::invalid_argument);
+}
+
+TEST_CASE("Windows, warmup and operators", "[rules]") {
+    ctrade::BarStore bars(0);
+    const double closes[] = {1, 3, 2, 5, 4, 6};
+    for (size_t i = 0; i < 6; ++i) {
+        ctrade::MarketState bar{};
+        bar.timestamp = static_cast<int64_t>(i);
+        bar.close = closes[i];
+        bars.append(bar);
+    }
+    auto eval = [&](const std::string& expr) {
+        return ctrade::evaluate_rules(ctrade::compile_rules("1 -> target(" + expr + ")"), bars);
+    };
+    auto is = [](const std::vector<double>& got, std::vector<double> want) {
+        return got == want;
+    };
+
+    // Warmup bars give NaN targets, which keep the previous target of 0
+    REQUIRE(is(eval("sma(close, 3)"), {0, 0, 2, 10.0 / 3, 11.0 / 3, 5}));
+    REQUIRE(is(eval("lag(close, 2)"), {0, 0, 1, 3, 2, 5}));
+    REQUIRE(is(eval("highest(close, 3)"), {0, 0, 3, 5, 5, 6}));
+    REQUIRE(is(eval("lowest(close, 2)"), {0, 1, 2, 2, 4, 4}));
+    REQUIRE(is(eval("1 + 2 * 3 - -close"), {8, 10, 9, 12, 11, 13}));
+    REQUIRE(is(eval("(close > 2) & !(close == 5) | close / 2 == 0.5"), {1, 1, 0, 0, 1, 1}));
+    REQUIRE(is(eval("max(close, 3) - min(close, 3)"), {2, 0, 1, 2, 1, 3}));
+
+    // A later rule only fires when the earlier ones do not
+    auto first = ctrade::evaluate_rules(
+        ctrade::compile_rules("close >= 5 -> target(2); close >= 3 -> target(1)"), bars);
+    REQUIRE(is(first, {0, 1, 1, 2, 1, 2}));
+}
+
+TEST_CASE("Malformed rules are rejected", "[rules]") {
+    REQUIRE_THROWS(ctrade::compile_rules(""));
+    REQUIRE_THROWS(ctrade::compile_rules("# only a comment\n"));
+    REQUIRE_THROWS(ctrade::compile_rules("close > 1"));
+    REQUIRE_THROWS(ctrade::compile_rules("close > 1 -> buy(1)"));
+    REQUIRE_THROWS(ctrade::compile_rules("price > 1 -> target(1)"));
+    REQUIRE_THROWS(ctrade::compile_rules("sma(close, 2.5) > 1 -> target(1)"));
+    REQUIRE_THROWS(ctrade::compile_rules("sma(close, 0) > 1 -> target(1)"));
+    REQUIRE_THROWS(ctrade::compile_rules("ema(close) > 1 -> target(1)"));
+    REQUIRE_THROWS(ctrade::compile_rules("close > 1 -> target(1) close"));
+    REQUIRE_THROWS(ctrade::compile_rules("close $ 1 -> target(1)"));
+    std::string message;
+    try {
+        ctrade::compile_rules("close > 1 -> target(1)\nclose > (2 -> target(0)");
+    } catch (const std::invalid_argument& e) {
+        message = e.what();
+    }
+    REQUIRE(message.find("line 2") != std::string::npos);
+}
@@ -0,0 +1,200 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/bar_store.hpp"
+#include "ctrade/risk.hpp"
+#include "ctrade/snapshot.hpp"
+#include "fixtures.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Volatility-scaled trend follower over one asset: long when the close is
+// above its EWMA, sized by the EWMA volatility. State spans every bar.
+class TrendRun : public ctrade::ResumableBacktest {
+public:
+    explicit TrendRun(const ctrade::BarStore& bars) : bars_(bars), risk_(1, 0.94) {}
+
+    void run(int64_t begin_ts, int64_t end_ts, ctrade::BacktestResult& result) override {
+        const size_t end = bars_.lower_bound(end_ts);
+        for (size_t i = bars_.lower_bound(begin_ts); i < end; ++i) {
+            const double close = bars_.close()[i];
+            if (last_close_ > 0.0) {
+                cash_ += position_ * (close - last_close_);
+                const double r = std::log(close / last_close_);
+                risk_.update(std::span<const double>(&r, 1));
+            }
+            average_ = average_ == 0.0 ? close : 0.9 * average_ + 0.1 * close;
+            const double w = 1.0;
+            const double vol = risk_.volatility(std::span<const double>(&w, 1));
+            position_ = close > average_ && vol > 0.0 ? 0.001 / vol : 0.0;
+            last_close_ = close;
+            ++bars_simulated;
+
+            result.timestamps.push_back(bars_.timestamps()[i]);
+            result.equity.push_back(cash_);
+        }
+    }
+
+    void reset() override {
+        risk_ = ctrade::EwmaCovariance(1, 0.94);
+        cash_ = 10000.0;
+        position_ = last_close_ = average_ = 0.0;
+    }
+
+    void save(ctrade::SnapshotWriter& out) const override {
+        out.f64(cash_);
+        out.f64(position_);
+        out.f64(last_close_);
+        out.f64(average_);
+        risk_.save(out);
+    }
+
+    void load(ctrade::SnapshotReader& in) override {
+        if (reject_state) {
+            cash_ = in.f64();
+            throw std::runtime_error("TrendRun: unknown state format");
+        }
+        cash_ = in.f64();
+        position_ = in.f64();
+        last_close_ = in.f64();
+        average_ = in.f64();
+        risk_.load(in);
+    }
+
+    size_t bars_simulated = 0;
+    bool reject_state = false;
+
+private:
+    const ctrade::BarStore& bars_;
+    ctrade::EwmaCovariance risk_;
+    double cash_ = 10000.0;
+    double position_ = 0.0;
+    double last_close_ = 0.0;
+    double average_ = 0.0;
+};
+
+static ctrade::BarStore sine_bars(size_t n) {
+    ctrade::BarStore store(0);
+    for (size_t i = 0; i < n; ++i) {
+        ctrade::MarketState bar{};
+        bar.timestamp = static_cast<int64_t>(i) * 60;
+        bar.close = 100.0 + 10.0 * std::sin(0.05 * static_cast<double>(i)) + 0.01 * static_cast<double>(i % 7);
+        bar.open = bar.high = bar.low = bar.close;
+        store.append(bar);
+    }
+    return store;
+}
+
+TEST_CASE("Snapshot streams round-trip and reject truncation", "[snapshot]") {
+    ctrade::SnapshotWriter out;
+    out.i64(-5);
+    out.f64(0.25);
+    out.str("btc");
+    out.f64s(std::vector<double>{1.0, 2.0});
+
+    ctrade::SnapshotReader in(out.bytes());
+    REQUIRE(in.i64() == -5);
+    REQUIRE(in.f64() == 0.25);
+    REQUIRE(in.str() == "btc");
+    REQUIRE(in.f64s() == std::vector<double>{1.0, 2.0});
+    REQUIRE(in.done());
+
+    std::vector<uint8_t> cut(out.bytes().begin(), out.bytes().end() - 3);
+    ctrade::SnapshotReader short_in(cut);
+    short_in.i64();
+    short_in.f64();
+    short_in.str();
+    REQUIRE_THROWS(short_in.f64s());
+}
+
+TEST_CASE("Extending a snapshot matches a full rerun", "[snapshot][determinism]") {
+    auto bars = sine_bars(1000);
+    ctrade::SnapshotKey key{"trend", {0.9}, "v1"};
+    ctrade::SnapshotStore store(store_dir("extend"));
+
+    TrendRun full(bars);
+    ctrade::BacktestResult expected;
+    full.run(0, 60000, expected);
+
+    TrendRun first(bars);
+    auto partial = store.extend(key, first, 0, 36000);
+    REQUIRE(partial.timestamps.size() == 600);
+    REQUIRE(store.end_ts(key) == 36000);
+
+    // A fresh process only simulates the new bars
+    TrendRun next(bars);
+    auto extended = store.extend(key, next, 0, 60000);
+    REQUIRE(next.bars_simulated == 400);
+    REQUIRE(ctrade::hash_result(extended) == ctrade::hash_result(expected));
+
+    // Earlier ranges are served from the snapshot
+    TrendRun reader(bars);
+    auto earlier = store.extend(key, reader, 0, 30000);
+    REQUIRE(reader.bars_simulated == 0);
+    REQUIRE(earlier.timestamps.size() == 500);
+    REQUIRE(earlier.equity[499] == expected.equity[499]);
+}
+
+TEST_CASE("Snapshots are keyed and validated", "[snapshot]") {
+    auto bars = sine_bars(200);
+    const auto dir = store_dir("keys");
+    ctrade::SnapshotStore store(dir);
+    ctrade::SnapshotKey key{"trend", {0.9}, "v1"};
+
+    TrendRun first(bars);
+    store.extend(key, first, 0, 6000);
+
+    // New data version, new parameters or a new start all start over
+    for (auto other : {ctrade::SnapshotKey{"trend", {0.9}, "v2"},
+                       ctrade::SnapshotKey{"trend", {0.8}, "v1"}}) {
+        TrendRun run(bars);
+        store.extend(other, run, 0, 12000);
+        REQUIRE(run.bars_simulated == 200);
+    }
+    TrendRun shifted(bars);
+    store.extend(key, shifted, 600, 12000);
+    REQUIRE(shifted.bars_simulated == 190);
+
+    // A damaged file is ignored
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::app) << "junk";
+    }
+    REQUIRE(store.end_ts(key) == std::numeric_limits<int64_t>::min());
+    TrendRun rerun(bars);
+    store.extend(key, rerun, 0, 12000);
+    REQUIRE(rerun.bars_simulated == 200);
+
+    store.erase(key);
+    REQUIRE(store.end_ts(key) == std::numeric_limits<int64_t>::min());
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Runs from the start reset the backtest", "[snapshot]") {
+    auto bars = sine_bars(300);
+    const auto dir = store_dir("reset");
+    ctrade::SnapshotStore store(dir);
+    ctrade::SnapshotKey key{"trend", {0.9}, "v1"};
+
+    TrendRun fresh(bars);
+    ctrade::BacktestResult expected;
+    fresh.run(0, 18000, expected);
+
+    // A backtest reused after another run starts clean
+    TrendRun reused(bars);
+    ctrade::BacktestResult scratch;
+    reused.run(0, 9000, scratch);
+    auto first = store.extend(key, reused, 0, 12000);
+    REQUIRE(first.equity == std::vector<double>(expected.equity.begin(), expected.equity.begin() + 200));
+
+    // A state that fails to load is rerun from the start
+    TrendRun changed(bars);
+    changed.reject_state = true;
+    auto rerun = store.extend(key, changed, 0, 18000);
+    REQUIRE(changed.bars_simulated == 300);
+    REQUIRE(ctrade::hash_result(rerun) == ctrade::hash_result(expected));
+    std::filesystem::remove_all(dir);
+}
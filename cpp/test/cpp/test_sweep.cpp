@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/parallel.hpp"
+#include "ctrade/rng.hpp"
+#include "ctrade/sweep.hpp"
+#include "fixtures.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+TEST_CASE("CounterRng matches the Philox4x32-10 reference", "[determinism]") {
+    ctrade::CounterRng rng(0, 0);
+
+    REQUIRE(rng.next_u32() == 0x6627e8d5u);
+    REQUIRE(rng.next_u32() == 0xe169c58du);
+    REQUIRE(rng.next_u32() == 0xbc57ac4cu);
+    REQUIRE(rng.next_u32() == 0x9b00dbd8u);
+}
+
+TEST_CASE("CounterRng streams are independent of each other", "[determinism]") {
+    ctrade::CounterRng a(42, 0);
+    ctrade::CounterRng b(42, 1);
+    ctrade::CounterRng a2(42, 0);
+
+    REQUIRE(a.next_u64() != b.next_u64());
+    a2.next_u64();
+    REQUIRE(a.next_u64() == a2.next_u64());
+
+    double u = a.uniform();
+    REQUIRE(u >= 0.0);
+    REQUIRE(u < 1.0);
+}
+
+TEST_CASE("parallel_for visits every index once", "[determinism]") {
+    std::vector<std::atomic<int>> visits(1000);
+    ctrade::parallel_for(visits.size(), 4, [&](size_t i, unsigned) { visits[i]++; });
+
+    for (const auto& v : visits) {
+        REQUIRE(v == 1);
+    }
+}
+
+TEST_CASE("parallel_for rethrows worker exceptions", "[determinism]") {
+    REQUIRE_THROWS_AS(
+        ctrade::parallel_for(100, 4, [](size_t i, unsigned) {
+            if (i == 37) throw std::runtime_error("run failed");
+        }),
+        std::runtime_error);
+}
+
+TEST_CASE("summarize computes return and drawdown", "[determinism]") {
+    ctrade::BacktestResult result;
+    result.equity = {100.0, 120.0, 90.0, 110.0};
+
+    auto s = ctrade::summarize(result);
+    REQUIRE(s.n_bars == 4);
+    REQUIRE(s.final_equity == Approx(110.0));
+    REQUIRE(s.total_return == Approx(0.1));
+    REQUIRE(s.max_drawdown == Approx(0.25));
+}
+
+TEST_CASE("Deterministic sweeps are bit-identical across thread counts", "[determinism]") {
+    auto params = drift_grid();
+
+    ctrade::SweepConfig config;
+    config.seed = 7;
+    config.deterministic = true;
+
+    config.threads = 1;
+    auto serial = ctrade::run_sweep(params, random_walk, config);
+    config.threads = 8;
+    auto parallel = ctrade::run_sweep(params, random_walk, config);
+
+    REQUIRE(serial.runs.size() == params.size());
+    REQUIRE(ctrade::hash_summaries(serial.runs) == ctrade::hash_summaries(parallel.runs));
+    REQUIRE(serial.stats.mean_sharpe == parallel.stats.mean_sharpe);
+    REQUIRE(serial.stats.best_index == parallel.stats.best_index);
+
+    // Highest drift should produce the best Sharpe
+    REQUIRE(serial.stats.best_index > 30);
+}
+
+TEST_CASE("hash_result changes with any value", "[determinism]") {
+    ctrade::BacktestResult a;
+    a.equity = {1.0, 2.0};
+    ctrade::BacktestResult b = a;
+
+    REQUIRE(ctrade::hash_result(a) == ctrade::hash_result(b));
+    b.equity[1] = 2.0000000000000004;
+    REQUIRE(ctrade::hash_result(a) != ctrade::hash_result(b));
+}
@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/sweep.hpp"
+#include "ctrade/sweep_cluster.hpp"
+#include "fixtures.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static std::string socket_path(const char* name) {
+    return "unix:/tmp/ctrade-test-" + std::to_string(::getpid()) + "-" + name + ".sock";
+}
+
+// Forks a worker process running `run`; the child never returns. With a
+// gate, the child waits for a byte on that pipe before connecting.
+static pid_t spawn_worker(const std::string& endpoint, const ctrade::RunFn& run, int gate = -1) {
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        char go;
+        if (gate >= 0 && ::read(gate, &go, 1) != 1) {
+            ::_exit(4);
+        }
+        try {
+            ctrade::run_sweep_worker(endpoint, run, 2);
+        } catch (...) {
+            ::_exit(2);
+        }
+        ::_exit(0);
+    }
+    return pid;
+}
+
+static uint64_t local_hash(uint64_t seed) {
+    ctrade::SweepConfig config;
+    config.threads = 1;
+    config.seed = seed;
+    return ctrade::hash_summaries(ctrade::run_sweep(drift_grid(), random_walk, config).runs);
+}
+
+TEST_CASE("Worker processes reproduce a local sweep", "[cluster][determinism]") {
+    ctrade::SweepCoordinator coordinator(socket_path("local"));
+
+    std::vector<pid_t> workers;
+    for (int w = 0; w < 3; ++w) {
+        workers.push_back(spawn_worker(coordinator.endpoint(), random_walk));
+    }
+    auto result = coordinator.run(drift_grid(), 42);
+    for (pid_t pid : workers) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+    }
+
+    REQUIRE(result.runs.size() == 40);
+    REQUIRE(result.stats.n_runs == 40);
+    REQUIRE(ctrade::hash_summaries(result.runs) == local_hash(42));
+}
+
+TEST_CASE("Jobs of a dead worker are retried elsewhere", "[cluster]") {
+    ctrade::SweepCoordinator coordinator(socket_path("retry"));
+
+    // This worker dies on the first job it is handed
+    auto crash = [](const ctrade::ParamSet&, ctrade::CounterRng&) -> ctrade::BacktestResult {
+        ::_exit(3);
+    };
+    const pid_t doomed = spawn_worker(coordinator.endpoint(), crash);
+
+    // The healthy worker joins only once the doomed one has died
+    int gate[2];
+    REQUIRE(::pipe(gate) == 0);
+    const pid_t healthy = spawn_worker(coordinator.endpoint(), random_walk, gate[0]);
+    int status = 0;
+    std::thread reaper([&] {
+        ::waitpid(doomed, &status, 0);
+        const char go = 1;
+        (void)!::write(gate[1], &go, 1);
+    });
+
+    auto result = coordinator.run(drift_grid(), 7);
+    reaper.join();
+    int healthy_status = 0;
+    ::waitpid(healthy, &healthy_status, 0);
+    ::close(gate[0]);
+    ::close(gate[1]);
+
+    REQUIRE(WEXITSTATUS(status) == 3);
+    REQUIRE(WEXITSTATUS(healthy_status) == 0);
+    REQUIRE(ctrade::hash_summaries(result.runs) == local_hash(7));
+}
+
+TEST_CASE("Coordinator serves workers over TCP", "[cluster]") {
+    ctrade::SweepCoordinator coordinator("tcp:127.0.0.1:0");
+    REQUIRE(coordinator.endpoint() != "tcp:127.0.0.1:0");
+
+    std::thread worker([&] { ctrade::run_sweep_worker(coordinator.endpoint(), random_walk, 2); });
+    auto result = coordinator.run(drift_grid(), 42);
+    worker.join();
+
+    REQUIRE(ctrade::hash_summaries(result.runs) == local_hash(42));
+}
+
+TEST_CASE("Coordinator skips jobs already in the journal", "[cluster][journal]") {
+    const std::string path = "/tmp/ctrade-test-" + std::to_string(::getpid()) + ".journal";
+    std::remove(path.c_str());
+    ctrade::SweepJournal journal(path, "drift");
+
+    ctrade::SweepConfig config;
+    config.seed = 42;
+    ctrade::run_sweep(drift_grid(), random_walk, config, journal);
+
+    // Nothing left to hand out, so no worker is needed
+    ctrade::SweepCoordinator coordinator(socket_path("journal"));
+    auto result = coordinator.run(drift_grid(), 42, &journal);
+    REQUIRE(ctrade::hash_summaries(result.runs) == local_hash(42));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Failing runs and idle sweeps surface as errors", "[cluster]") {
+    ctrade::ClusterConfig config;
+    config.idle_timeout_ms = 200;
+
+    {
+        ctrade::SweepCoordinator coordinator(socket_path("idle"), config);
+        REQUIRE_THROWS(coordinator.run(drift_grid(), 1));
+    }
+
+    ctrade::SweepCoordinator coordinator(socket_path("fail"), config);
+    auto failing = [](const ctrade::ParamSet&, ctrade::CounterRng&) -> ctrade::BacktestResult {
+        throw std::runtime_error("bad data");
+    };
+    std::thread worker([&] { ctrade::run_sweep_worker(coordinator.endpoint(), failing); });
+    REQUIRE_THROWS(coordinator.run(drift_grid(), 1));
+    worker.join();
+
+    REQUIRE_THROWS(ctrade::SweepCoordinator("localhost:9000"));
+}
+
+TEST_CASE("Misbehaving workers are dropped and their jobs requeued", "[cluster]") {
+    const std::string endpoint = socket_path("garbage");
+    ctrade::SweepCoordinator coordinator(endpoint);
+
+    // A peer that sends an impossible frame length before any real worker
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    const std::string path = endpoint.substr(5);
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+    REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    const unsigned char garbage[5] = {0xff, 0xff, 0xff, 0xff, 0};
+    REQUIRE(::write(fd, garbage, sizeof(garbage)) == sizeof(garbage));
+
+    // A worker whose run fails is dropped; a healthy one connects after it
+    // has gone and picks up the failed job
+    auto failing = [](const ctrade::ParamSet&, ctrade::CounterRng&) -> ctrade::BacktestResult {
+        throw std::runtime_error("bad data");
+    };
+    std::thread workers([&] {
+        ctrade::run_sweep_worker(coordinator.endpoint(), failing, 1);
+        ctrade::run_sweep_worker(coordinator.endpoint(), random_walk, 1);
+    });
+    auto result = coordinator.run(drift_grid(), 42);
+    workers.join();
+    ::close(fd);
+
+    REQUIRE(ctrade::hash_summaries(result.runs) == local_hash(42));
+}
+
+TEST_CASE("Coordinator never unlinks a file that is not a socket", "[cluster]") {
+    const std::string endpoint = socket_path("regular");
+    const std::string path = endpoint.substr(5);
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    REQUIRE(f != nullptr);
+    std::fclose(f);
+
+    REQUIRE_THROWS(ctrade::SweepCoordinator(endpoint));
+    REQUIRE(::access(path.c_str(), F_OK) == 0);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/sweep.hpp"
+#include "ctrade/sweep_journal.hpp"
+#include "fixtures.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::string journal_path(const char* name) {
+    std::string path = "/tmp/ctrade-test-" + std::to_string(::getpid()) + "-" + name + ".journal";
+    std::remove(path.c_str());
+    return path;
+}
+
+TEST_CASE("Run keys cover parameters, seed and index", "[journal]") {
+    const auto key = ctrade::run_key({1.0, 2.0}, 42, 3);
+    REQUIRE(key == ctrade::run_key({1.0, 2.0}, 42, 3));
+    REQUIRE(key != ctrade::run_key({1.0, 2.5}, 42, 3));
+    REQUIRE(key != ctrade::run_key({1.0, 2.0}, 43, 3));
+    REQUIRE(key != ctrade::run_key({1.0, 2.0}, 42, 4));
+    REQUIRE(key != ctrade::run_key({1.0, 2.0, 0.0}, 42, 3));
+}
+
+TEST_CASE("Interrupted sweeps resume where they stopped", "[journal][determinism]") {
+    const auto path = journal_path("resume");
+    ctrade::SweepConfig config;
+    config.threads = 4;
+    config.seed = 42;
+    const auto expected = ctrade::hash_summaries(ctrade::run_sweep(drift_grid(), random_walk, config).runs);
+
+    // First attempt is preempted partway through
+    {
+        ctrade::SweepJournal journal(path, "drift-v1");
+        auto preempted = [](const ctrade::ParamSet& p, ctrade::CounterRng& rng) {
+            if (p[0] > 0.0) {
+                throw std::runtime_error("preempted");
+            }
+            return random_walk(p, rng);
+        };
+        REQUIRE_THROWS(ctrade::run_sweep(drift_grid(), preempted, config, journal));
+        REQUIRE(journal.size() == 21);
+    }
+
+    std::atomic<int> calls{0};
+    auto counted = [&](const ctrade::ParamSet& p, ctrade::CounterRng& rng) {
+        calls++;
+        return random_walk(p, rng);
+    };
+
+    ctrade::SweepJournal journal(path, "drift-v1");
+    REQUIRE(journal.size() == 21);
+    auto resumed = ctrade::run_sweep(drift_grid(), counted, config, journal);
+    REQUIRE(calls == 19);
+    REQUIRE(ctrade::hash_summaries(resumed.runs) == expected);
+    REQUIRE(resumed.stats.n_runs == 40);
+
+    // A finished sweep costs nothing to repeat; a new seed starts over
+    calls = 0;
+    ctrade::run_sweep(drift_grid(), counted, config, journal);
+    REQUIRE(calls == 0);
+    config.seed = 43;
+    ctrade::run_sweep(drift_grid(), counted, config, journal);
+    REQUIRE(calls == 40);
+
+    config.deterministic = false;
+    REQUIRE_THROWS(ctrade::run_sweep(drift_grid(), counted, config, journal));
+}
+
+TEST_CASE("A journal only serves its own sweep", "[journal]") {
+    const auto path = journal_path("identity");
+    ctrade::RunSummary summary{10100.0, 0.01, 0.02, 0.5, 300};
+    {
+        ctrade::SweepJournal journal(path, "drift-v1");
+        journal.append(1, summary);
+    }
+
+    // Same keys, different strategy or data: refuse instead of reusing
+    REQUIRE_THROWS_AS(ctrade::SweepJournal(path, "drift-v2"), std::invalid_argument);
+    ctrade::SweepJournal journal(path, "drift-v1");
+    REQUIRE(journal.size() == 1);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("A torn tail is dropped on open", "[journal]") {
+    const auto path = journal_path("torn");
+    ctrade::RunSummary summary{10100.0, 0.01, 0.02, 0.5, 300};
+    {
+        ctrade::SweepJournal journal(path, "drift-v1");
+        journal.append(1, summary);
+        journal.append(2, summary);
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write("partial record", 14);
+    }
+
+    {
+        ctrade::SweepJournal journal(path, "drift-v1");
+        REQUIRE(journal.size() == 2);
+        REQUIRE(journal.find(2)->sharpe == 0.5);
+        REQUIRE_FALSE(journal.find(3));
+        journal.append(3, summary);
+    }
+    ctrade::SweepJournal journal(path, "drift-v1");
+    REQUIRE(journal.size() == 3);
+
+    const auto other = journal_path("other");
+    {
+        std::ofstream out(other, std::ios::binary);
+        out << "not a journal";
+    }
+    REQUIRE_THROWS(ctrade::SweepJournal(other, "drift-v1"));
+    std::remove(other.c_str());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ctrade/bar_store.hpp"
+#include "ctrade/sweep.hpp"
+#include "ctrade/time_parallel.hpp"
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+constexpr int64_t kDay = 86400;
+
+static ctrade::BarStore minute_bars(size_t n) {
+    ctrade::BarStore store(0);
+    for (size_t i = 0; i < n; ++i) {
+        ctrade::MarketState bar{};
+        bar.timestamp = static_cast<int64_t>(i) * 60;
+        bar.close = 100.0 + 5.0 * std::sin(0.013 * static_cast<double>(i)) + 0.02 * static_cast<double>(i % 11);
+        bar.open = bar.high = bar.low = bar.close;
+        store.append(bar);
+    }
+    return store;
+}
+
+// Intraday momentum: long above the day's open, short below, flat on the
+// last bar of each day.
+class DayTrader : public ctrade::ResumableBacktest {
+public:
+    explicit DayTrader(const ctrade::BarStore& bars, std::atomic<size_t>& simulated)
+        : bars_(bars), simulated_(simulated) {}
+
+    void run(int64_t begin_ts, int64_t end_ts, ctrade::BacktestResult& result) override {
+        const size_t end = bars_.lower_bound(end_ts);
+        for (size_t i = bars_.lower_bound(begin_ts); i < end; ++i) {
+            const int64_t ts = bars_.timestamps()[i];
+            const double close = bars_.close()[i];
+            if (day_open_ == 0.0) {
+                day_open_ = close;
+            }
+            const double pnl = position_ * (close - last_close_);
+            if (ts % kDay == kDay - 60) {
+                position_ = 0.0;
+                day_open_ = 0.0;
+            } else {
+                position_ = close > day_open_ ? 1.0 : -1.0;
+            }
+            last_close_ = close;
+            ++simulated_;
+
+            result.timestamps.push_back(ts);
+            result.pnl.push_back(pnl);
+        }
+    }
+
+    void reset() override { position_ = day_open_ = last_close_ = 0.0; }
+
+    void save(ctrade::SnapshotWriter& out) const override {
+        out.f64(position_);
+        out.f64(day_open_);
+        out.f64(position_ != 0.0 ? last_close_ : 0.0);
+    }
+
+    void load(ctrade::SnapshotReader& in) override {
+        position_ = in.f64();
+        day_open_ = in.f64();
+        last_close_ = in.f64();
+    }
+
+private:
+    const ctrade::BarStore& bars_;
+    std::atomic<size_t>& simulated_;
+    double position_ = 0.0;
+    double day_open_ = 0.0;
+    double last_close_ = 0.0;
+};
+
+// Follows an EWMA of the close: state from the first bar never washes out
+// exactly, so speculation always fails.
+class EwmaFollower : public ctrade::ResumableBacktest {
+public:
+    explicit EwmaFollower(const ctrade::BarStore& bars) : bars_(bars) {}
+
+    void run(int64_t begin_ts, int64_t end_ts, ctrade::BacktestResult& result) override {
+        const size_t end = bars_.lower_bound(end_ts);
+        for (size_t i = bars_.lower_bound(begin_ts); i < end; ++i) {
+            const double close = bars_.close()[i];
+            const double pnl = last_close_ > 0.0 ? position_ * (close - last_close_) : 0.0;
+            average_ = average_ == 0.0 ? close : 0.99 * average_ + 0.01 * close;
+            position_ = close > average_ ? 1.0 : 0.0;
+            last_close_ = close;
+            result.timestamps.push_back(bars_.timestamps()[i]);
+            result.pnl.push_back(pnl);
+        }
+    }
+
+    void reset() override { position_ = average_ = last_close_ = 0.0; }
+
+    void save(ctrade::SnapshotWriter& out) const override {
+        out.f64(position_);
+        out.f64(average_);
+        out.f64(last_close_);
+    }
+
+    void load(ctrade::SnapshotReader& in) override {
+        position_ = in.f64();
+        average_ = in.f64();
+        last_close_ = in.f64();
+    }
+
+private:
+    const ctrade::BarStore& bars_;
+    double position_ = 0.0;
+    double average_ = 0.0;
+    double last_close_ = 0.0;
+};
+
+TEST_CASE("Flat-at-boundary strategies split without reruns", "[time_parallel][determinism]") {
+    auto bars = minute_bars(8 * 1440);
+    std::atomic<size_t> simulated{0};
+    ctrade::BacktestFactory make = [&] { return std::make_unique<DayTrader>(bars, simulated); };
+
+    ctrade::TimeParallelConfig serial;
+    serial.segments = 1;
+    const auto expected = ctrade::run_time_parallel(make, 0, 8 * kDay, serial);
+    REQUIRE(expected.result.timestamps.size() == 8 * 1440);
+    double equity = 10000.0;
+    for (double pnl : expected.result.pnl) {
+        equity += pnl;
+    }
+    REQUIRE(expected.result.equity.back() == equity);
+
+    ctrade::TimeParallelConfig config;
+    config.threads = 4;
+    config.segments = 8;
+    config.align = kDay;
+    config.warmup = 60;
+    simulated = 0;
+    const auto split = ctrade::run_time_parallel(make, 0, 8 * kDay, config);
+    REQUIRE(split.boundaries.size() == 9);
+    REQUIRE(split.boundaries[1] == kDay);
+    REQUIRE(split.reruns == 0);
+    REQUIRE(simulated == 8 * 1440 + 7);
+    REQUIRE(ctrade::hash_result(split.result) == ctrade::hash_result(expected.result));
+}
+
+TEST_CASE("Mismatched segments are rerun from the true state", "[time_parallel][determinism]") {
+    auto bars = minute_bars(5000);
+    ctrade::BacktestFactory make = [&] { return std::make_unique<EwmaFollower>(bars); };
+
+    ctrade::TimeParallelConfig serial;
+    serial.segments = 1;
+    const auto expected = ctrade::run_time_parallel(make, 0, 300000, serial);
+
+    ctrade::TimeParallelConfig config;
+    config.threads = 3;
+    config.segments = 6;
+    const auto split = ctrade::run_time_parallel(make, 0, 300000, config);
+    REQUIRE(split.boundaries.size() == 7);
+    REQUIRE(split.reruns == 5);
+    REQUIRE(ctrade::hash_result(split.result) == ctrade::hash_result(expected.result));
+}
+
+TEST_CASE("Boundaries respect alignment and ranges are validated", "[time_parallel]") {
+    auto bars = minute_bars(100);
+    ctrade::BacktestFactory make = [&] { return std::make_unique<EwmaFollower>(bars); };
+
+    ctrade::TimeParallelConfig config;
+    config.segments = 10;
+    config.align = 1200;
+    const auto split = ctrade::run_time_parallel(make, 0, 6000, config);
+    REQUIRE(split.boundaries == std::vector<int64_t>{0, 1200, 2400, 3600, 4800, 6000});
+    REQUIRE(split.result.timestamps.size() == 100);
+
+    // Empty range
+    REQUIRE(ctrade::run_time_parallel(make, 600, 600, config).result.timestamps.empty());
+
+    REQUIRE_THROWS(ctrade::run_time_parallel(make, 600, 0, config));
+    config.align = 0;
+    REQUIRE_THROWS(ctrade::run_time_parallel(make, 0, 6000, config));
+}
@@ -0,0 +1,171 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/rng.hpp"
+#include "ctrade/tree_model.hpp"
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using Catch::Approx;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+static const std::string kLightGbmModel = R"(tree
+version=v3
+num_class=1
+num_tree_per_iteration=1
+label_index=0
+max_feature_idx=2
+objective=binary sigmoid:1
+feature_names=a b c
+
+Tree=0
+num_leaves=3
+num_cat=0
+split_feature=0 1
+split_gain=1 1
+threshold=0.5 1.5
+decision_type=10 0
+left_child=1 -1
+right_child=-2 -3
+leaf_value=0.1 -0.2 0.3
+shrinkage=1
+
+
+Tree=1
+num_leaves=1
+num_cat=0
+leaf_value=0.05
+shrinkage=1
+
+
+end of trees
+
+feature_importances:
+a=1
+)";
+
+static const std::string kXgboostDump = R"(booster[0]:
+0:[f0<0.5] yes=1,no=2,missing=2
+	1:leaf=0.1
+	2:[f2<3] yes=3,no=4,missing=3,gain=1.2,cover=10
+		3:leaf=-0.3
+		4:leaf=0.4
+booster[1]:
+0:leaf=0.02
+)";
+
+static double sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+TEST_CASE("LightGBM models follow its split and missing-value rules", "[tree_model]") {
+    auto model = ctrade::parse_lightgbm_model(kLightGbmModel);
+    REQUIRE(model.n_trees() == 2);
+    REQUIRE(model.n_features() == 2);
+
+    REQUIRE(model.predict(std::vector<double>{0.2, 1.0, 0.0}) == Approx(sigmoid(0.15)));
+    REQUIRE(model.predict(std::vector<double>{0.5, 1.5}) == Approx(sigmoid(0.15)));
+    REQUIRE(model.predict(std::vector<double>{0.7, 1.0}) == Approx(sigmoid(-0.15)));
+
+    // NaN is missing on the first split (default left) and zero on the second
+    REQUIRE(model.predict(std::vector<double>{kNaN, 2.0}) == Approx(sigmoid(0.35)));
+    REQUIRE(model.predict(std::vector<double>{0.2, kNaN}) == Approx(sigmoid(0.15)));
+
+    REQUIRE_THROWS(model.predict(std::vector<double>{0.2}));
+}
+
+TEST_CASE("XGBoost dumps use strict splits and missing branches", "[tree_model]") {
+    auto model = ctrade::parse_xgboost_dump(kXgboostDump, 0.5);
+    REQUIRE(model.n_trees() == 2);
+    REQUIRE(model.n_features() == 3);
+
+    REQUIRE(model.predict(std::vector<double>{0.4, 0.0, 9.0}) == Approx(0.62));
+    REQUIRE(model.predict(std::vector<double>{0.5, 0.0, 2.0}) == Approx(0.22));
+    REQUIRE(model.predict(std::vector<double>{0.9, 0.0, 3.0}) == Approx(0.92));
+    REQUIRE(model.predict(std::vector<double>{kNaN, 0.0, kNaN}) == Approx(0.22));
+
+    auto classifier = ctrade::parse_xgboost_dump(kXgboostDump, 0.0, ctrade::TreeOutput::Sigmoid);
+    REQUIRE(classifier.predict(std::vector<double>{0.4, 0.0, 9.0}) == Approx(sigmoid(0.12)));
+}
+
+TEST_CASE("XGBoost splits compare features as float32", "[tree_model]") {
+    // The dump prints float(0.1) as 0.100000001; XGBoost sends the double
+    // 0.1 right because float(0.1) < float(0.1) is false
+    auto model = ctrade::parse_xgboost_dump(
+        "booster[0]:\n0:[f0<0.100000001] yes=1,no=2,missing=1\n1:leaf=1\n2:leaf=2\n");
+    const float split = 0.1f;
+    const float below = std::nextafter(split, 0.0f);
+    const double mid = 0.5 * (static_cast<double>(below) + static_cast<double>(split));
+
+    REQUIRE(model.predict(std::vector<double>{0.1}) == 2.0);
+    REQUIRE(model.predict(std::vector<double>{static_cast<double>(below)}) == 1.0);
+    // Either side of the rounding midpoint between the two floats
+    REQUIRE(static_cast<float>(std::nextafter(mid, 0.0)) == below);
+    REQUIRE(model.predict(std::vector<double>{std::nextafter(mid, 0.0)}) == 1.0);
+    REQUIRE(model.predict(std::vector<double>{std::nextafter(mid, 1.0)}) == 2.0);
+    REQUIRE(model.predict(std::vector<double>{mid}) ==
+            (static_cast<float>(mid) < split ? 1.0 : 2.0));
+}
+
+TEST_CASE("Batched predictions match single rows bit for bit", "[tree_model][determinism]") {
+    // Random depth-4 trees over 8 features
+    ctrade::CounterRng rng(7, 0);
+    std::vector<ctrade::Tree> trees(50);
+    for (auto& tree : trees) {
+        for (int i = 0; i < 15; ++i) {
+            ctrade::TreeNode node{};
+            node.feature = static_cast<int>(rng.uniform() * 8.0);
+            node.threshold = rng.normal();
+            node.left = i < 7 ? 2 * i + 1 : ~(2 * i - 14);
+            node.right = i < 7 ? 2 * i + 2 : ~(2 * i - 13);
+            node.default_left = rng.uniform() < 0.5;
+            node.nan_missing = true;
+            tree.nodes.push_back(node);
+        }
+        for (int i = 0; i < 16; ++i) {
+            tree.leaves.push_back(0.1 * rng.normal());
+        }
+    }
+    ctrade::TreeEnsemble model(trees, 0.3);
+
+    const size_t n = 37;
+    std::vector<double> rows(n * 8);
+    for (auto& x : rows) {
+        x = rng.uniform() < 0.05 ? kNaN : rng.normal();
+    }
+    std::vector<double> out(n);
+    model.predict(rows, out);
+    for (size_t r = 0; r < n; ++r) {
+        REQUIRE(out[r] == model.predict(std::span<const double>(rows).subspan(r * 8, 8)));
+    }
+
+    REQUIRE_THROWS(model.predict(std::span<const double>(rows).first(n * 8 - 1), out));
+}
+
+TEST_CASE("Malformed models are rejected", "[tree_model]") {
+    REQUIRE_THROWS(ctrade::parse_lightgbm_model("tree\nversion=v3\n"));
+    auto categorical = kLightGbmModel;
+    categorical.replace(categorical.find("decision_type=10 0"), 18, "decision_type=11 0");
+    REQUIRE_THROWS(ctrade::parse_lightgbm_model(categorical));
+    auto multiclass = kLightGbmModel;
+    multiclass.replace(multiclass.find("num_class=1"), 11, "num_class=3");
+    REQUIRE_THROWS(ctrade::parse_lightgbm_model(multiclass));
+
+    REQUIRE_THROWS(ctrade::parse_xgboost_dump("booster[0]:\n0:[f0<1] yes=1,no=2,missing=1\n1:leaf=1\n"));
+    REQUIRE_THROWS(ctrade::parse_xgboost_dump("booster[0]:\n0:[price<1] yes=1,no=2,missing=1\n"));
+    // A node pointing back at the root throws instead of recursing forever
+    REQUIRE_THROWS(ctrade::parse_xgboost_dump("booster[0]:\n0:[f0<1] yes=0,no=1,missing=1\n1:leaf=1\n"));
+
+    ctrade::Tree bad;
+    bad.nodes.push_back({0, 0.0, 5, -2, false, true, false});
+    bad.leaves = {1.0, 2.0};
+    REQUIRE_THROWS(ctrade::TreeEnsemble({bad}));
+
+    ctrade::Tree cycle;
+    cycle.nodes.push_back({0, 0.0, 1, -1, false, true, false});
+    cycle.nodes.push_back({0, 1.0, 1, -2, false, true, false});
+    cycle.leaves = {1.0, 2.0, 3.0};
+    REQUIRE_THROWS(ctrade::TreeEnsemble({cycle}));
+}
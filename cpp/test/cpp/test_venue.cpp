@@ -0,0 +1,197 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "ctrade/asset_slice.hpp"
+#include "ctrade/venue.hpp"
+#include <vector>
+
+using Catch::Approx;
+
+// Fills every order at the close with a fixed taker fee rate
+class MockExecutionEngine : public ctrade::ExecutionEngine {
+public:
+    explicit MockExecutionEngine(double fee_rate) : fee_rate_(fee_rate) {}
+
+    std::vector<ctrade::Fill> execute(
+        const std::vector<ctrade::Order>& orders,
+        const ctrade::MarketState& market
+    ) override {
+        std::vector<ctrade::Fill> fills;
+        for (const auto& order : orders) {
+            ctrade::Fill fill{};
+            fill.order_id = order.id;
+            fill.asset_id = order.asset_id;
+            fill.price = market.close;
+            fill.size = order.size;
+            fill.fee = order.size * market.close * fee_rate_;
+            fill.timestamp = market.timestamp;
+            fills.push_back(fill);
+        }
+        return fills;
+    }
+
+private:
+    double fee_rate_;
+};
+
+static std::vector<ctrade::VenueSpec> spot_and_perp() {
+    ctrade::VenueSpec spot;
+    spot.name = "binance-spot";
+    spot.kind = ctrade::VenueKind::Spot;
+    spot.initial_balance = 1000.0;
+
+    ctrade::VenueSpec perp;
+    perp.name = "binance-usdm";
+    perp.kind = ctrade::VenueKind::UsdtPerp;
+    perp.initial_balance = 1000.0;
+    perp.leverage = 5.0;
+    perp.maintenance_margin = 0.01;
+    return {spot, perp};
+}
+
+static ctrade::Fill fill_at(int venue, int asset, double price, double size, double fee = 0.0) {
+    ctrade::Fill f{};
+    f.venue_id = venue;
+    f.asset_id = asset;
+    f.price = price;
+    f.size = size;
+    f.fee = fee;
+    return f;
+}
+
+static ctrade::MarketState bar(int venue, int asset, double close) {
+    ctrade::MarketState m{};
+    m.venue_id = venue;
+    m.asset_id = asset;
+    m.close = close;
+    return m;
+}
+
+static ctrade::Order order(int venue, int asset, ctrade::Side side, double size) {
+    ctrade::Order o{};
+    o.venue_id = venue;
+    o.asset_id = asset;
+    o.side = side;
+    o.type = ctrade::OrderType::Market;
+    o.size = size;
+    return o;
+}
+
+TEST_CASE("Spot account settles cash and inventory", "[venue]") {
+    ctrade::VenueAccounts accounts(spot_and_perp(), 2);
+
+    accounts.apply_fill(fill_at(0, 1, 100.0, 2.0, 0.2), ctrade::Side::Buy);
+    REQUIRE(accounts.balance(0) == Approx(799.8));
+    REQUIRE(accounts.position(0, 1) == Approx(2.0));
+
+    accounts.mark(bar(0, 1, 110.0));
+    REQUIRE(accounts.equity(0) == Approx(1019.8));
+    REQUIRE(accounts.free_margin(0) == Approx(799.8));
+
+    // No borrowing on spot
+    REQUIRE_FALSE(accounts.can_fill(order(0, 1, ctrade::Side::Sell, 3.0), 110.0));
+    REQUIRE_FALSE(accounts.can_fill(order(0, 0, ctrade::Side::Buy, 10.0), 100.0));
+    REQUIRE_THROWS(accounts.apply_fill(fill_at(0, 1, 110.0, 3.0), ctrade::Side::Sell));
+
+    // Other venues and assets are untouched
+    REQUIRE(accounts.position(1, 1) == 0.0);
+    REQUIRE(accounts.balance(1) == Approx(1000.0));
+}
+
+TEST_CASE("Perp account tracks entry, PnL and margin", "[venue]") {
+    ctrade::VenueAccounts accounts(spot_and_perp(), 1);
+
+    accounts.apply_fill(fill_at(1, 0, 100.0, 2.0), ctrade::Side::Buy);
+    accounts.apply_fill(fill_at(1, 0, 110.0, 2.0), ctrade::Side::Buy);
+    REQUIRE(accounts.entry_price(1, 0) == Approx(105.0));
+
+    accounts.mark(bar(1, 0, 115.0));
+    REQUIRE(accounts.equity(1) == Approx(1040.0));
+    REQUIRE(accounts.initial_margin(1) == Approx(4.0 * 115.0 / 5.0));
+    REQUIRE(accounts.maintenance_margin(1) == Approx(4.0 * 115.0 * 0.01));
+
+    // Selling through the position realizes PnL and opens a short
+    accounts.apply_fill(fill_at(1, 0, 115.0, 5.0), ctrade::Side::Sell);
+    REQUIRE(accounts.balance(1) == Approx(1040.0));
+    REQUIRE(accounts.position(1, 0) == Approx(-1.0));
+    REQUIRE(accounts.entry_price(1, 0) == Approx(115.0));
+}
+
+TEST_CASE("Perp margin limits added exposure only", "[venue]") {
+    ctrade::VenueAccounts accounts(spot_and_perp(), 1);
+    accounts.mark(bar(1, 0, 100.0));
+
+    // 1000 equity at 5x supports 50 units at 100
+    REQUIRE(accounts.can_fill(order(1, 0, ctrade::Side::Buy, 49.0), 100.0));
+    REQUIRE_FALSE(accounts.can_fill(order(1, 0, ctrade::Side::Buy, 51.0), 100.0));
+
+    accounts.apply_fill(fill_at(1, 0, 100.0, 49.0), ctrade::Side::Buy);
+    REQUIRE_FALSE(accounts.can_fill(order(1, 0, ctrade::Side::Buy, 2.0), 100.0));
+    REQUIRE(accounts.can_fill(order(1, 0, ctrade::Side::Sell, 49.0), 100.0));
+}
+
+TEST_CASE("Funding is charged on perps only", "[venue]") {
+    ctrade::VenueAccounts accounts(spot_and_perp(), 1);
+    accounts.apply_fill(fill_at(0, 0, 100.0, 2.0), ctrade::Side::Buy);
+    accounts.apply_fill(fill_at(1, 0, 100.0, 2.0), ctrade::Side::Sell);
+
+    for (int venue : {0, 1}) {
+        ctrade::FundingEvent funding{};
+        funding.venue_id = venue;
+        funding.rate = 0.001;
+        funding.mark_price = 100.0;
+        accounts.apply_funding(funding);
+    }
+
+    // Shorts receive positive funding
+    REQUIRE(accounts.balance(0) == Approx(800.0));
+    REQUIRE(accounts.balance(1) == Approx(1000.2));
+}
+
+TEST_CASE("Basis position is hedged across venues", "[venue]") {
+    ctrade::VenueAccounts accounts(spot_and_perp(), 1);
+    accounts.apply_fill(fill_at(0, 0, 100.0, 3.0), ctrade::Side::Buy);
+    accounts.apply_fill(fill_at(1, 0, 101.0, 3.0), ctrade::Side::Sell);
+
+    accounts.mark(bar(0, 0, 100.0));
+    accounts.mark(bar(1, 0, 101.0));
+    const double before = accounts.total_equity();
+
+    accounts.mark(bar(0, 0, 120.0));
+    accounts.mark(bar(1, 0, 121.0));
+    REQUIRE(accounts.total_equity() == Approx(before));
+}
+
+TEST_CASE("Multi-venue engine routes orders by venue", "[venue]") {
+    MockExecutionEngine spot(0.001);
+    MockExecutionEngine perp(0.0005);
+    ctrade::MultiVenueExecutionEngine engine({&spot, &perp});
+
+    std::vector<ctrade::Order> orders{
+        order(0, 0, ctrade::Side::Buy, 1.0),
+        order(1, 0, ctrade::Side::Sell, 1.0),
+        order(1, 1, ctrade::Side::Sell, 1.0),
+    };
+    orders[1].id = 1;
+
+    auto fills = engine.execute(orders, bar(1, 0, 100.0));
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].order_id == 1);
+    REQUIRE(fills[0].venue_id == 1);
+    REQUIRE(fills[0].fee == Approx(0.05));
+
+    REQUIRE_THROWS(engine.execute(orders, bar(2, 0, 100.0)));
+}
+
+TEST_CASE("Slices lay out venues as blocks of assets", "[venue]") {
+    ctrade::AssetSliceBuffer buffer(2, 2);
+    buffer.begin(60);
+    buffer.set(bar(0, 1, 100.0));
+    buffer.set(bar(1, 1, 100.5));
+
+    auto slice = buffer.view();
+    REQUIRE(slice.size() == 4);
+    REQUIRE(slice.close[1] == Approx(100.0));
+    REQUIRE(slice.close[3] == Approx(100.5));
+
+    REQUIRE_THROWS(buffer.set(bar(2, 0, 1.0)));
+}
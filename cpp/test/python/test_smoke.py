@@ -10,6 +10,7 @@ def test_import_ctrade():
         assert hasattr(ctrade, "Strategy")
         assert hasattr(ctrade, "BacktestConfig")
         assert hasattr(ctrade, "MarketState")
+        assert hasattr(ctrade, "AssetSlice")
         assert hasattr(ctrade, "ExecutionContext")
         assert hasattr(ctrade, "backtest")
     except ImportError: